@@ -0,0 +1,125 @@
+// batch_convert.cpp: throughput of batched vs per-value conversion to run-time selected posit formats
+//
+// Copyright (C) 2017 Stillwater Supercomputing, Inc.
+//
+// This file is part of the universal numbers project, which is released under an MIT Open Source license.
+
+#include <cstdint>
+#include <chrono>
+#include <iostream>
+#include <iomanip>
+#include <random>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include <posit>
+
+#include "../utilities/es_select.hpp"
+#include "../utilities/nbits_select.hpp"
+#include "../utilities/nested_apply_visitor.hpp"
+#include "../utilities/dispatch_table.hpp"
+#include "../utilities/batch_convert.hpp"
+
+// One dispatch per value. Through nested_apply_visitor this is the way posit_dispatcher selected its format;
+// the nested visitor instantiates every (nbits, es) pair, the invalid ones encode nothing and are never selected.
+struct single_value_encoder
+{
+    template <std::size_t Nbits, std::size_t ES>
+    void operator()() const
+    {
+        encode<Nbits, ES>(std::integral_constant<bool, (ES + 2 <= Nbits)>());
+    }
+
+    template <std::size_t Nbits, std::size_t ES>
+    void encode(std::true_type) const
+    {
+        sw::unum::posit<Nbits, ES> p(value_);
+        *out_ = p.get().to_ullong();
+    }
+
+    template <std::size_t Nbits, std::size_t ES>
+    void encode(std::false_type) const {}
+
+    double value_;
+    std::uint64_t* out_;
+};
+
+template <typename Function>
+double elements_per_second(Function f, std::size_t n)
+{
+    auto start = std::chrono::steady_clock::now();
+    f();
+    auto stop = std::chrono::steady_clock::now();
+    return double(n) / std::chrono::duration<double>(stop - start).count();
+}
+
+// Usage: bench_batch_convert [nrOfElements]
+int main(int argc, char** argv)
+try {
+    using namespace std;
+
+    size_t n = 1 << 16;
+    if (argc > 1)
+        n = size_t(stoull(argv[1]));
+
+    mt19937_64 eng(0x5eed);
+    lognormal_distribution<double> magnitude(0.0, 4.0);
+    vector<double> input(n);
+    for (auto& x : input)
+        x = (eng() & 1 ? -1.0 : 1.0) * magnitude(eng);
+    vector<uint64_t> packed(n), visited(n), single(n);
+
+    // speedup of the batch over the per-value visitor, the path of posit_dispatcher
+    cout << "Conversion of " << n << " doubles\n";
+    cout << setw(12) << "format" << setw(20) << "batch [elem/s]" << setw(20) << "visitor [elem/s]" << setw(20) << "table [elem/s]" << setw(10) << "speedup" << '\n';
+    int errors = 0;
+    for (size_t nbits = dispatch_min_nbits; nbits <= dispatch_max_nbits; ++nbits) {
+        for (size_t es = 0; es <= dispatch_max_es; ++es) {
+            if (!valid_posit_configuration(nbits, es))
+                continue;
+            nbits_variant nbitsv = nbits_select(nbits);
+            es_variant esv = es_select(es);
+
+            double batch = elements_per_second([&]() {
+                convert_to_posit(input.data(), n, packed.data(), nbitsv, esv);
+            }, n);
+
+            double per_value_visitor = elements_per_second([&]() {
+                for (size_t i = 0; i < n; ++i)
+                    nested_apply_visitor(single_value_encoder{ input[i], &visited[i] }, nbitsv, esv);
+            }, n);
+
+            double per_value_table = elements_per_second([&]() {
+                for (size_t i = 0; i < n; ++i)
+                    table_dispatch(single_value_encoder{ input[i], &single[i] }, nbitsv, esv);
+            }, n);
+
+            // the packed buffer is dense in posit_storage_bytes(nbits), compare element by element
+            const unsigned char* bytes = reinterpret_cast<const unsigned char*>(packed.data());
+            for (size_t i = 0; i < n; ++i) {
+                uint64_t bits = 0;
+                for (size_t b = posit_storage_bytes(nbits); b-- > 0; )
+                    bits = (bits << 8) | bytes[i * posit_storage_bytes(nbits) + b];
+                if (bits != single[i] || bits != visited[i]) {
+                    ++errors;
+                    break;
+                }
+            }
+
+            cout << setw(12) << ("posit<" + to_string(nbits) + "," + to_string(es) + ">")
+                 << scientific << setprecision(3) << setw(20) << batch << setw(20) << per_value_visitor << setw(20) << per_value_table
+                 << fixed << setprecision(2) << setw(10) << batch / per_value_visitor << '\n';
+        }
+    }
+
+    if (errors > 0) {
+        cerr << errors << " configurations where batch and per-value conversion disagree\n";
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
+catch (std::exception& err) {
+    std::cerr << err.what() << std::endl;
+    return EXIT_FAILURE;
+}
@@ -0,0 +1,143 @@
+// batch_ops.cpp: per-call execute vs structure-of-arrays batches for the binary posit operations
+//
+// Copyright (C) 2017 Stillwater Supercomputing, Inc.
+//
+// This file is part of the universal numbers project, which is released under an MIT Open Source license.
+
+#include <cstdint>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <posit>
+
+#include "../utilities/batch_ops.hpp"
+#include "../tools/qa/qa_helpers.hpp"
+#include "bench_harness.hpp"
+
+struct batch_ops_benchmark
+{
+    template <std::size_t Nbits, std::size_t ES>
+    void run()
+    {
+        using namespace std;
+        using posit_type = sw::unum::posit<Nbits, ES>;
+        using raw_type = posit_storage_t<Nbits>;
+
+        // the operands of a SmokeTestRandoms sweep, as posit objects and as arrays of encodings and values
+        const sw::qa::counter_rng rng(0x5eed);
+        vector<posit_type> pa(n), pb(n);
+        vector<raw_type> ra(n), rb(n), result(n), pref(n);
+        vector<double> da(n), db(n), reference(n);
+        for (size_t i = 0; i < n; ++i) {
+            sw::qa::RandomOperands(rng, i, pa[i], pb[i]);
+            ra[i] = raw_type(pa[i].get().to_ullong());
+            rb[i] = raw_type(pb[i].get().to_ullong());
+            da[i] = double(pa[i]);
+            db[i] = double(pb[i]);
+        }
+
+        const int opcodes[] = { sw::qa::OPCODE_ADD, sw::qa::OPCODE_SUB, sw::qa::OPCODE_MUL, sw::qa::OPCODE_DIV };
+        const binary_op ops[] = { binary_op::add, binary_op::sub, binary_op::mul, binary_op::div };
+        const char* names[] = { "add", "sub", "mul", "div" };
+        posit_engine<Nbits, ES> engine;
+        for (int i = 0; i < 4; ++i) {
+            const int opcode = opcodes[i];
+            const binary_op op = ops[i];
+            size_t mismatches = 0;
+
+            // QA: the library op and the rounded reference, one call and one opcode switch per case
+            posit_type presult, preference;
+            const timing_summary execute = measure([&]() {
+                for (size_t k = 0; k < n; ++k) {
+                    sw::qa::execute<Nbits, ES, double>(opcode, da[k], db[k], preference, pa[k], pb[k], presult);
+                    result[k] = raw_type(presult.get().to_ullong());
+                }
+            }, warmup, repetitions);
+            const vector<raw_type> expected = result;
+            const timing_summary batch = measure([&]() {
+                sw::qa::ExecuteBatch<Nbits, ES, double>(opcode, n, ra.data(), rb.data(), da.data(), db.data(), result.data(), reference.data(), pref.data());
+            }, warmup, repetitions);
+            mismatches += result != expected;
+
+            // kernels: the fastest engine, with the operation switched per element and resolved per batch
+            const timing_summary per_element = measure([&]() {
+                for (size_t k = 0; k < n; ++k) {
+                    switch (op) {
+                        case binary_op::add: result[k] = engine.add(ra[k], rb[k]); break;
+                        case binary_op::sub: result[k] = engine.sub(ra[k], rb[k]); break;
+                        case binary_op::mul: result[k] = engine.mul(ra[k], rb[k]); break;
+                        case binary_op::div: result[k] = engine.div(ra[k], rb[k]); break;
+                    }
+                }
+            }, warmup, repetitions);
+            const timing_summary engine_batch = measure([&]() { batch_apply(engine, op, ra.data(), rb.data(), result.data(), n); }, warmup, repetitions);
+
+            results.push_back(benchmark_result{ names[i], "execute", Nbits, ES, n, execute });
+            results.push_back(benchmark_result{ names[i], "qa batch", Nbits, ES, n, batch });
+            results.push_back(benchmark_result{ names[i], "per element", Nbits, ES, n, per_element });
+            results.push_back(benchmark_result{ names[i], "batch", Nbits, ES, n, engine_batch });
+            if (mismatches) {
+                cerr << "posit<" << Nbits << "," << ES << "> " << names[i] << ": execute and ExecuteBatch disagree\n";
+                ++errors;
+            }
+        }
+    }
+
+    std::size_t n, warmup, repetitions;
+    std::vector<benchmark_result> results;
+    int errors = 0;
+};
+
+// Usage: bench_batch_ops [--n N] [--warmup W] [--reps R] [--json file]
+int main(int argc, char** argv)
+try {
+    using namespace std;
+
+    batch_ops_benchmark bench{ 1 << 16, 1, 5, {} };
+    string json;
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        if (arg == "--n" && i + 1 < argc) bench.n = size_t(stoull(argv[++i]));
+        else if (arg == "--warmup" && i + 1 < argc) bench.warmup = size_t(stoull(argv[++i]));
+        else if (arg == "--reps" && i + 1 < argc) bench.repetitions = size_t(stoull(argv[++i]));
+        else if (arg == "--json" && i + 1 < argc) json = argv[++i];
+        else {
+            cerr << "Usage: bench_batch_ops [--n N] [--warmup W] [--reps R] [--json file]\n";
+            return EXIT_FAILURE;
+        }
+    }
+    if (bench.n == 0 || bench.repetitions == 0) {
+        cerr << "--n and --reps must be positive\n";
+        return EXIT_FAILURE;
+    }
+
+    // a table, a generic, and two native engines
+    bench.run<8, 0>();
+    bench.run<12, 1>();
+    bench.run<16, 1>();
+    bench.run<32, 2>();
+
+    print_results(cout, bench.results);
+    cout << '\n' << setw(12) << "format" << setw(13) << "op" << setw(16) << "qa batch x" << setw(16) << "engine batch x" << '\n';
+    for (size_t i = 0; i + 3 < bench.results.size(); i += 4) {
+        const benchmark_result* r = &bench.results[i];
+        cout << setw(12) << ("posit<" + to_string(r->nbits) + "," + to_string(r->es) + ">") << setw(13) << r->name << fixed << setprecision(2)
+             << setw(16) << r[0].ns_per_op() / r[1].ns_per_op() << setw(16) << r[2].ns_per_op() / r[3].ns_per_op() << '\n';
+    }
+    if (!json.empty()) {
+        ofstream ostr(json);
+        write_json(ostr, "batch_ops", bench.results);
+        if (!ostr) {
+            cerr << "unable to write " << json << '\n';
+            return EXIT_FAILURE;
+        }
+    }
+    return bench.errors > 0 ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+catch (std::exception& err) {
+    std::cerr << err.what() << std::endl;
+    return EXIT_FAILURE;
+}
@@ -0,0 +1,126 @@
+// bench_harness.hpp: warmup, repetition, statistics, and JSON reporting for benchmarks
+//
+// Copyright (C) 2017 Stillwater Supercomputing, Inc.
+//
+// This file is part of the universal numbers project, which is released under an MIT Open Source license.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <ctime>
+#include <iomanip>
+#include <iostream>
+#include <numeric>
+#include <sstream>
+#include <string>
+#include <vector>
+
+/// Statistics over the wall times of the repetitions of one measurement.
+struct timing_summary
+{
+    std::size_t repetitions = 0;
+    double min = 0, max = 0, mean = 0, median = 0, stddev = 0;  // seconds
+
+    explicit timing_summary(std::vector<double> samples = {})
+    {
+        repetitions = samples.size();
+        if (samples.empty())
+            return;
+        std::sort(samples.begin(), samples.end());
+        min = samples.front();
+        max = samples.back();
+        median = samples.size() % 2 ? samples[samples.size() / 2]
+                                    : 0.5 * (samples[samples.size() / 2 - 1] + samples[samples.size() / 2]);
+        mean = std::accumulate(samples.begin(), samples.end(), 0.0) / samples.size();
+        double sq = 0.0;
+        for (double s : samples)
+            sq += (s - mean) * (s - mean);
+        stddev = samples.size() > 1 ? std::sqrt(sq / (samples.size() - 1)) : 0.0;
+    }
+};
+
+/// Run f warmup times untimed, then repetitions times timed.
+template <typename Function>
+timing_summary measure(Function f, std::size_t warmup, std::size_t repetitions)
+{
+    for (std::size_t i = 0; i < warmup; ++i)
+        f();
+    std::vector<double> samples;
+    samples.reserve(repetitions);
+    for (std::size_t i = 0; i < repetitions; ++i) {
+        auto start = std::chrono::steady_clock::now();
+        f();
+        samples.push_back(std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+    }
+    return timing_summary(samples);
+}
+
+/// One measured quantity: ops operations per repetition of a kernel.
+struct benchmark_result
+{
+    std::string name;           // e.g. "add"
+    std::string kind;           // "throughput" or "latency"
+    std::size_t nbits, es;
+    std::size_t ops;
+    timing_summary timing;
+
+    double ops_per_second() const { return timing.median > 0 ? ops / timing.median : 0.0; }
+    double ns_per_op() const { return ops > 0 ? 1.0e9 * timing.median / ops : 0.0; }
+};
+
+inline std::string json_escape(const std::string& s)
+{
+    std::string out;
+    for (char c : s) {
+        if (c == '"' || c == '\\')
+            out += '\\';
+        out += c;
+    }
+    return out;
+}
+
+/// Write results with the metadata needed to compare runs across releases.
+inline void write_json(std::ostream& ostr, const std::string& suite, const std::vector<benchmark_result>& results)
+{
+    std::time_t now = std::time(nullptr);
+    char stamp[32];
+    std::strftime(stamp, sizeof(stamp), "%Y-%m-%dT%H:%M:%SZ", std::gmtime(&now));
+
+    ostr << std::setprecision(9);
+    ostr << "{\n";
+    ostr << "  \"suite\": \"" << json_escape(suite) << "\",\n";
+    ostr << "  \"timestamp\": \"" << stamp << "\",\n";
+#ifdef __VERSION__
+    ostr << "  \"compiler\": \"" << json_escape(__VERSION__) << "\",\n";
+#endif
+    ostr << "  \"results\": [\n";
+    for (std::size_t i = 0; i < results.size(); ++i) {
+        const benchmark_result& r = results[i];
+        ostr << "    { \"name\": \"" << json_escape(r.name) << "\", \"kind\": \"" << json_escape(r.kind) << "\""
+             << ", \"nbits\": " << r.nbits << ", \"es\": " << r.es << ", \"ops\": " << r.ops
+             << ", \"repetitions\": " << r.timing.repetitions
+             << ", \"median_s\": " << r.timing.median << ", \"mean_s\": " << r.timing.mean
+             << ", \"min_s\": " << r.timing.min << ", \"max_s\": " << r.timing.max << ", \"stddev_s\": " << r.timing.stddev
+             << ", \"ops_per_second\": " << r.ops_per_second() << ", \"ns_per_op\": " << r.ns_per_op() << " }"
+             << (i + 1 < results.size() ? "," : "") << '\n';
+    }
+    ostr << "  ]\n}\n";
+}
+
+/// Human-readable table, one line per result.
+inline void print_results(std::ostream& ostr, const std::vector<benchmark_result>& results)
+{
+    ostr << std::setw(12) << "format" << std::setw(13) << "op" << std::setw(12) << "kind"
+         << std::setw(14) << "ops/sec" << std::setw(12) << "ns/op" << std::setw(10) << "rsd %" << '\n';
+    for (const benchmark_result& r : results) {
+        ostr << std::setw(12) << ("posit<" + std::to_string(r.nbits) + "," + std::to_string(r.es) + ">")
+             << std::setw(13) << r.name << std::setw(12) << r.kind
+             << std::scientific << std::setprecision(3) << std::setw(14) << r.ops_per_second()
+             << std::fixed << std::setprecision(2) << std::setw(12) << r.ns_per_op()
+             << std::setw(10) << (r.timing.mean > 0 ? 100.0 * r.timing.stddev / r.timing.mean : 0.0) << '\n';
+    }
+}
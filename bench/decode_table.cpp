@@ -0,0 +1,132 @@
+// decode_table.cpp: posit-to-double conversion and comparison through the shared decode tables vs the library
+//
+// Copyright (C) 2017 Stillwater Supercomputing, Inc.
+//
+// This file is part of the universal numbers project, which is released under an MIT Open Source license.
+
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+
+#include <posit>
+
+#include "../utilities/decode_table.hpp"
+#include "../tools/qa/qa_helpers.hpp"
+#include "bench_harness.hpp"
+
+struct decode_table_benchmark
+{
+    template <std::size_t Nbits, std::size_t ES>
+    void run()
+    {
+        using namespace std;
+        using posit_type = sw::unum::posit<Nbits, ES>;
+
+        // the operands of a SmokeTestRandoms sweep
+        const sw::qa::counter_rng rng(0x5eed);
+        vector<posit_type> a(n), b(n);
+        vector<uint64_t> ra(n), rb(n);
+        for (size_t i = 0; i < n; ++i) {
+            sw::qa::RandomOperands(rng, i, a[i], b[i]);
+            ra[i] = a[i].get().to_ullong();
+            rb[i] = b[i].get().to_ullong();
+        }
+        vector<double> da(n), db(n);
+        const decode_table& table = decode_table_for<Nbits, ES>();
+
+        // the operand fill of SmokeTestRandoms before and after the decode tables
+        const timing_summary library_fill = measure([&]() {
+            for (size_t k = 0; k < n; ++k) {
+                da[k] = double(a[k]);
+                db[k] = double(b[k]);
+            }
+        }, 1, repetitions);
+        const timing_summary table_fill = measure([&]() {
+            for (size_t k = 0; k < n; ++k) {
+                da[k] = sw::qa::OperandValue<Nbits, ES, double>(a[k]);
+                db[k] = sw::qa::OperandValue<Nbits, ES, double>(b[k]);
+            }
+        }, 1, repetitions);
+
+        // raw encodings straight through the table
+        const timing_summary table_decode = measure([&]() {
+            const double* values = table.data();
+            for (size_t k = 0; k < n; ++k) {
+                da[k] = values[ra[k]];
+                db[k] = values[rb[k]];
+            }
+        }, 1, repetitions);
+
+        size_t less = 0;
+        const timing_summary library_compare = measure([&]() {
+            less = 0;
+            for (size_t k = 0; k < n; ++k)
+                less += a[k] < b[k];
+        }, 1, repetitions);
+        size_t table_less = 0;
+        const timing_summary table_compare = measure([&]() {
+            table_less = 0;
+            for (size_t k = 0; k < n; ++k)
+                table_less += table.less(ra[k], rb[k]);
+        }, 1, repetitions);
+        if (less != table_less)
+            cerr << "posit<" << Nbits << "," << ES << ">: comparisons disagree, " << less << " vs " << table_less << '\n';
+
+        const string format = "posit<" + to_string(Nbits) + "," + to_string(ES) + ">";
+        auto report = [&](const string& name, const timing_summary& timing, const timing_summary& baseline) {
+            results.push_back(benchmark_result{ name, "throughput", Nbits, ES, 2 * n, timing });
+            cout << setw(12) << format << setw(18) << name << fixed << setprecision(2)
+                 << setw(12) << 1.0e9 * timing.median / (2 * n) << setw(10) << baseline.median / timing.median << '\n';
+        };
+        report("library_fill", library_fill, library_fill);
+        report("table_fill", table_fill, library_fill);
+        report("table_decode", table_decode, library_fill);
+        results.push_back(benchmark_result{ "library_compare", "throughput", Nbits, ES, n, library_compare });
+        results.push_back(benchmark_result{ "table_compare", "throughput", Nbits, ES, n, table_compare });
+        cout << setw(12) << format << setw(18) << "library_compare" << setw(12) << 1.0e9 * library_compare.median / n << setw(10) << 1.0 << '\n';
+        cout << setw(12) << format << setw(18) << "table_compare" << setw(12) << 1.0e9 * table_compare.median / n
+             << setw(10) << library_compare.median / table_compare.median << '\n';
+    }
+
+    std::size_t n, repetitions;
+    std::vector<benchmark_result> results;
+};
+
+// Usage: bench_decode_table [--n N] [--reps R] [--json file]
+int main(int argc, char** argv)
+try {
+    using namespace std;
+
+    decode_table_benchmark bench{ 1 << 20, 5, {} };
+    string json;
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        if (arg == "--n" && i + 1 < argc) bench.n = size_t(stoull(argv[++i]));
+        else if (arg == "--reps" && i + 1 < argc) bench.repetitions = size_t(stoull(argv[++i]));
+        else if (arg == "--json" && i + 1 < argc) json = argv[++i];
+        else {
+            cerr << "Usage: bench_decode_table [--n N] [--reps R] [--json file]\n";
+            return EXIT_FAILURE;
+        }
+    }
+
+    cout << setw(12) << "format" << setw(18) << "method" << setw(12) << "ns/value" << setw(10) << "speedup" << '\n';
+    bench.run<8, 0>();
+    bench.run<8, 1>();
+    bench.run<12, 1>();
+    bench.run<16, 1>();
+    bench.run<16, 2>();
+
+    if (!json.empty()) {
+        ofstream ostr(json);
+        write_json(ostr, "decode_table", bench.results);
+    }
+    return EXIT_SUCCESS;
+}
+catch (std::exception& err) {
+    std::cerr << err.what() << std::endl;
+    return EXIT_FAILURE;
+}
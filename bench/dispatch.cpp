@@ -0,0 +1,118 @@
+// dispatch.cpp: compare nested variant visitation with the flat dispatch table
+//
+// Copyright (C) 2017 Stillwater Supercomputing, Inc.
+//
+// This file is part of the universal numbers project, which is released under an MIT Open Source license.
+
+#include <cstdint>
+#include <chrono>
+#include <iostream>
+#include <iomanip>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <boost/variant.hpp>
+
+#include "../utilities/es_select.hpp"
+#include "../utilities/nbits_select.hpp"
+#include "../utilities/nested_apply_visitor.hpp"
+#include "../utilities/dispatch_table.hpp"
+#include "dispatch_kernel.hpp"
+
+template <typename Function>
+double nanoseconds_per_call(Function f, std::size_t nrOfCalls)
+{
+    auto start = std::chrono::steady_clock::now();
+    f();
+    auto stop = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(stop - start).count() / double(nrOfCalls);
+}
+
+// Usage: bench_dispatch [nrOfDispatches]
+int main(int argc, char** argv)
+try {
+    using namespace std;
+
+    size_t nrOfDispatches = 10000000;
+    if (argc > 1)
+        nrOfDispatches = size_t(stoull(argv[1]));
+
+    // random sequence of valid configurations, so the branch predictor cannot learn a single target
+    vector<pair<size_t, size_t>> configurations;
+    for (size_t nbits = dispatch_min_nbits; nbits <= dispatch_max_nbits; ++nbits)
+        for (size_t es = 0; es <= dispatch_max_es; ++es)
+            if (valid_posit_configuration(nbits, es))
+                configurations.emplace_back(nbits, es);
+    const size_t SEQUENCE = 4096;
+    mt19937_64 eng(0x5eed);
+    uniform_int_distribution<size_t> pick(0, configurations.size() - 1);
+    vector<pair<size_t, size_t>> sequence(SEQUENCE);
+    vector<pair<nbits_variant, es_variant>> variants;
+    for (auto& c : sequence) {
+        c = configurations[pick(eng)];
+        variants.emplace_back(nbits_select(c.first), es_select(c.second));
+    }
+
+    uint64_t nested_sum = 0, selected_sum = 0, table_sum = 0, table_variant_sum = 0;
+    checksum_kernel nested_kernel{ &nested_sum }, selected_kernel{ &selected_sum }, table_kernel{ &table_sum }, table_variant_kernel{ &table_variant_sum };
+
+    double selected = nanoseconds_per_call([&]() {
+        for (size_t i = 0; i < nrOfDispatches; ++i) {
+            const auto& c = sequence[i % SEQUENCE];
+            nested_apply_visitor(selected_kernel, nbits_select(c.first), es_select(c.second));
+        }
+    }, nrOfDispatches);
+
+    double nested = nanoseconds_per_call([&]() {
+        for (size_t i = 0; i < nrOfDispatches; ++i) {
+            const auto& v = variants[i % SEQUENCE];
+            nested_apply_visitor(nested_kernel, v.first, v.second);
+        }
+    }, nrOfDispatches);
+
+    size_t failures = 0;
+    double table = nanoseconds_per_call([&]() {
+        for (size_t i = 0; i < nrOfDispatches; ++i) {
+            const auto& c = sequence[i % SEQUENCE];
+            failures += table_dispatch(table_kernel, c.first, c.second) != dispatch_status::ok;
+        }
+    }, nrOfDispatches);
+
+    double table_variant = nanoseconds_per_call([&]() {
+        for (size_t i = 0; i < nrOfDispatches; ++i) {
+            const auto& v = variants[i % SEQUENCE];
+            failures += table_dispatch(table_variant_kernel, v.first, v.second) != dispatch_status::ok;
+        }
+    }, nrOfDispatches);
+
+    if (failures > 0 || nested_sum != selected_sum || nested_sum != table_sum || nested_sum != table_variant_sum) {
+        cerr << "Dispatch paths disagree\n";
+        return EXIT_FAILURE;
+    }
+
+    const size_t all_combinations = dispatch_nbits_count * dispatch_es_count;
+    const size_t instantiated = dispatch_table<checksum_kernel>::size();
+
+    cout << "Dispatch latency over " << nrOfDispatches << " randomized (nbits, es) selections\n";
+    cout << fixed << setprecision(2);
+    cout << setw(48) << left << "nbits_select + es_select + nested_apply_visitor" << right << setw(10) << selected << " ns/dispatch\n";
+    cout << setw(48) << left << "nested_apply_visitor on preselected variants" << right << setw(10) << nested << " ns/dispatch\n";
+    cout << setw(48) << left << "table_dispatch(nbits, es)" << right << setw(10) << table << " ns/dispatch\n";
+    cout << setw(48) << left << "table_dispatch(nbits_variant, es_variant)" << right << setw(10) << table_variant << " ns/dispatch\n";
+    cout << '\n';
+    // These count what each path instantiates; the text and data size of the two paths, each built alone
+    // for checksum_kernel, is printed by the bench_dispatch_size target.
+    cout << "Kernel instantiations and table footprint\n";
+    cout << setw(48) << left << "nested_apply_visitor kernel instantiations" << right << setw(10) << all_combinations << '\n';
+    cout << setw(48) << left << "table_dispatch kernel instantiations" << right << setw(10) << instantiated << '\n';
+    cout << setw(48) << left << "table_dispatch table footprint" << right << setw(10) << all_combinations * sizeof(dispatch_table<checksum_kernel>::entry) << " bytes\n";
+    cout << "checksum " << table_sum << '\n';
+
+    return EXIT_SUCCESS;
+}
+catch (std::exception& err) {
+    std::cerr << err.what() << std::endl;
+    return EXIT_FAILURE;
+}
@@ -0,0 +1,22 @@
+// dispatch_kernel.hpp: the kernel that the dispatch benchmark and the single-path dispatch objects select
+//
+// Copyright (C) 2017 Stillwater Supercomputing, Inc.
+//
+// This file is part of the universal numbers project, which is released under an MIT Open Source license.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Kernel that is as cheap as possible, so the measurement is dominated by dispatch.
+struct checksum_kernel
+{
+    template <std::size_t Nbits, std::size_t ES>
+    void operator()() const
+    {
+        *checksum += Nbits * 16 + ES;
+    }
+
+    std::uint64_t* checksum;
+};
@@ -0,0 +1,38 @@
+// dispatch_path.cpp: one dispatch path for checksum_kernel alone, so its text and data size can be measured
+//
+// Copyright (C) 2017 Stillwater Supercomputing, Inc.
+//
+// This file is part of the universal numbers project, which is released under an MIT Open Source license.
+
+#include <cstddef>
+#include <cstdint>
+
+#include "../dispatch_kernel.hpp"
+
+#if defined(DISPATCH_PATH_NESTED)
+
+#include <boost/variant.hpp>
+
+#include "../../utilities/es_select.hpp"
+#include "../../utilities/nbits_select.hpp"
+#include "../../utilities/nested_apply_visitor.hpp"
+
+void dispatch_path(std::uint64_t* checksum, std::size_t nbits, std::size_t es)
+{
+    checksum_kernel kernel{ checksum };
+    nested_apply_visitor(kernel, nbits_select(nbits), es_select(es));
+}
+
+#elif defined(DISPATCH_PATH_TABLE)
+
+#include "../../utilities/dispatch_table.hpp"
+
+void dispatch_path(std::uint64_t* checksum, std::size_t nbits, std::size_t es)
+{
+    checksum_kernel kernel{ checksum };
+    table_dispatch(kernel, nbits, es);
+}
+
+#else
+#error "define DISPATCH_PATH_NESTED or DISPATCH_PATH_TABLE"
+#endif
@@ -0,0 +1,124 @@
+// fused_dot.cpp: quire-accumulated dot product vs naive posit accumulation and double
+//
+// Copyright (C) 2017 Stillwater Supercomputing, Inc.
+//
+// This file is part of the universal numbers project, which is released under an MIT Open Source license.
+
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <iomanip>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <boost/numeric/mtl/mtl.hpp>
+#include <posit>
+
+#include "../kernels/fused_dot.hpp"
+#include "bench_harness.hpp"
+
+struct dot_benchmark
+{
+    template <std::size_t Nbits, std::size_t ES>
+    void run(std::size_t n)
+    {
+        using namespace std;
+        using posit_type = sw::unum::posit<Nbits, ES>;
+
+        // ill-conditioned data: products of mixed sign over several binades
+        mt19937_64 eng(n);
+        uniform_real_distribution<double> magnitude(-8.0, 8.0);
+        mtl::dense_vector<posit_type> x(n), y(n);
+        vector<double> dx(n), dy(n);
+        for (size_t i = 0; i < n; ++i) {
+            x[i] = (eng() & 1 ? -1.0 : 1.0) * exp2(magnitude(eng));
+            y[i] = exp2(magnitude(eng));
+            dx[i] = double(x[i]);
+            dy[i] = double(y[i]);
+        }
+
+        // reference: compensated long double sum of the products of the posit values
+        long double sum = 0, c = 0;
+        for (size_t i = 0; i < n; ++i) {
+            long double p = (long double)dx[i] * dy[i], t = sum + p;
+            c += fabsl(sum) >= fabsl(p) ? (sum - t) + p : (p - t) + sum;
+            sum = t;
+        }
+        const long double reference = sum + c;
+        auto relative_error = [reference](long double v) {
+            return reference == 0 ? fabsl(v) : fabsl((v - reference) / reference);
+        };
+
+        const size_t reps = n >= 10000000 ? 1 : repetitions;
+        posit_type fused, naive;
+        double dbl = 0.0;
+        timing_summary fused_time = measure([&]() { fused = fused_dot(x, y); }, warmup, reps);
+        timing_summary naive_time = measure([&]() {
+            naive = 0;
+            for (size_t i = 0; i < n; ++i)
+                naive += x[i] * y[i];
+        }, warmup, reps);
+        timing_summary double_time = measure([&]() {
+            dbl = 0.0;
+            for (size_t i = 0; i < n; ++i)
+                dbl += dx[i] * dy[i];
+        }, warmup, reps);
+
+        results.push_back(benchmark_result{ "dot_fused", "throughput", Nbits, ES, n, fused_time });
+        results.push_back(benchmark_result{ "dot_naive", "throughput", Nbits, ES, n, naive_time });
+        results.push_back(benchmark_result{ "dot_double", "throughput", Nbits, ES, n, double_time });
+
+        cout << setw(12) << ("posit<" + to_string(Nbits) + "," + to_string(ES) + ">") << setw(11) << n
+             << fixed << setprecision(2)
+             << setw(12) << 1.0e9 * fused_time.median / n
+             << setw(12) << 1.0e9 * naive_time.median / n
+             << setw(12) << 1.0e9 * double_time.median / n
+             << scientific << setprecision(2)
+             << setw(12) << double(relative_error((long double)fused))
+             << setw(12) << double(relative_error((long double)naive))
+             << setw(12) << double(relative_error(dbl)) << '\n';
+    }
+
+    std::size_t warmup, repetitions;
+    std::vector<benchmark_result> results;
+};
+
+// Usage: bench_fused_dot [--max-exp E] [--reps R] [--json file]     vectors of 10^3 .. 10^E elements
+int main(int argc, char** argv)
+try {
+    using namespace std;
+
+    size_t maxExp = 7;           // 10^8 takes minutes per format with the generic posit arithmetic
+    dot_benchmark bench{ 1, 3, {} };
+    string json;
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        if (arg == "--max-exp" && i + 1 < argc) maxExp = size_t(stoull(argv[++i]));
+        else if (arg == "--reps" && i + 1 < argc) bench.repetitions = size_t(stoull(argv[++i]));
+        else if (arg == "--json" && i + 1 < argc) json = argv[++i];
+        else {
+            cerr << "Usage: bench_fused_dot [--max-exp E] [--reps R] [--json file]\n";
+            return EXIT_FAILURE;
+        }
+    }
+
+    cout << "ns per element and relative error against an exact reference\n";
+    cout << setw(12) << "format" << setw(11) << "n" << setw(12) << "fused" << setw(12) << "naive" << setw(12) << "double"
+         << setw(12) << "err fused" << setw(12) << "err naive" << setw(12) << "err double" << '\n';
+    for (size_t e = 3, n = 1000; e <= maxExp; ++e, n *= 10) {
+        bench.run<8, 0>(n);
+        bench.run<16, 1>(n);
+        bench.run<32, 2>(n);
+    }
+
+    if (!json.empty()) {
+        ofstream ostr(json);
+        write_json(ostr, "fused_dot", bench.results);
+    }
+    return EXIT_SUCCESS;
+}
+catch (std::exception& err) {
+    std::cerr << err.what() << std::endl;
+    return EXIT_FAILURE;
+}
@@ -0,0 +1,129 @@
+// fused_gemm.cpp: GFLOP-equivalent rates of the blocked quire GEMM against an unblocked triple loop
+//
+// Copyright (C) 2017 Stillwater Supercomputing, Inc.
+//
+// This file is part of the universal numbers project, which is released under an MIT Open Source license.
+
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <iomanip>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <boost/numeric/mtl/mtl.hpp>
+#include <posit>
+
+#include "../kernels/fused_gemm.hpp"
+#include "bench_harness.hpp"
+
+// Reference: one quire per output element, i-j-k order straight from the MTL matrices.
+template <std::size_t Nbits, std::size_t ES>
+void triple_loop_gemm(const mtl::dense2D<sw::unum::posit<Nbits, ES> >& A, const mtl::dense2D<sw::unum::posit<Nbits, ES> >& B,
+                      mtl::dense2D<sw::unum::posit<Nbits, ES> >& C)
+{
+    sw::unum::quire<Nbits, ES, kernel_quire_capacity> q;
+    for (std::size_t i = 0; i < num_rows(A); ++i) {
+        for (std::size_t j = 0; j < num_cols(B); ++j) {
+            q.clear();
+            bool nar = false;
+            for (std::size_t k = 0; k < num_cols(A); ++k) {
+                nar |= A(i, k).isNaR() || B(k, j).isNaR();
+                q += sw::unum::quire_mul(A(i, k), B(k, j));
+            }
+            if (nar)
+                C(i, j).setToNaR();
+            else
+                convert(q.to_value(), C(i, j));
+        }
+    }
+}
+
+struct gemm_benchmark
+{
+    template <std::size_t Nbits, std::size_t ES>
+    void run(std::size_t n)
+    {
+        using namespace std;
+        using posit_type = sw::unum::posit<Nbits, ES>;
+
+        mt19937_64 eng(n);
+        uniform_real_distribution<double> magnitude(-4.0, 4.0);
+        mtl::dense2D<posit_type> A(n, n), B(n, n), C(n, n), R(n, n);
+        for (size_t i = 0; i < n; ++i) {
+            for (size_t j = 0; j < n; ++j) {
+                A(i, j) = (eng() & 1 ? -1.0 : 1.0) * exp2(magnitude(eng));
+                B(i, j) = (eng() & 1 ? -1.0 : 1.0) * exp2(magnitude(eng));
+            }
+        }
+
+        const size_t flops = 2 * n * n * n;      // one multiply and one add per term
+        timing_summary naive = measure([&]() { triple_loop_gemm(A, B, R); }, 0, repetitions);
+        timing_summary serial = measure([&]() { fused_gemm(A, B, C, 1); }, 0, repetitions);
+        timing_summary parallel = measure([&]() { fused_gemm(A, B, C, nrOfThreads); }, 0, repetitions);
+
+        size_t mismatches = 0;
+        for (size_t i = 0; i < n; ++i)
+            for (size_t j = 0; j < n; ++j)
+                mismatches += C(i, j) != R(i, j);
+
+        results.push_back(benchmark_result{ "gemm_triple_loop", "throughput", Nbits, ES, flops, naive });
+        results.push_back(benchmark_result{ "gemm_blocked_1t", "throughput", Nbits, ES, flops, serial });
+        results.push_back(benchmark_result{ "gemm_blocked_" + to_string(nrOfThreads) + "t", "throughput", Nbits, ES, flops, parallel });
+
+        auto gflops = [flops](const timing_summary& t) { return t.median > 0 ? flops / t.median * 1.0e-9 : 0.0; };
+        cout << setw(12) << ("posit<" + to_string(Nbits) + "," + to_string(ES) + ">") << setw(7) << n
+             << fixed << setprecision(4)
+             << setw(14) << gflops(naive) << setw(14) << gflops(serial) << setw(14) << gflops(parallel)
+             << setprecision(2) << setw(10) << (serial.median > 0 ? naive.median / serial.median : 0.0)
+             << setw(10) << (parallel.median > 0 ? naive.median / parallel.median : 0.0)
+             << setw(12) << mismatches << '\n';
+    }
+
+    unsigned nrOfThreads;
+    std::size_t repetitions;
+    std::vector<benchmark_result> results;
+};
+
+// Usage: bench_fused_gemm [--max n] [--threads N] [--reps R] [--json file]    square sizes 64, 128, .. max
+int main(int argc, char** argv)
+try {
+    using namespace std;
+
+    size_t maxSize = 256;
+    gemm_benchmark bench{ 0, 3, {} };
+    string json;
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        if (arg == "--max" && i + 1 < argc) maxSize = size_t(stoull(argv[++i]));
+        else if (arg == "--threads" && i + 1 < argc) bench.nrOfThreads = unsigned(stoul(argv[++i]));
+        else if (arg == "--reps" && i + 1 < argc) bench.repetitions = size_t(stoull(argv[++i]));
+        else if (arg == "--json" && i + 1 < argc) json = argv[++i];
+        else {
+            cerr << "Usage: bench_fused_gemm [--max n] [--threads N] [--reps R] [--json file]\n";
+            return EXIT_FAILURE;
+        }
+    }
+    if (bench.nrOfThreads == 0) bench.nrOfThreads = max(1u, thread::hardware_concurrency());
+
+    cout << "GFLOP-equivalent rates (2n^3 / time), speedup over the triple loop\n";
+    cout << setw(12) << "format" << setw(7) << "n" << setw(14) << "triple loop" << setw(14) << "blocked 1t"
+         << setw(14) << ("blocked " + to_string(bench.nrOfThreads) + "t") << setw(10) << "x 1t" << setw(10) << "x Nt"
+         << setw(12) << "mismatches" << '\n';
+    for (size_t n = 64; n <= maxSize; n *= 2) {
+        bench.run<16, 1>(n);
+        bench.run<32, 2>(n);
+    }
+
+    if (!json.empty()) {
+        ofstream ostr(json);
+        write_json(ostr, "fused_gemm", bench.results);
+    }
+    return EXIT_SUCCESS;
+}
+catch (std::exception& err) {
+    std::cerr << err.what() << std::endl;
+    return EXIT_FAILURE;
+}
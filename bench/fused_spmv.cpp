@@ -0,0 +1,151 @@
+// fused_spmv.cpp: quire SpMV on CSR and SELL-C-sigma for banded and power-law matrices
+//
+// Copyright (C) 2017 Stillwater Supercomputing, Inc.
+//
+// This file is part of the universal numbers project, which is released under an MIT Open Source license.
+
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <iomanip>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <boost/numeric/mtl/mtl.hpp>
+#include <posit>
+
+#include "../kernels/fused_spmv.hpp"
+#include "bench_harness.hpp"
+
+// Largest part over the mean part, in nonzeros.
+inline double imbalance(const std::vector<std::size_t>& bounds, const std::size_t* starts)
+{
+    std::size_t largest = 0, parts = bounds.size() - 1;
+    for (std::size_t k = 0; k < parts; ++k)
+        largest = std::max(largest, starts[bounds[k + 1]] - starts[bounds[k]]);
+    std::size_t total = starts[bounds.back()] - starts[bounds.front()];
+    return total ? double(largest) * parts / total : 1.0;
+}
+
+struct spmv_benchmark
+{
+    template <std::size_t Nbits, std::size_t ES>
+    void run(const std::string& name, std::size_t n, bool bPowerLaw)
+    {
+        using namespace std;
+        using posit_type = sw::unum::posit<Nbits, ES>;
+
+        mt19937_64 eng(n);
+        uniform_real_distribution<double> magnitude(-4.0, 4.0), uniform(0.0, 1.0);
+        mtl::compressed2D<posit_type> A(n, n);
+        {
+            mtl::mat::inserter<mtl::compressed2D<posit_type> > ins(A, 16);
+            for (size_t r = 0; r < n; ++r) {
+                if (bPowerLaw) {
+                    // Pareto row lengths with exponent 2: a few rows carry a large part of the nonzeros
+                    size_t length = min(n, size_t(2.0 / sqrt(1.0 - uniform(eng))));
+                    for (size_t k = 0; k < length; ++k)
+                        ins[r][eng() % n] << posit_type((eng() & 1 ? -1.0 : 1.0) * exp2(magnitude(eng)));
+                }
+                else {
+                    for (size_t c = (r < band ? 0 : r - band); c <= min(n - 1, r + band); ++c)
+                        ins[r][c] << posit_type((eng() & 1 ? -1.0 : 1.0) * exp2(magnitude(eng)));
+                }
+            }
+        }
+        mtl::dense_vector<posit_type> x(n), y(n);
+        for (size_t c = 0; c < n; ++c)
+            x[c] = exp2(magnitude(eng));
+
+        // double CSR on the same values
+        const size_t* starts = A.address_major();
+        const size_t* indices = A.address_minor();
+        vector<double> dvalues(A.nnz()), dx(n), dy(n);
+        for (size_t k = 0; k < dvalues.size(); ++k)
+            dvalues[k] = double(A.address_data()[k]);
+        for (size_t c = 0; c < n; ++c)
+            dx[c] = double(x[c]);
+
+        const size_t flops = 2 * A.nnz();
+        sell_matrix<Nbits, ES> S(A);
+        timing_summary csr1 = measure([&]() { fused_spmv(A, x, y, 1); }, 1, repetitions);
+        timing_summary csrN = measure([&]() { fused_spmv(A, x, y, nrOfThreads); }, 1, repetitions);
+        timing_summary sellN = measure([&]() { fused_spmv(S, x, y, nrOfThreads); }, 1, repetitions);
+        timing_summary dbl = measure([&]() {
+            for (size_t r = 0; r < n; ++r) {
+                double s = 0.0;
+                for (size_t k = starts[r]; k < starts[r + 1]; ++k)
+                    s += dvalues[k] * dx[indices[k]];
+                dy[r] = s;
+            }
+        }, 1, repetitions);
+
+        results.push_back(benchmark_result{ name + "_csr_1t", "throughput", Nbits, ES, flops, csr1 });
+        results.push_back(benchmark_result{ name + "_csr_nnz_balanced", "throughput", Nbits, ES, flops, csrN });
+        results.push_back(benchmark_result{ name + "_sell", "throughput", Nbits, ES, flops, sellN });
+        results.push_back(benchmark_result{ name + "_double", "throughput", Nbits, ES, flops, dbl });
+
+        vector<size_t> equal_rows(nrOfThreads + 1);
+        for (unsigned k = 0; k <= nrOfThreads; ++k)
+            equal_rows[k] = n * k / nrOfThreads;
+        auto gflops = [flops](const timing_summary& t) { return t.median > 0 ? flops / t.median * 1.0e-9 : 0.0; };
+        cout << setw(10) << name << setw(12) << ("posit<" + to_string(Nbits) + "," + to_string(ES) + ">")
+             << setw(10) << A.nnz() << fixed << setprecision(4)
+             << setw(10) << gflops(csr1) << setw(10) << gflops(csrN) << setw(10) << gflops(sellN) << setw(10) << gflops(dbl)
+             << setprecision(2) << setw(10) << S.fill_ratio(A.nnz())
+             << setw(10) << imbalance(equal_rows, starts)
+             << setw(10) << imbalance(balanced_partition(starts, n, nrOfThreads), starts) << '\n';
+    }
+
+    unsigned nrOfThreads;
+    std::size_t repetitions, band;
+    std::vector<benchmark_result> results;
+};
+
+// Usage: bench_fused_spmv [--n rows] [--band b] [--threads N] [--reps R] [--json file]
+int main(int argc, char** argv)
+try {
+    using namespace std;
+
+    size_t n = 20000;
+    spmv_benchmark bench{ 0, 3, 8, {} };
+    string json;
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        if (arg == "--n" && i + 1 < argc) n = size_t(stoull(argv[++i]));
+        else if (arg == "--band" && i + 1 < argc) bench.band = size_t(stoull(argv[++i]));
+        else if (arg == "--threads" && i + 1 < argc) bench.nrOfThreads = unsigned(stoul(argv[++i]));
+        else if (arg == "--reps" && i + 1 < argc) bench.repetitions = size_t(stoull(argv[++i]));
+        else if (arg == "--json" && i + 1 < argc) json = argv[++i];
+        else {
+            cerr << "Usage: bench_fused_spmv [--n rows] [--band b] [--threads N] [--reps R] [--json file]\n";
+            return EXIT_FAILURE;
+        }
+    }
+    if (n == 0) {
+        cerr << "--n must be positive\n";
+        return EXIT_FAILURE;
+    }
+    if (bench.nrOfThreads == 0) bench.nrOfThreads = max(1u, thread::hardware_concurrency());
+
+    cout << "GFLOP-equivalent rates (2 nnz / time) with " << bench.nrOfThreads << " threads; "
+         << "SELL-C-sigma fill ratio; largest/mean nonzeros per thread for equal-row and nnz-balanced partitions\n";
+    cout << setw(10) << "matrix" << setw(12) << "format" << setw(10) << "nnz" << setw(10) << "csr 1t" << setw(10) << "csr Nt"
+         << setw(10) << "sell Nt" << setw(10) << "double" << setw(10) << "fill" << setw(10) << "rows" << setw(10) << "nnz" << '\n';
+    bench.run<16, 1>("banded", n, false);
+    bench.run<32, 2>("banded", n, false);
+    bench.run<16, 1>("powerlaw", n, true);
+    bench.run<32, 2>("powerlaw", n, true);
+
+    if (!json.empty()) {
+        ofstream ostr(json);
+        write_json(ostr, "fused_spmv", bench.results);
+    }
+    return EXIT_SUCCESS;
+}
+catch (std::exception& err) {
+    std::cerr << err.what() << std::endl;
+    return EXIT_FAILURE;
+}
@@ -0,0 +1,104 @@
+// lut_arithmetic.cpp: throughput of table-driven vs generic posit arithmetic for small formats
+//
+// Copyright (C) 2017 Stillwater Supercomputing, Inc.
+//
+// This file is part of the universal numbers project, which is released under an MIT Open Source license.
+
+#include <cstdint>
+#include <chrono>
+#include <iostream>
+#include <iomanip>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <posit>
+
+#include "../utilities/dispatch_table.hpp"
+#include "../utilities/posit_engine.hpp"
+
+struct compare_engines
+{
+    template <std::size_t Nbits, std::size_t ES>
+    void operator()()
+    {
+        measure<Nbits, ES>(std::integral_constant<bool, (Nbits <= lut_max_nbits)>{});
+    }
+
+    // configurations without result tables are not instantiated
+    template <std::size_t Nbits, std::size_t ES>
+    void measure(std::false_type) {}
+
+    template <std::size_t Nbits, std::size_t ES>
+    void measure(std::true_type)
+    {
+        using namespace std;
+        using raw_type = typename lut_posit_engine<Nbits, ES>::raw_type;
+
+        mt19937_64 eng(Nbits * 16 + ES);
+        vector<raw_type> a(n), b(n), generic_result(n), lut_result(n);
+        for (size_t i = 0; i < n; ++i) {
+            a[i] = raw_type(eng() & ((1u << Nbits) - 1));
+            b[i] = raw_type(eng() & ((1u << Nbits) - 1));
+        }
+
+        auto build_start = chrono::steady_clock::now();
+        lut_posit_engine<Nbits, ES> lut;      // first use builds the tables
+        double build = chrono::duration<double>(chrono::steady_clock::now() - build_start).count();
+        generic_posit_engine<Nbits, ES> generic;
+
+        auto ops_per_second = [&](auto&& engine, auto op, vector<raw_type>& c) {
+            auto start = chrono::steady_clock::now();
+            for (size_t i = 0; i < n; ++i)
+                c[i] = op(engine, a[i], b[i]);
+            return double(n) / chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        };
+        auto add = [](auto& e, raw_type x, raw_type y) { return e.add(x, y); };
+        auto mul = [](auto& e, raw_type x, raw_type y) { return e.mul(x, y); };
+
+        double generic_add = ops_per_second(generic, add, generic_result);
+        double lut_add = ops_per_second(lut, add, lut_result);
+        errors += generic_result != lut_result;
+        double generic_mul = ops_per_second(generic, mul, generic_result);
+        double lut_mul = ops_per_second(lut, mul, lut_result);
+        errors += generic_result != lut_result;
+
+        cout << setw(12) << ("posit<" + to_string(Nbits) + "," + to_string(ES) + ">")
+             << scientific << setprecision(3)
+             << setw(14) << generic_add << setw(14) << lut_add
+             << setw(14) << generic_mul << setw(14) << lut_mul
+             << fixed << setprecision(1) << setw(10) << lut_add / generic_add << setw(10) << lut_mul / generic_mul
+             << setw(12) << lut_posit_engine<Nbits, ES>::footprint() / 1024 << setw(10) << setprecision(3) << build << '\n';
+    }
+
+    std::size_t n;
+    int errors = 0;
+};
+
+// Usage: bench_lut_arithmetic [nrOfOperations]
+int main(int argc, char** argv)
+try {
+    using namespace std;
+
+    size_t n = 1 << 20;
+    if (argc > 1)
+        n = size_t(stoull(argv[1]));
+
+    cout << "Operations per second over " << n << " random operand pairs\n";
+    cout << setw(12) << "format" << setw(14) << "generic add" << setw(14) << "table add" << setw(14) << "generic mul" << setw(14) << "table mul"
+         << setw(10) << "add x" << setw(10) << "mul x" << setw(12) << "table KiB" << setw(10) << "build s" << '\n';
+    compare_engines bench{ n };
+    for (size_t nbits = dispatch_min_nbits; nbits <= lut_max_nbits; ++nbits)
+        for (size_t es = 0; es <= dispatch_max_es; ++es)
+            table_dispatch(bench, nbits, es);
+
+    if (bench.errors > 0) {
+        cerr << "Table and generic results disagree\n";
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
+catch (std::exception& err) {
+    std::cerr << err.what() << std::endl;
+    return EXIT_FAILURE;
+}
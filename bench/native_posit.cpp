@@ -0,0 +1,117 @@
+// native_posit.cpp: throughput of native-integer vs generic posit arithmetic for the standard formats
+//
+// Copyright (C) 2017 Stillwater Supercomputing, Inc.
+//
+// This file is part of the universal numbers project, which is released under an MIT Open Source license.
+
+#include <cstdint>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <posit>
+
+#include "../utilities/posit_engine.hpp"
+#include "../utilities/posit_native.hpp"
+#include "bench_harness.hpp"
+
+// Measures add, sub, mul, and div of one standard format with each engine and appends to results.
+struct native_posit_benchmark
+{
+    template <std::size_t Nbits, std::size_t ES>
+    void run()
+    {
+        using namespace std;
+        using raw_type = posit_storage_t<Nbits>;
+
+        // operands with magnitudes in [1/16, 16), where all formats have their longest fractions
+        mt19937_64 eng(Nbits * 16 + ES);
+        uniform_real_distribution<double> magnitude(-4.0, 4.0);
+        vector<double> da(n), db(n);
+        for (size_t i = 0; i < n; ++i) {
+            da[i] = (eng() & 1 ? -1.0 : 1.0) * exp2(magnitude(eng));
+            db[i] = (eng() & 1 ? -1.0 : 1.0) * exp2(magnitude(eng));
+        }
+        vector<raw_type> a(n), b(n), generic_result(n), native_result(n);
+        convert_to_posit<Nbits, ES>(da.data(), n, a.data());
+        convert_to_posit<Nbits, ES>(db.data(), n, b.data());
+
+        generic_posit_engine<Nbits, ES> generic;
+        native_posit_engine<Nbits, ES> native;
+
+        auto run_op = [&](const char* name, auto op) {
+            timing_summary g = measure([&]() { for (size_t i = 0; i < n; ++i) generic_result[i] = op(generic, a[i], b[i]); }, warmup, repetitions);
+            timing_summary f = measure([&]() { for (size_t i = 0; i < n; ++i) native_result[i] = op(native, a[i], b[i]); }, warmup, repetitions);
+            results.push_back(benchmark_result{ name, "generic", Nbits, ES, n, g });
+            results.push_back(benchmark_result{ name, "native", Nbits, ES, n, f });
+            if (generic_result != native_result) {
+                cerr << "posit<" << Nbits << "," << ES << "> " << name << ": native and generic results disagree\n";
+                ++mismatches;
+            }
+        };
+        run_op("add", [](const auto& e, raw_type x, raw_type y) { return e.add(x, y); });
+        run_op("sub", [](const auto& e, raw_type x, raw_type y) { return e.sub(x, y); });
+        run_op("mul", [](const auto& e, raw_type x, raw_type y) { return e.mul(x, y); });
+        run_op("div", [](const auto& e, raw_type x, raw_type y) { return e.div(x, y); });
+    }
+
+    std::size_t n, warmup, repetitions;
+    std::vector<benchmark_result> results;
+    int mismatches = 0;
+};
+
+// Usage: bench_native_posit [--n N] [--warmup W] [--reps R] [--json file]
+int main(int argc, char** argv)
+try {
+    using namespace std;
+
+    native_posit_benchmark bench{ 1 << 16, 1, 5, {} };
+    string json;
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        if (arg == "--n" && i + 1 < argc) bench.n = size_t(stoull(argv[++i]));
+        else if (arg == "--warmup" && i + 1 < argc) bench.warmup = size_t(stoull(argv[++i]));
+        else if (arg == "--reps" && i + 1 < argc) bench.repetitions = size_t(stoull(argv[++i]));
+        else if (arg == "--json" && i + 1 < argc) json = argv[++i];
+        else {
+            cerr << "Usage: bench_native_posit [--n N] [--warmup W] [--reps R] [--json file]\n";
+            return EXIT_FAILURE;
+        }
+    }
+    if (bench.n == 0 || bench.repetitions == 0) {
+        cerr << "--n and --reps must be positive\n";
+        return EXIT_FAILURE;
+    }
+
+    bench.run<8, 0>();
+    bench.run<16, 1>();
+    bench.run<32, 2>();
+#if EF_TENSORS_HAS_INT128
+    bench.run<64, 3>();
+#endif
+
+    print_results(cout, bench.results);
+    cout << '\n' << setw(12) << "format" << setw(13) << "op" << setw(12) << "speedup" << '\n';
+    for (size_t i = 0; i + 1 < bench.results.size(); i += 2) {
+        const benchmark_result& generic = bench.results[i];
+        const benchmark_result& native = bench.results[i + 1];
+        cout << setw(12) << ("posit<" + to_string(native.nbits) + "," + to_string(native.es) + ">") << setw(13) << native.name
+             << fixed << setprecision(1) << setw(11) << generic.ns_per_op() / native.ns_per_op() << "x\n";
+    }
+    if (!json.empty()) {
+        ofstream ostr(json);
+        write_json(ostr, "native_posit", bench.results);
+        if (!ostr) {
+            cerr << "unable to write " << json << '\n';
+            return EXIT_FAILURE;
+        }
+    }
+    return bench.mismatches > 0 ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+catch (std::exception& err) {
+    std::cerr << err.what() << std::endl;
+    return EXIT_FAILURE;
+}
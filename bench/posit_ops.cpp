@@ -0,0 +1,127 @@
+// posit_ops.cpp: throughput and latency of posit arithmetic and conversion over the nbits x es grid
+//
+// Copyright (C) 2017 Stillwater Supercomputing, Inc.
+//
+// This file is part of the universal numbers project, which is released under an MIT Open Source license.
+
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <posit>
+
+#include "../utilities/es_select.hpp"
+#include "../utilities/nbits_select.hpp"
+#include "../utilities/dispatch_table.hpp"
+#include "bench_harness.hpp"
+
+// Measures one posit<nbits, es> configuration and appends to results.
+struct posit_ops_benchmark
+{
+    template <std::size_t Nbits, std::size_t ES>
+    void operator()()
+    {
+        using namespace std;
+        using posit_type = sw::unum::posit<Nbits, ES>;
+
+        // operands with magnitudes in [1/16, 16), where all configurations have fraction bits
+        mt19937_64 eng(Nbits * 16 + ES);
+        uniform_real_distribution<double> magnitude(-4.0, 4.0);
+        vector<double> da(n), db(n);
+        vector<posit_type> a(n), b(n), c(n), rb(n);
+        for (size_t i = 0; i < n; ++i) {
+            da[i] = (eng() & 1 ? -1.0 : 1.0) * exp2(magnitude(eng));
+            db[i] = exp2(magnitude(eng) / 4.0);     // in [1/2, 2)
+            a[i] = da[i];
+            b[i] = db[i];
+            rb[i] = 1.0 / db[i];
+        }
+        vector<double> dc(n);
+
+        auto record = [&](const char* name, const char* kind, const timing_summary& t) {
+            results.push_back(benchmark_result{ name, kind, Nbits, ES, n, t });
+        };
+
+        // throughput: independent operations
+        record("add", "throughput", measure([&]() { for (size_t i = 0; i < n; ++i) c[i] = a[i] + b[i]; }, warmup, repetitions));
+        record("sub", "throughput", measure([&]() { for (size_t i = 0; i < n; ++i) c[i] = a[i] - b[i]; }, warmup, repetitions));
+        record("mul", "throughput", measure([&]() { for (size_t i = 0; i < n; ++i) c[i] = a[i] * b[i]; }, warmup, repetitions));
+        record("div", "throughput", measure([&]() { for (size_t i = 0; i < n; ++i) c[i] = a[i] / b[i]; }, warmup, repetitions));
+        record("from_double", "throughput", measure([&]() { for (size_t i = 0; i < n; ++i) c[i] = da[i]; }, warmup, repetitions));
+        record("to_double", "throughput", measure([&]() { for (size_t i = 0; i < n; ++i) dc[i] = double(a[i]); }, warmup, repetitions));
+
+        // latency: every operation depends on the previous result. Like the add chain alternates signs, the mul and
+        // div chains follow each factor by its reciprocal, so x stays near a[0] instead of drifting into maxpos or minpos.
+        posit_type x;
+        record("add", "latency", measure([&]() { x = a[0]; for (size_t i = 0; i < n; ++i) x = x + (i & 1 ? b[i] : -b[i]); }, warmup, repetitions));
+        record("mul", "latency", measure([&]() { x = a[0]; for (size_t i = 0; i < n; ++i) x = x * (i & 1 ? rb[i - 1] : b[i]); }, warmup, repetitions));
+        record("div", "latency", measure([&]() { x = a[0]; for (size_t i = 0; i < n; ++i) x = x / (i & 1 ? rb[i - 1] : b[i]); }, warmup, repetitions));
+        sink += double(x) + double(c[n / 2]) + dc[n / 2];
+    }
+
+    std::size_t n, warmup, repetitions;
+    std::vector<benchmark_result> results;
+    double sink = 0.0;      // folds in the results, printed by main so they stay observable
+};
+
+// Usage: bench_posit_ops [--n N] [--warmup W] [--reps R] [--nbits lo-hi] [--es e] [--json file]
+int main(int argc, char** argv)
+try {
+    using namespace std;
+
+    posit_ops_benchmark bench{ 1 << 14, 1, 5, {} };
+    size_t lo = dispatch_min_nbits, hi = dispatch_max_nbits, es_lo = 0, es_hi = dispatch_max_es;
+    string json;
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        if (arg == "--n" && i + 1 < argc) bench.n = size_t(stoull(argv[++i]));
+        else if (arg == "--warmup" && i + 1 < argc) bench.warmup = size_t(stoull(argv[++i]));
+        else if (arg == "--reps" && i + 1 < argc) bench.repetitions = size_t(stoull(argv[++i]));
+        else if (arg == "--es" && i + 1 < argc) es_lo = es_hi = size_t(stoull(argv[++i]));
+        else if (arg == "--json" && i + 1 < argc) json = argv[++i];
+        else if (arg == "--nbits" && i + 1 < argc) {
+            string range = argv[++i];
+            size_t dash = range.find('-');
+            lo = size_t(stoull(range.substr(0, dash)));
+            hi = dash == string::npos ? lo : size_t(stoull(range.substr(dash + 1)));
+        }
+        else {
+            cerr << "Usage: bench_posit_ops [--n N] [--warmup W] [--reps R] [--nbits lo-hi] [--es e] [--json file]\n";
+            return EXIT_FAILURE;
+        }
+    }
+    if (bench.n == 0 || bench.repetitions == 0) {
+        cerr << "--n and --reps must be positive\n";
+        return EXIT_FAILURE;
+    }
+
+    for (size_t nbits = lo; nbits <= hi; ++nbits) {
+        for (size_t es = es_lo; es <= es_hi; ++es) {
+            if (!valid_posit_configuration(nbits, es))
+                continue;
+            // selection through the same run-time machinery the applications use
+            dispatch_status status = table_dispatch(bench, nbits_select(nbits), es_select(es));
+            if (status != dispatch_status::ok)
+                cerr << "posit<" << nbits << "," << es << ">: " << to_string(status) << '\n';
+        }
+    }
+
+    print_results(cout, bench.results);
+    cerr << "checksum " << bench.sink << '\n';
+    if (!json.empty()) {
+        ofstream ostr(json);
+        write_json(ostr, "posit_ops", bench.results);
+        if (!ostr) {
+            cerr << "unable to write " << json << '\n';
+            return EXIT_FAILURE;
+        }
+    }
+    return EXIT_SUCCESS;
+}
+catch (std::exception& err) {
+    std::cerr << err.what() << std::endl;
+    return EXIT_FAILURE;
+}
@@ -0,0 +1,100 @@
+// posit_tensor.cpp: footprint and bandwidth of packed posit tensors against arrays of posit objects
+//
+// Copyright (C) 2017 Stillwater Supercomputing, Inc.
+//
+// This file is part of the universal numbers project, which is released under an MIT Open Source license.
+
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <iomanip>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <posit>
+
+#include "../kernels/tensor_ops.hpp"
+#include "bench_harness.hpp"
+
+struct tensor_benchmark
+{
+    template <std::size_t Nbits, std::size_t ES>
+    void run()
+    {
+        using namespace std;
+        using posit_type = sw::unum::posit<Nbits, ES>;
+
+        mt19937_64 eng(Nbits);
+        uniform_real_distribution<double> magnitude(-4.0, 4.0);
+        vector<double> in(n), out(n);
+        for (auto& v : in)
+            v = (eng() & 1 ? -1.0 : 1.0) * exp2(magnitude(eng));
+
+        posit_tensor a(Nbits, ES, { n }), b(Nbits, ES, { n }), c(Nbits, ES, { n });
+        vector<posit_type> pa(n), pb(n), pc(n);
+        pack(in.data(), a.view());
+        pack(in.data(), b.view());
+        for (size_t i = 0; i < n; ++i)
+            pa[i] = pb[i] = in[i];
+
+        timing_summary packing = measure([&]() { pack(in.data(), a.view()); }, 1, repetitions);
+        timing_summary unpacking = measure([&]() { unpack(a.view(), out.data()); }, 1, repetitions);
+        timing_summary tensor_add = measure([&]() { tensor_binary_op(tensor_op::add, a.view(), b.view(), c.view()); }, 1, repetitions);
+        timing_summary object_add = measure([&]() { for (size_t i = 0; i < n; ++i) pc[i] = pa[i] + pb[i]; }, 1, repetitions);
+        results.push_back(benchmark_result{ "pack", "throughput", Nbits, ES, n, packing });
+        results.push_back(benchmark_result{ "unpack", "throughput", Nbits, ES, n, unpacking });
+        results.push_back(benchmark_result{ "tensor_add", "throughput", Nbits, ES, n, tensor_add });
+        results.push_back(benchmark_result{ "object_add", "throughput", Nbits, ES, n, object_add });
+
+        // footprint of 10^9 elements
+        const double giga = 1.0e9, GB = 1.0e9;
+        cout << setw(12) << ("posit<" + to_string(Nbits) + "," + to_string(ES) + ">") << fixed << setprecision(2)
+             << setw(12) << giga * Nbits / 8 / GB
+             << setw(12) << giga * posit_storage_bytes(Nbits) / GB
+             << setw(12) << giga * sizeof(posit_type) / GB
+             << setprecision(1)
+             << setw(12) << 1.0e-6 * n / packing.median << setw(12) << 1.0e-6 * n / unpacking.median
+             << setw(12) << 1.0e-6 * n / tensor_add.median << setw(12) << 1.0e-6 * n / object_add.median << '\n';
+    }
+
+    std::size_t n, repetitions;
+    std::vector<benchmark_result> results;
+};
+
+// Usage: bench_posit_tensor [--n N] [--reps R] [--json file]
+int main(int argc, char** argv)
+try {
+    using namespace std;
+
+    tensor_benchmark bench{ 1 << 18, 3, {} };
+    string json;
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        if (arg == "--n" && i + 1 < argc) bench.n = size_t(stoull(argv[++i]));
+        else if (arg == "--reps" && i + 1 < argc) bench.repetitions = size_t(stoull(argv[++i]));
+        else if (arg == "--json" && i + 1 < argc) json = argv[++i];
+        else {
+            cerr << "Usage: bench_posit_tensor [--n N] [--reps R] [--json file]\n";
+            return EXIT_FAILURE;
+        }
+    }
+
+    cout << "GB for 10^9 elements packed / native integers / posit objects; million elements per second\n";
+    cout << setw(12) << "format" << setw(12) << "packed" << setw(12) << "native" << setw(12) << "objects"
+         << setw(12) << "pack" << setw(12) << "unpack" << setw(12) << "tensor add" << setw(12) << "object add" << '\n';
+    bench.run<8, 0>();
+    bench.run<12, 1>();
+    bench.run<16, 1>();
+    bench.run<20, 2>();
+
+    if (!json.empty()) {
+        ofstream ostr(json);
+        write_json(ostr, "posit_tensor", bench.results);
+    }
+    return EXIT_SUCCESS;
+}
+catch (std::exception& err) {
+    std::cerr << err.what() << std::endl;
+    return EXIT_FAILURE;
+}
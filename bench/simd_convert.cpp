@@ -0,0 +1,123 @@
+// simd_convert.cpp: GB/s of double <-> standard posit conversion for the library, the scalar codec, AVX2, and AVX-512
+//
+// Copyright (C) 2017 Stillwater Supercomputing, Inc.
+//
+// This file is part of the universal numbers project, which is released under an MIT Open Source license.
+
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <iomanip>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <posit>
+
+#include "../utilities/batch_convert.hpp"
+#include "../utilities/simd_convert.hpp"
+#include "bench_harness.hpp"
+
+struct conversion_benchmark
+{
+    template <std::size_t Nbits, std::size_t ES>
+    void run()
+    {
+        using namespace std;
+        using raw_type = posit_storage_t<Nbits>;
+
+        mt19937_64 eng(Nbits);
+        uniform_real_distribution<double> scale(-40.0, 40.0);
+        vector<double> in(n), out(n);
+        vector<raw_type> raw(n);
+        for (auto& v : in)
+            v = (eng() & 1 ? -1.0 : 1.0) * exp2(scale(eng));
+
+        if (verify) {
+            for (simd_level level : { simd_level::scalar, simd_level::avx2, simd_level::avx512 }) {
+                if (level > detect_simd_level())
+                    continue;
+                conversion_check check = verify_simd_conversion<Nbits, ES>(in.data(), n, level);
+                cout << setw(12) << ("posit<" + to_string(Nbits) + "," + to_string(ES) + ">") << setw(8) << to_string(level)
+                     << setw(12) << check.lanes << " lanes" << setw(10) << check.encode_mismatches << " encode"
+                     << setw(10) << check.decode_mismatches << " decode mismatches\n";
+                failures += check.encode_mismatches + check.decode_mismatches;
+            }
+            return;
+        }
+
+        const double bytes = double(n) * (sizeof(double) + sizeof(raw_type));
+        auto report = [&](const string& method, const timing_summary& encode, const timing_summary& decode) {
+            results.push_back(benchmark_result{ method + "_encode", "throughput", Nbits, ES, n, encode });
+            results.push_back(benchmark_result{ method + "_decode", "throughput", Nbits, ES, n, decode });
+            cout << setw(12) << ("posit<" + to_string(Nbits) + "," + to_string(ES) + ">") << setw(10) << method
+                 << fixed << setprecision(3) << setw(12) << bytes / encode.median * 1.0e-9 << setw(12) << bytes / decode.median * 1.0e-9 << '\n';
+        };
+
+        report("library", measure([&]() { convert_to_posit<Nbits, ES>(in.data(), n, raw.data()); }, 1, repetitions),
+                          measure([&]() { convert_from_posit<Nbits, ES>(raw.data(), n, out.data()); }, 1, repetitions));
+        for (simd_level level : { simd_level::scalar, simd_level::avx2, simd_level::avx512 }) {
+            if (level > detect_simd_level())
+                continue;
+            report(to_string(level), measure([&]() { simd_encode<Nbits, ES>(in.data(), n, raw.data(), level); }, 1, repetitions),
+                                     measure([&]() { simd_decode<Nbits, ES>(raw.data(), n, out.data(), level); }, 1, repetitions));
+        }
+    }
+
+    std::size_t n, repetitions;
+    bool verify;
+    std::size_t failures;
+    std::vector<benchmark_result> results;
+};
+
+// Usage: bench_simd_convert [--n N] [--reps R] [--verify] [--json file]
+int main(int argc, char** argv)
+try {
+    using namespace std;
+
+    conversion_benchmark bench{ 1 << 20, 5, false, 0, {} };
+    string json;
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        if (arg == "--n" && i + 1 < argc) bench.n = size_t(stoull(argv[++i]));
+        else if (arg == "--reps" && i + 1 < argc) bench.repetitions = size_t(stoull(argv[++i]));
+        else if (arg == "--verify") bench.verify = true;
+        else if (arg == "--json" && i + 1 < argc) json = argv[++i];
+        else {
+            cerr << "Usage: bench_simd_convert [--n N] [--reps R] [--verify] [--json file]\n";
+            return EXIT_FAILURE;
+        }
+    }
+
+    cout << "detected instruction set: " << to_string(detect_simd_level()) << '\n';
+    if (!bench.verify)
+        cout << setw(12) << "format" << setw(10) << "method" << setw(12) << "encode GB/s" << setw(12) << "decode GB/s" << '\n';
+    bench.run<8, 0>();
+    bench.run<16, 1>();
+    bench.run<32, 2>();
+    if (bench.verify)
+        return bench.failures ? EXIT_FAILURE : EXIT_SUCCESS;
+
+    // posit<64,3> has no vector kernel, standard_variant dispatch converts it with the library
+    {
+        vector<double> in(bench.n, 1.0 / 3.0), out(bench.n);
+        vector<uint64_t> raw(bench.n);
+        const double bytes = double(bench.n) * 16;
+        timing_summary encode = measure([&]() { simd_encode(in.data(), bench.n, raw.data(), standard_select(64)); }, 1, bench.repetitions);
+        timing_summary decode = measure([&]() { simd_decode(raw.data(), bench.n, out.data(), standard_select(64)); }, 1, bench.repetitions);
+        bench.results.push_back(benchmark_result{ "library_encode", "throughput", 64, 3, bench.n, encode });
+        bench.results.push_back(benchmark_result{ "library_decode", "throughput", 64, 3, bench.n, decode });
+        cout << setw(12) << "posit<64,3>" << setw(10) << "library" << fixed << setprecision(3)
+             << setw(12) << bytes / encode.median * 1.0e-9 << setw(12) << bytes / decode.median * 1.0e-9 << '\n';
+    }
+
+    if (!json.empty()) {
+        ofstream ostr(json);
+        write_json(ostr, "simd_convert", bench.results);
+    }
+    return EXIT_SUCCESS;
+}
+catch (std::exception& err) {
+    std::cerr << err.what() << std::endl;
+    return EXIT_FAILURE;
+}
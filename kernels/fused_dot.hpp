@@ -0,0 +1,114 @@
+// fused_dot.hpp: error-free dot product of posit vectors with quire accumulation and a single rounding
+//
+// Copyright (C) 2017 Stillwater Supercomputing, Inc.
+//
+// This file is part of the universal numbers project, which is released under an MIT Open Source license.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+
+#include <boost/numeric/mtl/mtl.hpp>
+#include <posit>
+
+#include "../utilities/es_select.hpp"
+#include "../utilities/nbits_select.hpp"
+#include "../utilities/dispatch_table.hpp"
+#include "../utilities/batch_convert.hpp"
+#include "../utilities/event_counters.hpp"
+
+/// Quire capacity of the kernels: 2^30 products of maxpos magnitude accumulate without overflow.
+constexpr std::size_t kernel_quire_capacity = 30;
+
+/// Products computed ahead of their accumulation in the inner loops.
+constexpr std::size_t dot_unroll = 4;
+
+namespace detail {
+
+    // Accumulates x(i) * y(i) over [0, n). The unrolled products are independent
+    // of each other; only the additions into the quire are sequential, and those are exact.
+    template <std::size_t Nbits, std::size_t ES, typename LoadX, typename LoadY>
+    sw::unum::posit<Nbits, ES> fused_dot_n(LoadX x, LoadY y, std::size_t n)
+    {
+        using posit_type = sw::unum::posit<Nbits, ES>;
+        sw::unum::quire<Nbits, ES, kernel_quire_capacity> q;
+        bool nar = false;
+
+        std::size_t i = 0;
+        for (; i + dot_unroll <= n; i += dot_unroll) {
+            const posit_type x0 = x(i), x1 = x(i + 1), x2 = x(i + 2), x3 = x(i + 3);
+            const posit_type y0 = y(i), y1 = y(i + 1), y2 = y(i + 2), y3 = y(i + 3);
+            nar |= x0.isNaR() | x1.isNaR() | x2.isNaR() | x3.isNaR() | y0.isNaR() | y1.isNaR() | y2.isNaR() | y3.isNaR();
+            const auto p0 = sw::unum::quire_mul(x0, y0);
+            const auto p1 = sw::unum::quire_mul(x1, y1);
+            const auto p2 = sw::unum::quire_mul(x2, y2);
+            const auto p3 = sw::unum::quire_mul(x3, y3);
+            q += p0;
+            q += p1;
+            q += p2;
+            q += p3;
+        }
+        for (; i < n; ++i) {
+            const posit_type xi = x(i), yi = y(i);
+            nar |= xi.isNaR() | yi.isNaR();
+            q += sw::unum::quire_mul(xi, yi);
+        }
+
+        posit_type result;
+        if (nar)
+            result.setToNaR();
+        else
+            convert(q.to_value(), result);
+        if (event_counters_enabled)
+            record_quire_result(result, q, n, kernel_quire_capacity, nar);
+        return result;
+    }
+
+} // namespace detail
+
+/// Dot product of x and y rounded once; NaR if any element is NaR.
+template <std::size_t Nbits, std::size_t ES>
+sw::unum::posit<Nbits, ES> fused_dot(const mtl::dense_vector<sw::unum::posit<Nbits, ES> >& x,
+                                     const mtl::dense_vector<sw::unum::posit<Nbits, ES> >& y)
+{
+    using posit_type = sw::unum::posit<Nbits, ES>;
+    if (size(x) != size(y))
+        throw std::invalid_argument("fused_dot: vectors differ in size");
+    return detail::fused_dot_n<Nbits, ES>([&x](std::size_t i) -> const posit_type& { return x[i]; },
+                                          [&y](std::size_t i) -> const posit_type& { return y[i]; },
+                                          size(x));
+}
+
+/// Dot product of n packed posit<Nbits, ES> encodings.
+template <std::size_t Nbits, std::size_t ES>
+sw::unum::posit<Nbits, ES> fused_dot(const posit_storage_t<Nbits>* x, const posit_storage_t<Nbits>* y, std::size_t n)
+{
+    using posit_type = sw::unum::posit<Nbits, ES>;
+    return detail::fused_dot_n<Nbits, ES>([x](std::size_t i) { posit_type p; p.set_raw_bits(x[i]); return p; },
+                                          [y](std::size_t i) { posit_type p; p.set_raw_bits(y[i]); return p; },
+                                          n);
+}
+
+struct fused_dot_visitor
+{
+    template <std::size_t Nbits, std::size_t ES>
+    void operator()() const
+    {
+        auto r = fused_dot<Nbits, ES>(static_cast<const posit_storage_t<Nbits>*>(x_), static_cast<const posit_storage_t<Nbits>*>(y_), n_);
+        *static_cast<posit_storage_t<Nbits>*>(result_) = posit_storage_t<Nbits>(r.get().to_ullong());
+    }
+
+    const void* x_;
+    const void* y_;
+    std::size_t n_;
+    void* result_;
+};
+
+/// Dot product of packed encodings in the selected format with a single dispatch.
+//  x and y hold n * posit_storage_bytes(nbits) bytes, result one element.
+inline dispatch_status fused_dot(const void* x, const void* y, std::size_t n, void* result, const nbits_variant& nbitsv, const es_variant& esv)
+{
+    return table_dispatch(fused_dot_visitor{ x, y, n, result }, nbitsv, esv);
+}
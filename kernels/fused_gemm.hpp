@@ -0,0 +1,218 @@
+// fused_gemm.hpp: cache-blocked, multi-threaded C = A * B on posit matrices with one quire per output element
+//
+// Copyright (C) 2017 Stillwater Supercomputing, Inc.
+//
+// This file is part of the universal numbers project, which is released under an MIT Open Source license.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include <boost/numeric/mtl/mtl.hpp>
+#include <posit>
+
+#include "../utilities/batch_convert.hpp"
+#include "../utilities/event_counters.hpp"
+#include "../utilities/work_stealing.hpp"
+#include "fused_dot.hpp"
+
+/// Register tile: each step of the micro-kernel loads gemm_mr + gemm_nr operands for gemm_mr * gemm_nr products.
+constexpr std::size_t gemm_mr = 4;
+constexpr std::size_t gemm_nr = 4;
+
+/// Cache blocking of the output tiles (mc x nc) and of the reduction dimension (kc).
+//  The packed kc x mr and kc x nr micro-panels stream from L1, the mc x kc panel of A stays in L2.
+struct gemm_blocking
+{
+    std::size_t mc = 64;
+    std::size_t nc = 64;
+    std::size_t kc = 256;
+};
+
+namespace detail {
+
+    template <std::size_t Nbits, std::size_t ES>
+    struct gemm_tile_workspace
+    {
+        using raw_type = posit_storage_t<Nbits>;
+        using quire_type = sw::unum::quire<Nbits, ES, kernel_quire_capacity>;
+
+        gemm_tile_workspace(const gemm_blocking& blk)
+            : mcp((blk.mc + gemm_mr - 1) / gemm_mr * gemm_mr), ncp((blk.nc + gemm_nr - 1) / gemm_nr * gemm_nr),
+              packed_a(mcp * blk.kc), packed_b(ncp * blk.kc), quires(mcp * ncp), nar_row(mcp), nar_col(ncp) {}
+
+        std::size_t mcp, ncp;                // tile extent rounded up to whole register tiles
+        std::vector<raw_type> packed_a;      // micro-panels of gemm_mr rows, k-major
+        std::vector<raw_type> packed_b;      // micro-panels of gemm_nr columns, k-major
+        std::vector<quire_type> quires;      // row-major mcp x ncp
+        std::vector<char> nar_row, nar_col;
+    };
+
+    // Copy A(i0:i0+m, p0:p0+k) into gemm_mr-row micro-panels, zero padded; record rows holding NaR.
+    template <std::size_t Nbits, std::size_t ES, typename Matrix>
+    void pack_a(const Matrix& A, std::size_t i0, std::size_t m, std::size_t p0, std::size_t k, gemm_tile_workspace<Nbits, ES>& ws)
+    {
+        using raw_type = posit_storage_t<Nbits>;
+        raw_type* dst = ws.packed_a.data();
+        for (std::size_t ir = 0; ir < m; ir += gemm_mr) {
+            for (std::size_t p = 0; p < k; ++p) {
+                for (std::size_t r = 0; r < gemm_mr; ++r, ++dst) {
+                    if (ir + r < m) {
+                        const auto& a = A(i0 + ir + r, p0 + p);
+                        *dst = raw_type(a.get().to_ullong());
+                        ws.nar_row[ir + r] |= a.isNaR();
+                    }
+                    else {
+                        *dst = 0;
+                    }
+                }
+            }
+        }
+    }
+
+    // Copy B(p0:p0+k, j0:j0+n) into gemm_nr-column micro-panels, zero padded; record columns holding NaR.
+    template <std::size_t Nbits, std::size_t ES, typename Matrix>
+    void pack_b(const Matrix& B, std::size_t p0, std::size_t k, std::size_t j0, std::size_t n, gemm_tile_workspace<Nbits, ES>& ws)
+    {
+        using raw_type = posit_storage_t<Nbits>;
+        raw_type* dst = ws.packed_b.data();
+        for (std::size_t jr = 0; jr < n; jr += gemm_nr) {
+            for (std::size_t p = 0; p < k; ++p) {
+                for (std::size_t c = 0; c < gemm_nr; ++c, ++dst) {
+                    if (jr + c < n) {
+                        const auto& b = B(p0 + p, j0 + jr + c);
+                        *dst = raw_type(b.get().to_ullong());
+                        ws.nar_col[jr + c] |= b.isNaR();
+                    }
+                    else {
+                        *dst = 0;
+                    }
+                }
+            }
+        }
+    }
+
+    // Accumulate a gemm_mr x k micro-panel times a k x gemm_nr micro-panel into the quires of one register tile.
+    template <std::size_t Nbits, std::size_t ES, typename Quire>
+    void gemm_micro_kernel(std::size_t k, const posit_storage_t<Nbits>* a, const posit_storage_t<Nbits>* b, Quire* q, std::size_t ldq)
+    {
+        sw::unum::posit<Nbits, ES> pa[gemm_mr], pb[gemm_nr];
+        for (std::size_t p = 0; p < k; ++p, a += gemm_mr, b += gemm_nr) {
+            for (std::size_t r = 0; r < gemm_mr; ++r)
+                pa[r].set_raw_bits(a[r]);
+            for (std::size_t c = 0; c < gemm_nr; ++c)
+                pb[c].set_raw_bits(b[c]);
+            for (std::size_t r = 0; r < gemm_mr; ++r)
+                for (std::size_t c = 0; c < gemm_nr; ++c)
+                    q[r * ldq + c] += sw::unum::quire_mul(pa[r], pb[c]);
+        }
+    }
+
+} // namespace detail
+
+namespace detail {
+
+    // Row-major packed encodings seen as a matrix of posits, for the raw-array entry point.
+    template <std::size_t Nbits, std::size_t ES>
+    struct raw_matrix
+    {
+        sw::unum::posit<Nbits, ES> operator()(std::size_t i, std::size_t j) const
+        {
+            sw::unum::posit<Nbits, ES> p;
+            p.set_raw_bits(data[i * cols + j]);
+            return p;
+        }
+
+        const posit_storage_t<Nbits>* data;
+        std::size_t cols;
+    };
+
+    // The tiled product behind both entry points; store(i, j, c) receives each rounded element of C.
+    template <std::size_t Nbits, std::size_t ES, typename MatrixA, typename MatrixB, typename Store>
+    void fused_gemm_tiles(const MatrixA& A, const MatrixB& B, Store store, std::size_t M, std::size_t N, std::size_t K,
+                          unsigned nrOfThreads, const gemm_blocking& blk)
+    {
+        using workspace = gemm_tile_workspace<Nbits, ES>;
+
+        if (blk.mc == 0 || blk.nc == 0 || blk.kc == 0)
+            throw std::invalid_argument("fused_gemm: blocking sizes must be positive");
+        if (M == 0 || N == 0)
+            return;
+
+        if (nrOfThreads == 0)
+            nrOfThreads = std::max(1u, std::thread::hardware_concurrency());
+        const std::size_t tile_rows = (M + blk.mc - 1) / blk.mc, tile_cols = (N + blk.nc - 1) / blk.nc;
+        const std::size_t nrOfTiles = tile_rows * tile_cols;
+        nrOfThreads = unsigned(std::min<std::size_t>(nrOfThreads, nrOfTiles));
+
+        std::vector<std::unique_ptr<workspace> > workspaces(nrOfThreads);
+        work_stealing_for(nrOfTiles, 1, nrOfThreads, [&](unsigned worker, std::size_t first, std::size_t last) {
+            if (!workspaces[worker])
+                workspaces[worker].reset(new workspace(blk));
+            workspace& ws = *workspaces[worker];
+
+            for (std::size_t tile = first; tile < last; ++tile) {
+                const std::size_t i0 = (tile / tile_cols) * blk.mc, j0 = (tile % tile_cols) * blk.nc;
+                const std::size_t m = std::min(blk.mc, M - i0), n = std::min(blk.nc, N - j0);
+                for (auto& q : ws.quires)
+                    q.clear();
+                std::fill(ws.nar_row.begin(), ws.nar_row.end(), 0);
+                std::fill(ws.nar_col.begin(), ws.nar_col.end(), 0);
+
+                for (std::size_t p0 = 0; p0 < K; p0 += blk.kc) {
+                    const std::size_t k = std::min(blk.kc, K - p0);
+                    pack_a<Nbits, ES>(A, i0, m, p0, k, ws);
+                    pack_b<Nbits, ES>(B, p0, k, j0, n, ws);
+                    for (std::size_t jr = 0; jr < n; jr += gemm_nr)
+                        for (std::size_t ir = 0; ir < m; ir += gemm_mr)
+                            gemm_micro_kernel<Nbits, ES>(k, &ws.packed_a[ir * k], &ws.packed_b[jr * k],
+                                                         &ws.quires[ir * ws.ncp + jr], ws.ncp);
+                }
+
+                sw::unum::posit<Nbits, ES> c;
+                for (std::size_t i = 0; i < m; ++i) {
+                    for (std::size_t j = 0; j < n; ++j) {
+                        if (ws.nar_row[i] || ws.nar_col[j])
+                            c.setToNaR();
+                        else
+                            convert(ws.quires[i * ws.ncp + j].to_value(), c);
+                        if (event_counters_enabled)
+                            record_quire_result(c, ws.quires[i * ws.ncp + j], K, kernel_quire_capacity, ws.nar_row[i] || ws.nar_col[j]);
+                        store(i0 + i, j0 + j, c);
+                    }
+                }
+            }
+        });
+    }
+
+} // namespace detail
+
+/// C = A * B where every element of C is accumulated exactly in a quire and rounded once.
+//  Output tiles are distributed over nrOfThreads workers (0 selects the hardware threads);
+//  a NaR in row i of A or column j of B makes C(i, j) NaR.
+template <std::size_t Nbits, std::size_t ES>
+void fused_gemm(const mtl::dense2D<sw::unum::posit<Nbits, ES> >& A, const mtl::dense2D<sw::unum::posit<Nbits, ES> >& B,
+                mtl::dense2D<sw::unum::posit<Nbits, ES> >& C, unsigned nrOfThreads = 0, const gemm_blocking& blk = gemm_blocking())
+{
+    const std::size_t M = num_rows(A), N = num_cols(B), K = num_cols(A);
+    if (num_rows(B) != K || num_rows(C) != M || num_cols(C) != N)
+        throw std::invalid_argument("fused_gemm: matrix dimensions do not match");
+    detail::fused_gemm_tiles<Nbits, ES>(A, B, [&C](std::size_t i, std::size_t j, const sw::unum::posit<Nbits, ES>& c) { C(i, j) = c; },
+                                        M, N, K, nrOfThreads, blk);
+}
+
+/// C = A * B on row-major packed encodings: A is M x K, B is K x N, and C is M x N.
+template <std::size_t Nbits, std::size_t ES>
+void fused_gemm(const posit_storage_t<Nbits>* A, const posit_storage_t<Nbits>* B, posit_storage_t<Nbits>* C,
+                std::size_t M, std::size_t N, std::size_t K, unsigned nrOfThreads = 0, const gemm_blocking& blk = gemm_blocking())
+{
+    detail::fused_gemm_tiles<Nbits, ES>(detail::raw_matrix<Nbits, ES>{ A, K }, detail::raw_matrix<Nbits, ES>{ B, N },
+        [C, N](std::size_t i, std::size_t j, const sw::unum::posit<Nbits, ES>& c) { C[i * N + j] = posit_storage_t<Nbits>(c.get().to_ullong()); },
+        M, N, K, nrOfThreads, blk);
+}
@@ -0,0 +1,283 @@
+// fused_spmv.hpp: sparse matrix-vector product on CSR and SELL-C-sigma posit matrices with one quire per row
+//
+// Copyright (C) 2017 Stillwater Supercomputing, Inc.
+//
+// This file is part of the universal numbers project, which is released under an MIT Open Source license.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+#include <numeric>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include <boost/numeric/mtl/mtl.hpp>
+#include <posit>
+
+#include "../utilities/es_select.hpp"
+#include "../utilities/nbits_select.hpp"
+#include "../utilities/dispatch_table.hpp"
+#include "../utilities/batch_convert.hpp"
+#include "../utilities/event_counters.hpp"
+#include "fused_dot.hpp"
+
+/// Split [0, n) into parts with about equal work, where offsets[i] is the work before item i
+//  (offsets has n + 1 entries, like the row starts of a CSR matrix). Returns parts + 1 boundaries.
+inline std::vector<std::size_t> balanced_partition(const std::size_t* offsets, std::size_t n, unsigned parts)
+{
+    if (parts == 0)
+        parts = 1;
+    std::vector<std::size_t> bounds(parts + 1, n);
+    bounds[0] = 0;
+    const std::size_t total = offsets[n] - offsets[0];
+    for (unsigned k = 1; k < parts; ++k) {
+        const std::size_t target = offsets[0] + total / parts * k + total % parts * k / parts;
+        std::size_t b = std::size_t(std::lower_bound(offsets, offsets + n + 1, target) - offsets);
+        bounds[k] = std::max(bounds[k - 1], std::min(b, n));
+    }
+    return bounds;
+}
+
+namespace detail {
+
+    // Run body(first, last) for every part, part 0 on the calling thread.
+    template <typename Body>
+    void run_partitions(const std::vector<std::size_t>& bounds, Body body)
+    {
+        std::vector<std::thread> threads;
+        for (std::size_t k = 1; k + 1 < bounds.size(); ++k)
+            threads.emplace_back([&body, &bounds, k]() { body(bounds[k], bounds[k + 1]); });
+        body(bounds[0], bounds[1]);
+        for (auto& t : threads)
+            t.join();
+    }
+
+    // y[r] = sum over the nonzeros of row r in [first, last), rounded once per row.
+    template <std::size_t Nbits, std::size_t ES, typename LoadValue, typename LoadX, typename StoreY>
+    void csr_spmv_rows(const std::size_t* starts, const std::size_t* indices, LoadValue value, LoadX x, StoreY y,
+                       std::size_t first, std::size_t last)
+    {
+        sw::unum::quire<Nbits, ES, kernel_quire_capacity> q;
+        for (std::size_t r = first; r < last; ++r) {
+            q.clear();
+            bool nar = false;
+            for (std::size_t k = starts[r]; k < starts[r + 1]; ++k) {
+                const sw::unum::posit<Nbits, ES> a = value(k), b = x(indices[k]);
+                nar |= a.isNaR() | b.isNaR();
+                q += sw::unum::quire_mul(a, b);
+            }
+            sw::unum::posit<Nbits, ES> result;
+            if (nar)
+                result.setToNaR();
+            else
+                convert(q.to_value(), result);
+            if (event_counters_enabled)
+                record_quire_result(result, q, starts[r + 1] - starts[r], kernel_quire_capacity, nar);
+            y(r, result);
+        }
+    }
+
+} // namespace detail
+
+/// y = A * x for a row-major compressed2D, rows distributed over nrOfThreads workers by nonzero count.
+template <std::size_t Nbits, std::size_t ES>
+void fused_spmv(const mtl::compressed2D<sw::unum::posit<Nbits, ES> >& A, const mtl::dense_vector<sw::unum::posit<Nbits, ES> >& x,
+                mtl::dense_vector<sw::unum::posit<Nbits, ES> >& y, unsigned nrOfThreads = 0)
+{
+    using posit_type = sw::unum::posit<Nbits, ES>;
+    if (num_cols(A) != size(x) || num_rows(A) != size(y))
+        throw std::invalid_argument("fused_spmv: dimensions do not match");
+    if (nrOfThreads == 0)
+        nrOfThreads = std::max(1u, std::thread::hardware_concurrency());
+
+    const std::size_t* starts = A.address_major();
+    const std::size_t* indices = A.address_minor();
+    const posit_type* values = A.address_data();
+    auto bounds = balanced_partition(starts, num_rows(A), nrOfThreads);
+    detail::run_partitions(bounds, [&](std::size_t first, std::size_t last) {
+        detail::csr_spmv_rows<Nbits, ES>(starts, indices,
+            [values](std::size_t k) -> const posit_type& { return values[k]; },
+            [&x](std::size_t c) -> const posit_type& { return x[c]; },
+            [&y](std::size_t r, const posit_type& v) { y[r] = v; },
+            first, last);
+    });
+}
+
+/// SELL-C-sigma repacking of a CSR matrix with raw-bit values.
+//  Rows are sorted by decreasing length within windows of sigma rows and grouped in chunks of C rows;
+//  each chunk is padded to its longest row and stored column-major, so the C rows of a chunk advance in lock step.
+template <std::size_t Nbits, std::size_t ES>
+struct sell_matrix
+{
+    using raw_type = posit_storage_t<Nbits>;
+
+    sell_matrix(const std::size_t* starts, const std::size_t* indices, const raw_type* raw_values,
+                std::size_t nrOfRows, std::size_t nrOfCols, std::size_t C = 8, std::size_t sigma = 256)
+        : rows(nrOfRows), cols(nrOfCols), chunk_height(C == 0 ? 1 : C)
+    {
+        if (sigma < chunk_height)
+            sigma = chunk_height;
+        permutation.resize(rows);
+        std::iota(permutation.begin(), permutation.end(), std::size_t(0));
+        auto length = [starts](std::size_t r) { return starts[r + 1] - starts[r]; };
+        for (std::size_t w = 0; w < rows; w += sigma) {
+            std::stable_sort(permutation.begin() + w, permutation.begin() + std::min(rows, w + sigma),
+                             [&length](std::size_t a, std::size_t b) { return length(a) > length(b); });
+        }
+
+        const std::size_t nrOfChunks = (rows + chunk_height - 1) / chunk_height;
+        chunk_starts.assign(nrOfChunks + 1, 0);
+        chunk_widths.assign(nrOfChunks, 0);
+        for (std::size_t c = 0; c < nrOfChunks; ++c) {
+            for (std::size_t i = c * chunk_height; i < std::min(rows, (c + 1) * chunk_height); ++i)
+                chunk_widths[c] = std::max(chunk_widths[c], length(permutation[i]));
+            chunk_starts[c + 1] = chunk_starts[c] + chunk_widths[c] * chunk_height;
+        }
+
+        // padding holds zero at column 0 and is skipped by the kernel, as x[0] may be NaR
+        lengths.assign(rows, 0);
+        for (std::size_t i = 0; i < rows; ++i)
+            lengths[i] = length(permutation[i]);
+        values.assign(chunk_starts[nrOfChunks], raw_type(0));
+        columns.assign(chunk_starts[nrOfChunks], std::size_t(0));
+        for (std::size_t c = 0; c < nrOfChunks; ++c) {
+            for (std::size_t i = 0; i < chunk_height && c * chunk_height + i < rows; ++i) {
+                const std::size_t r = permutation[c * chunk_height + i];
+                for (std::size_t j = 0; j < length(r); ++j) {
+                    values[chunk_starts[c] + j * chunk_height + i] = raw_values[starts[r] + j];
+                    columns[chunk_starts[c] + j * chunk_height + i] = indices[starts[r] + j];
+                }
+            }
+        }
+    }
+
+    /// Repack a row-major compressed2D.
+    explicit sell_matrix(const mtl::compressed2D<sw::unum::posit<Nbits, ES> >& A, std::size_t C = 8, std::size_t sigma = 256)
+        : sell_matrix(A.address_major(), A.address_minor(), raw_values_of(A).data(), num_rows(A), num_cols(A), C, sigma) {}
+
+    /// Stored entries including padding over the nonzeros of the CSR matrix.
+    double fill_ratio(std::size_t nnz) const { return nnz ? double(values.size()) / nnz : 1.0; }
+
+    std::size_t rows, cols, chunk_height;
+    std::vector<std::size_t> permutation;       // chunk order position -> original row
+    std::vector<std::size_t> chunk_starts;      // offset of every chunk, and the total size at the end
+    std::vector<std::size_t> chunk_widths;
+    std::vector<std::size_t> lengths;           // row lengths in chunk order, to tell nonzeros from padding
+    std::vector<raw_type> values;
+    std::vector<std::size_t> columns;
+
+  private:
+    static std::vector<raw_type> raw_values_of(const mtl::compressed2D<sw::unum::posit<Nbits, ES> >& A)
+    {
+        std::vector<raw_type> raw(A.nnz());
+        for (std::size_t k = 0; k < raw.size(); ++k)
+            raw[k] = raw_type(A.address_data()[k].get().to_ullong());
+        return raw;
+    }
+};
+
+/// y = A * x on a SELL-C-sigma matrix, chunks distributed over nrOfThreads workers by stored entries.
+template <std::size_t Nbits, std::size_t ES>
+void fused_spmv(const sell_matrix<Nbits, ES>& A, const mtl::dense_vector<sw::unum::posit<Nbits, ES> >& x,
+                mtl::dense_vector<sw::unum::posit<Nbits, ES> >& y, unsigned nrOfThreads = 0)
+{
+    using posit_type = sw::unum::posit<Nbits, ES>;
+    using quire_type = sw::unum::quire<Nbits, ES, kernel_quire_capacity>;
+    if (A.cols != size(x) || A.rows != size(y))
+        throw std::invalid_argument("fused_spmv: dimensions do not match");
+    if (nrOfThreads == 0)
+        nrOfThreads = std::max(1u, std::thread::hardware_concurrency());
+
+    const std::size_t C = A.chunk_height;
+    auto bounds = balanced_partition(A.chunk_starts.data(), A.chunk_widths.size(), nrOfThreads);
+    detail::run_partitions(bounds, [&](std::size_t first, std::size_t last) {
+        std::vector<quire_type> q(C);
+        std::vector<char> nar(C);
+        posit_type a;
+        for (std::size_t c = first; c < last; ++c) {
+            for (std::size_t i = 0; i < C; ++i) {
+                q[i].clear();
+                nar[i] = 0;
+            }
+            const std::size_t base = A.chunk_starts[c];
+            for (std::size_t j = 0; j < A.chunk_widths[c]; ++j) {
+                for (std::size_t i = 0; i < C; ++i) {
+                    if (c * C + i >= A.rows || j >= A.lengths[c * C + i])
+                        continue;       // padding
+                    a.set_raw_bits(A.values[base + j * C + i]);
+                    const posit_type& b = x[A.columns[base + j * C + i]];
+                    nar[i] |= a.isNaR() | b.isNaR();
+                    q[i] += sw::unum::quire_mul(a, b);
+                }
+            }
+            for (std::size_t i = 0; i < C && c * C + i < A.rows; ++i) {
+                posit_type& result = y[A.permutation[c * C + i]];
+                if (nar[i])
+                    result.setToNaR();
+                else
+                    convert(q[i].to_value(), result);
+                if (event_counters_enabled)
+                    record_quire_result(result, q[i], A.lengths[c * C + i], kernel_quire_capacity, nar[i] != 0);
+            }
+        }
+    });
+}
+
+/// Storage layouts of the run-time SpMV entry point.
+enum class spmv_layout { csr, sell_c_sigma };
+
+struct fused_spmv_visitor
+{
+    template <std::size_t Nbits, std::size_t ES>
+    void operator()() const
+    {
+        using raw_type = posit_storage_t<Nbits>;
+        using posit_type = sw::unum::posit<Nbits, ES>;
+        const raw_type* raw_x = static_cast<const raw_type*>(x_);
+        raw_type* raw_y = static_cast<raw_type*>(y_);
+
+        // decode x once; the gathers touch its entries many times
+        mtl::dense_vector<posit_type> x(cols_), y(rows_);
+        for (std::size_t c = 0; c < cols_; ++c)
+            x[c].set_raw_bits(raw_x[c]);
+
+        if (layout_ == spmv_layout::sell_c_sigma) {
+            fused_spmv(sell_matrix<Nbits, ES>(starts_, indices_, static_cast<const raw_type*>(values_), rows_, cols_), x, y, nrOfThreads_);
+        }
+        else {
+            const raw_type* values = static_cast<const raw_type*>(values_);
+            auto bounds = balanced_partition(starts_, rows_, nrOfThreads_ == 0 ? std::max(1u, std::thread::hardware_concurrency()) : nrOfThreads_);
+            detail::run_partitions(bounds, [&](std::size_t first, std::size_t last) {
+                detail::csr_spmv_rows<Nbits, ES>(starts_, indices_,
+                    [values](std::size_t k) { posit_type p; p.set_raw_bits(values[k]); return p; },
+                    [&x](std::size_t c) -> const posit_type& { return x[c]; },
+                    [&y](std::size_t r, const posit_type& v) { y[r] = v; },
+                    first, last);
+            });
+        }
+        for (std::size_t r = 0; r < rows_; ++r)
+            raw_y[r] = raw_type(y[r].get().to_ullong());
+    }
+
+    const std::size_t* starts_;
+    const std::size_t* indices_;
+    const void* values_;
+    std::size_t rows_, cols_;
+    const void* x_;
+    void* y_;
+    unsigned nrOfThreads_;
+    spmv_layout layout_;
+};
+
+/// y = A * x on a CSR matrix with packed values of the selected format, with a single dispatch.
+//  starts has rows + 1 entries; values, x and y hold posit_storage_bytes(nbits) bytes per element.
+inline dispatch_status fused_spmv(const std::size_t* starts, const std::size_t* indices, const void* values,
+                                  std::size_t rows, std::size_t cols, const void* x, void* y,
+                                  const nbits_variant& nbitsv, const es_variant& esv,
+                                  unsigned nrOfThreads = 0, spmv_layout layout = spmv_layout::csr)
+{
+    return table_dispatch(fused_spmv_visitor{ starts, indices, values, rows, cols, x, y, nrOfThreads, layout }, nbitsv, esv);
+}
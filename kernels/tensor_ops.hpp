@@ -0,0 +1,144 @@
+// tensor_ops.hpp: element-wise arithmetic and fused dot product on packed posit tensors, one dispatch per operation
+//
+// Copyright (C) 2017 Stillwater Supercomputing, Inc.
+//
+// This file is part of the universal numbers project, which is released under an MIT Open Source license.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <array>
+#include <stdexcept>
+
+#include <posit>
+
+#include "../utilities/batch_ops.hpp"
+#include "../utilities/dispatch_table.hpp"
+#include "../utilities/posit_tensor.hpp"
+#include "../utilities/event_counters.hpp"
+#include "fused_dot.hpp"
+
+/// Element-wise operations of tensor_binary_op.
+using tensor_op = binary_op;
+
+namespace detail {
+
+    inline void require_same_format(const posit_tensor_view& a, const posit_tensor_view& b)
+    {
+        if (a.tensor().nbits() != b.tensor().nbits() || a.tensor().es() != b.tensor().es())
+            throw std::invalid_argument("posit tensor operands differ in format");
+    }
+
+    struct tensor_binary_kernel
+    {
+        // elements are gathered into plain arrays and computed one batch per block
+        static constexpr std::size_t block = 256;
+
+        template <std::size_t Nbits, std::size_t ES>
+        void operator()() const
+        {
+            using raw_type = posit_storage_t<Nbits>;
+            posit_engine<Nbits, ES> engine;
+            const std::uint64_t* wa = a_.tensor().words();
+            const std::uint64_t* wb = b_.tensor().words();
+            std::uint64_t* wc = c_.tensor().words();
+            raw_type x[block], y[block], z[block];
+            std::size_t target[block];
+            std::size_t m = 0;
+            // every element of the block is read before any is written, so c may alias a or b element for element
+            auto flush = [&]() {
+                batch_apply(engine, op_, x, y, z, m);
+                for (std::size_t k = 0; k < m; ++k)
+                    packed_set<Nbits>(wc, target[k], z[k]);
+                if (event_counters_enabled)
+                    record<Nbits, ES>(x, y, z, m);
+                m = 0;
+            };
+            for_each_element<3>({ &a_, &b_, &c_ }, [&](const std::size_t* e) {
+                x[m] = packed_get<Nbits>(wa, e[0]);
+                y[m] = packed_get<Nbits>(wb, e[1]);
+                target[m] = e[2];
+                if (++m == block)
+                    flush();
+            });
+            flush();
+        }
+
+        // recompute the block in long double to classify the rounding of each element
+        template <std::size_t Nbits, std::size_t ES>
+        void record(const posit_storage_t<Nbits>* x, const posit_storage_t<Nbits>* y, const posit_storage_t<Nbits>* z, std::size_t m) const
+        {
+            long double u[block] = {}, v[block] = {}, exact[block];
+            bool nar[block];
+            sw::unum::posit<Nbits, ES> px, py, pz;
+            for (std::size_t k = 0; k < m; ++k) {
+                px.set_raw_bits(x[k]);
+                py.set_raw_bits(y[k]);
+                u[k] = (long double)px;
+                v[k] = (long double)py;
+                nar[k] = px.isNaR() || py.isNaR();
+            }
+            batch_reference(op_, u, v, exact, m);
+            for (std::size_t k = 0; k < m; ++k) {
+                pz.set_raw_bits(z[k]);
+                record_rounding(pz, exact[k], nar[k]);
+            }
+        }
+
+        tensor_op op_;
+        const posit_tensor_view& a_;
+        const posit_tensor_view& b_;
+        const posit_tensor_view& c_;
+    };
+
+    struct tensor_dot_kernel
+    {
+        template <std::size_t Nbits, std::size_t ES>
+        void operator()() const
+        {
+            using posit_type = sw::unum::posit<Nbits, ES>;
+            sw::unum::quire<Nbits, ES, kernel_quire_capacity> q;
+            const std::uint64_t* wa = a_.tensor().words();
+            const std::uint64_t* wb = b_.tensor().words();
+            posit_type x, y;
+            bool nar = false;
+            std::uint64_t terms = 0;
+            for_each_element<2>({ &a_, &b_ }, [&](const std::size_t* e) {
+                x.set_raw_bits(packed_get<Nbits>(wa, e[0]));
+                y.set_raw_bits(packed_get<Nbits>(wb, e[1]));
+                nar |= x.isNaR() | y.isNaR();
+                q += sw::unum::quire_mul(x, y);
+                ++terms;
+            });
+            posit_type result;
+            if (nar)
+                result.setToNaR();
+            else
+                convert(q.to_value(), result);
+            if (event_counters_enabled)
+                record_quire_result(result, q, terms, kernel_quire_capacity, nar);
+            result_ = result.get().to_ullong();
+        }
+
+        const posit_tensor_view& a_;
+        const posit_tensor_view& b_;
+        std::uint64_t& result_;
+    };
+
+} // namespace detail
+
+/// c = a op b element-wise; all three views share shape and format, c may alias a or b element for element.
+inline dispatch_status tensor_binary_op(tensor_op op, const posit_tensor_view& a, const posit_tensor_view& b, const posit_tensor_view& c)
+{
+    detail::require_same_format(a, b);
+    detail::require_same_format(a, c);
+    return table_dispatch(detail::tensor_binary_kernel{ op, a, b, c }, a.tensor().nbits_v(), a.tensor().es_v());
+}
+
+/// Sum of the element-wise products of a and b accumulated in a quire; result receives the encoding.
+inline dispatch_status tensor_dot(const posit_tensor_view& a, const posit_tensor_view& b, std::uint64_t& result)
+{
+    detail::require_same_format(a, b);
+    return table_dispatch(detail::tensor_dot_kernel{ a, b, result }, a.tensor().nbits_v(), a.tensor().es_v());
+}
@@ -0,0 +1,153 @@
+// ef_kernels.cpp: the core kernels instantiated once for every supported posit format behind the C interface
+//
+// Copyright (C) 2017 Stillwater Supercomputing, Inc.
+//
+// This file is part of the universal numbers project, which is released under an MIT Open Source license.
+
+#include <cstddef>
+#include <cstdint>
+#include <array>
+#include <type_traits>
+
+#include <posit>
+
+#include "../utilities/dispatch_table.hpp"
+#include "../utilities/batch_convert.hpp"
+#include "../utilities/batch_ops.hpp"
+#include "../utilities/simd_convert.hpp"
+#include "../kernels/fused_dot.hpp"
+#include "../kernels/fused_gemm.hpp"
+#include "ef_kernels.h"
+
+namespace {
+
+    // Exceptions must not cross the C interface.
+    template <typename Function>
+    int guarded(Function f) noexcept
+    {
+        try {
+            f();
+            return EF_KERNELS_OK;
+        }
+        catch (...) {
+            return EF_KERNELS_ERROR;
+        }
+    }
+
+    template <std::size_t Nbits, std::size_t ES>
+    struct kernels
+    {
+        using raw_type = posit_storage_t<Nbits>;
+
+        // the vector codec covers formats up to 32 bits, posit<64,3> converts through the library
+        static void encode_n(const double* in, std::size_t n, raw_type* out, std::true_type) { simd_encode<Nbits, ES>(in, n, out); }
+        static void encode_n(const double* in, std::size_t n, raw_type* out, std::false_type) { convert_to_posit<Nbits, ES>(in, n, out); }
+        static void decode_n(const raw_type* in, std::size_t n, double* out, std::true_type) { simd_decode<Nbits, ES>(in, n, out); }
+        static void decode_n(const raw_type* in, std::size_t n, double* out, std::false_type) { convert_from_posit<Nbits, ES>(in, n, out); }
+
+        static int encode(const double* in, std::size_t n, void* out)
+        {
+            return guarded([=]() { encode_n(in, n, static_cast<raw_type*>(out), std::integral_constant<bool, (Nbits <= 32)>()); });
+        }
+
+        static int decode(const void* in, std::size_t n, double* out)
+        {
+            return guarded([=]() { decode_n(static_cast<const raw_type*>(in), n, out, std::integral_constant<bool, (Nbits <= 32)>()); });
+        }
+
+        static int elementwise(const void* a, const void* b, std::size_t n, void* c, binary_op op)
+        {
+            return guarded([=]() {
+                batch_apply<Nbits, ES>(op, static_cast<const raw_type*>(a), static_cast<const raw_type*>(b), static_cast<raw_type*>(c), n);
+            });
+        }
+
+        static int add(const void* a, const void* b, std::size_t n, void* c) { return elementwise(a, b, n, c, binary_op::add); }
+        static int sub(const void* a, const void* b, std::size_t n, void* c) { return elementwise(a, b, n, c, binary_op::sub); }
+        static int mul(const void* a, const void* b, std::size_t n, void* c) { return elementwise(a, b, n, c, binary_op::mul); }
+        static int div(const void* a, const void* b, std::size_t n, void* c) { return elementwise(a, b, n, c, binary_op::div); }
+
+        static int dot(const void* x, const void* y, std::size_t n, void* result)
+        {
+            return guarded([=]() {
+                auto r = fused_dot<Nbits, ES>(static_cast<const raw_type*>(x), static_cast<const raw_type*>(y), n);
+                *static_cast<raw_type*>(result) = raw_type(r.get().to_ullong());
+            });
+        }
+
+        static int gemm(const void* A, const void* B, void* C, std::size_t m, std::size_t n, std::size_t k, unsigned threads)
+        {
+            return guarded([=]() {
+                fused_gemm<Nbits, ES>(static_cast<const raw_type*>(A), static_cast<const raw_type*>(B), static_cast<raw_type*>(C), m, n, k, threads);
+            });
+        }
+
+        static ef_kernels table()
+        {
+            return ef_kernels{ EF_KERNELS_ABI_VERSION, std::uint32_t(Nbits), std::uint32_t(ES), std::uint32_t(sizeof(raw_type)),
+                               &encode, &decode, &add, &sub, &mul, &div, &dot, &gemm };
+        }
+    };
+
+    // one slot per (nbits, es) of the dispatch range, then posit<32,2> and posit<64,3>
+    constexpr std::size_t dispatch_slots = dispatch_nbits_count * dispatch_es_count;
+    constexpr std::size_t slot_32_2 = dispatch_slots;
+    constexpr std::size_t slot_64_3 = dispatch_slots + 1;
+
+    struct library
+    {
+        std::array<ef_kernels, dispatch_slots + 2> entries;
+        std::array<bool, dispatch_slots + 2> present;
+        std::size_t count;
+
+        struct filler
+        {
+            template <std::size_t Nbits, std::size_t ES>
+            void operator()() const { entry = kernels<Nbits, ES>::table(); }
+
+            ef_kernels& entry;
+        };
+
+        library() : entries(), present(), count(0)
+        {
+            for (std::size_t nbits = dispatch_min_nbits; nbits <= dispatch_max_nbits; ++nbits) {
+                for (std::size_t es = 0; es <= dispatch_max_es; ++es) {
+                    const std::size_t slot = (nbits - dispatch_min_nbits) * dispatch_es_count + es;
+                    present[slot] = table_dispatch(filler{ entries[slot] }, nbits, es) == dispatch_status::ok;
+                    count += present[slot];
+                }
+            }
+            entries[slot_32_2] = kernels<32, 2>::table();
+            entries[slot_64_3] = kernels<64, 3>::table();
+            present[slot_32_2] = present[slot_64_3] = true;
+            count += 2;
+        }
+
+        static const library& instance()
+        {
+            static const library lib;
+            return lib;
+        }
+    };
+
+} // namespace
+
+extern "C" const ef_kernels* ef_kernels_lookup(unsigned nbits, unsigned es)
+{
+    const library& lib = library::instance();
+    std::size_t slot;
+    if (nbits >= dispatch_min_nbits && nbits <= dispatch_max_nbits && es <= dispatch_max_es)
+        slot = (nbits - dispatch_min_nbits) * dispatch_es_count + es;
+    else if (nbits == 32 && es == 2)
+        slot = slot_32_2;
+    else if (nbits == 64 && es == 3)
+        slot = slot_64_3;
+    else
+        return nullptr;
+    return lib.present[slot] ? &lib.entries[slot] : nullptr;
+}
+
+extern "C" std::size_t ef_kernels_count(void)
+{
+    return library::instance().count;
+}
@@ -0,0 +1,65 @@
+/* ef_kernels.h: C interface of the prebuilt posit kernel library
+ *
+ * Copyright (C) 2017 Stillwater Supercomputing, Inc.
+ *
+ * This file is part of the universal numbers project, which is released under an MIT Open Source license.
+ */
+
+#ifndef EF_KERNELS_H
+#define EF_KERNELS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Bumped whenever ef_kernels changes layout; new members are only ever appended. */
+#define EF_KERNELS_ABI_VERSION 1
+
+/* Return codes of the kernels. */
+#define EF_KERNELS_OK     0
+#define EF_KERNELS_ERROR -1     /* an exception inside the kernel, e.g. out of memory */
+
+/* Kernels of one posit<nbits, es> format.
+ * Buffers are packed encodings of elem_bytes each (1, 2, 4, or 8 bytes, the smallest native
+ * unsigned integer that holds nbits), matrices are row-major.
+ */
+typedef struct ef_kernels {
+    uint32_t abi_version;
+    uint32_t nbits;
+    uint32_t es;
+    uint32_t elem_bytes;
+
+    /* out[i] = posit(in[i]), rounded to nearest */
+    int (*encode)(const double* in, size_t n, void* out);
+    /* out[i] = double(in[i]), NaR decodes to NaN */
+    int (*decode)(const void* in, size_t n, double* out);
+
+    /* c[i] = a[i] op b[i], c may alias a or b */
+    int (*add)(const void* a, const void* b, size_t n, void* c);
+    int (*sub)(const void* a, const void* b, size_t n, void* c);
+    int (*mul)(const void* a, const void* b, size_t n, void* c);
+    int (*div)(const void* a, const void* b, size_t n, void* c);
+
+    /* *result = sum of x[i] * y[i], accumulated in a quire and rounded once */
+    int (*dot)(const void* x, const void* y, size_t n, void* result);
+    /* C = A * B with A m x k, B k x n, C m x n; threads 0 selects the hardware threads */
+    int (*gemm)(const void* A, const void* B, void* C, size_t m, size_t n, size_t k, unsigned threads);
+} ef_kernels;
+
+/* Kernels of posit<nbits, es>, or NULL if the library has none.
+ * Covered are all valid formats with 3 <= nbits <= 22 and es <= 5, plus posit<32,2> and posit<64,3>.
+ * The returned table is immutable and lives as long as the program.
+ */
+const ef_kernels* ef_kernels_lookup(unsigned nbits, unsigned es);
+
+/* Number of formats the library was built with. */
+size_t ef_kernels_count(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* EF_KERNELS_H */
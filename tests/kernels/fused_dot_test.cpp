@@ -0,0 +1,92 @@
+// fused_dot_test.cpp: Test the quire-accumulated dot product
+//
+// Copyright (C) 2017 Stillwater Supercomputing, Inc.
+//
+// This file is part of the universal numbers project, which is released under an MIT Open Source license.
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <boost/numeric/mtl/mtl.hpp>
+#include <posit>
+
+#include "../../kernels/fused_dot.hpp"
+
+using namespace std;
+
+template <size_t Nbits, size_t ES>
+int VerifyFusedDot()
+{
+    using posit_type = sw::unum::posit<Nbits, ES>;
+    int nrOfFailedTestCases = 0;
+    string tag = "posit<" + to_string(Nbits) + "," + to_string(ES) + "> ";
+
+    // big + 1 - big cancels exactly in the quire but loses the 1 in posit accumulation
+    long double magnitude = std::min(sw::unum::maxpos_value<Nbits, ES>() / 4, std::ldexp(1.0L, 40));
+    posit_type big = magnitude, one = 1;
+    mtl::dense_vector<posit_type> x(3), y(3, one);
+    x[0] = big; x[1] = one; x[2] = -big;
+    if (fused_dot(x, y) != one) {
+        cerr << "FAIL: " << tag << "catastrophic cancellation not exact: " << fused_dot(x, y) << '\n';
+        ++nrOfFailedTestCases;
+    }
+
+    // lengths around the unrolling, against a single rounding of the exact sum of small integers
+    for (size_t n = 0; n < 3 * dot_unroll; ++n) {
+        mtl::dense_vector<posit_type> a(n), b(n);
+        int exact = 0;
+        for (size_t i = 0; i < n; ++i) {
+            a[i] = int(i % 3) - 1;
+            b[i] = int(i % 2) + 1;
+            exact += (int(i % 3) - 1) * (int(i % 2) + 1);
+        }
+        if (fused_dot(a, b) != posit_type(exact)) {
+            cerr << "FAIL: " << tag << "length " << n << " gives " << fused_dot(a, b) << " instead of " << exact << '\n';
+            ++nrOfFailedTestCases;
+        }
+    }
+
+    // NaR anywhere poisons the result, also in the remainder loop
+    for (size_t pos : { size_t(0), size_t(dot_unroll) }) {
+        mtl::dense_vector<posit_type> a(dot_unroll + 1, one), b(dot_unroll + 1, one);
+        b[pos].setToNaR();
+        if (!fused_dot(a, b).isNaR()) {
+            cerr << "FAIL: " << tag << "NaR at " << pos << " not propagated\n";
+            ++nrOfFailedTestCases;
+        }
+    }
+
+    // the run-time entry point agrees with the typed kernel
+    vector<posit_storage_t<Nbits> > ra(3), rb(3);
+    for (size_t i = 0; i < 3; ++i) {
+        ra[i] = posit_storage_t<Nbits>(x[i].get().to_ullong());
+        rb[i] = posit_storage_t<Nbits>(y[i].get().to_ullong());
+    }
+    posit_storage_t<Nbits> raw = 0;
+    dispatch_status status = fused_dot(ra.data(), rb.data(), 3, &raw, nbits_select(Nbits), es_select(ES));
+    if (status != dispatch_status::ok || raw != posit_storage_t<Nbits>(one.get().to_ullong())) {
+        cerr << "FAIL: " << tag << "run-time entry point: " << to_string(status) << '\n';
+        ++nrOfFailedTestCases;
+    }
+
+    return nrOfFailedTestCases;
+}
+
+int main()
+try {
+    cout << "This is the fused dot product test.\n";
+
+    int nrOfFailedTestCases = 0;
+    nrOfFailedTestCases += VerifyFusedDot<8, 0>();
+    nrOfFailedTestCases += VerifyFusedDot<16, 1>();
+    nrOfFailedTestCases += VerifyFusedDot<22, 2>();
+
+	return (nrOfFailedTestCases > 0 ? EXIT_FAILURE : EXIT_SUCCESS);
+}
+catch (char* msg) {
+	cerr << msg << endl;
+	return EXIT_FAILURE;
+}
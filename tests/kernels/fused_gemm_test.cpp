@@ -0,0 +1,80 @@
+// fused_gemm_test.cpp: Test the blocked quire GEMM against element-wise fused dot products
+//
+// Copyright (C) 2017 Stillwater Supercomputing, Inc.
+//
+// This file is part of the universal numbers project, which is released under an MIT Open Source license.
+
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <string>
+
+#include <boost/numeric/mtl/mtl.hpp>
+#include <posit>
+
+#include "../../kernels/fused_dot.hpp"
+#include "../../kernels/fused_gemm.hpp"
+
+using namespace std;
+
+template <size_t Nbits, size_t ES>
+int VerifyFusedGemm(size_t M, size_t N, size_t K, unsigned nrOfThreads, const gemm_blocking& blk, bool bNaR = false)
+{
+    using posit_type = sw::unum::posit<Nbits, ES>;
+    mt19937_64 eng(M * 1000 + N * 100 + K);
+    uniform_real_distribution<double> magnitude(-6.0, 6.0);
+    mtl::dense2D<posit_type> A(M, K), B(K, N), C(M, N);
+    for (size_t i = 0; i < M; ++i)
+        for (size_t p = 0; p < K; ++p)
+            A(i, p) = (eng() & 1 ? -1.0 : 1.0) * exp2(magnitude(eng));
+    for (size_t p = 0; p < K; ++p)
+        for (size_t j = 0; j < N; ++j)
+            B(p, j) = (eng() & 1 ? -1.0 : 1.0) * exp2(magnitude(eng));
+    if (bNaR) {
+        A(M - 1, K / 2).setToNaR();
+        B(0, 0).setToNaR();
+    }
+
+    fused_gemm(A, B, C, nrOfThreads, blk);
+
+    int nrOfFailedTestCases = 0;
+    mtl::dense_vector<posit_type> row(K), col(K);
+    for (size_t i = 0; i < M; ++i) {
+        for (size_t j = 0; j < N; ++j) {
+            for (size_t p = 0; p < K; ++p) {
+                row[p] = A(i, p);
+                col[p] = B(p, j);
+            }
+            posit_type expected = fused_dot(row, col);
+            if (C(i, j) != expected) {
+                if (nrOfFailedTestCases < 5)
+                    cerr << "FAIL: posit<" << Nbits << "," << ES << "> " << M << "x" << N << "x" << K
+                         << " C(" << i << "," << j << ") = " << C(i, j) << " instead of " << expected << '\n';
+                ++nrOfFailedTestCases;
+            }
+        }
+    }
+    return nrOfFailedTestCases;
+}
+
+int main()
+try {
+    cout << "This is the fused GEMM test.\n";
+
+    gemm_blocking small;            // ragged tiles in every dimension
+    small.mc = 6; small.nc = 5; small.kc = 4;
+
+    int nrOfFailedTestCases = 0;
+    nrOfFailedTestCases += VerifyFusedGemm<16, 1>(7, 9, 13, 1, small);
+    nrOfFailedTestCases += VerifyFusedGemm<16, 1>(7, 9, 13, 3, small);
+    nrOfFailedTestCases += VerifyFusedGemm<16, 1>(33, 17, 40, 2, gemm_blocking());
+    nrOfFailedTestCases += VerifyFusedGemm<8, 0>(5, 4, 1, 2, small);
+    nrOfFailedTestCases += VerifyFusedGemm<32, 2>(12, 8, 20, 2, small, true);
+    nrOfFailedTestCases += VerifyFusedGemm<16, 1>(3, 3, 0, 1, small);
+
+	return (nrOfFailedTestCases > 0 ? EXIT_FAILURE : EXIT_SUCCESS);
+}
+catch (char* msg) {
+	cerr << msg << endl;
+	return EXIT_FAILURE;
+}
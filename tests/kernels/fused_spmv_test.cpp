@@ -0,0 +1,130 @@
+// fused_spmv_test.cpp: Test the quire SpMV on CSR and SELL-C-sigma against row-wise fused dot products
+//
+// Copyright (C) 2017 Stillwater Supercomputing, Inc.
+//
+// This file is part of the universal numbers project, which is released under an MIT Open Source license.
+
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <boost/numeric/mtl/mtl.hpp>
+#include <posit>
+
+#include "../../kernels/fused_dot.hpp"
+#include "../../kernels/fused_spmv.hpp"
+
+using namespace std;
+
+template <size_t Nbits, size_t ES>
+int VerifyFusedSpmv(size_t rows, size_t cols, unsigned nrOfThreads, bool bNaR)
+{
+    using posit_type = sw::unum::posit<Nbits, ES>;
+    using raw_type = posit_storage_t<Nbits>;
+    int nrOfFailedTestCases = 0;
+    string tag = "posit<" + to_string(Nbits) + "," + to_string(ES) + "> " + to_string(rows) + "x" + to_string(cols)
+               + " threads " + to_string(nrOfThreads) + ": ";
+
+    // skewed row lengths, including empty rows
+    mt19937_64 eng(rows * 31 + cols);
+    uniform_real_distribution<double> magnitude(-6.0, 6.0);
+    mtl::compressed2D<posit_type> A(rows, cols);
+    {
+        mtl::mat::inserter<mtl::compressed2D<posit_type> > ins(A, 8);
+        for (size_t r = 0; r < rows; ++r) {
+            size_t length = (r % 5 == 0) ? 0 : (r % 7 == 0 ? cols : 1 + eng() % 4);
+            for (size_t k = 0; k < length; ++k)
+                ins[r][length == cols ? k : eng() % cols] << posit_type((eng() & 1 ? -1.0 : 1.0) * exp2(magnitude(eng)));
+        }
+    }
+    mtl::dense_vector<posit_type> x(cols), y(rows), z(rows);
+    for (size_t c = 0; c < cols; ++c)
+        x[c] = exp2(magnitude(eng));
+    if (bNaR)
+        x[0].setToNaR();            // the column SELL padding reads, which must not poison other rows
+
+    // expected: the fused dot product of every row
+    vector<posit_type> expected(rows);
+    const size_t* starts = A.address_major();
+    const size_t* indices = A.address_minor();
+    for (size_t r = 0; r < rows; ++r) {
+        mtl::dense_vector<posit_type> a(starts[r + 1] - starts[r]), b(starts[r + 1] - starts[r]);
+        for (size_t k = starts[r]; k < starts[r + 1]; ++k) {
+            a[k - starts[r]] = A.address_data()[k];
+            b[k - starts[r]] = x[indices[k]];
+        }
+        expected[r] = fused_dot(a, b);
+    }
+    auto compare = [&](const char* kernel, const mtl::dense_vector<posit_type>& v) {
+        for (size_t r = 0; r < rows; ++r) {
+            if (v[r] != expected[r]) {
+                cerr << "FAIL: " << tag << kernel << " row " << r << " = " << v[r] << " instead of " << expected[r] << '\n';
+                ++nrOfFailedTestCases;
+                return;
+            }
+        }
+    };
+
+    fused_spmv(A, x, y, nrOfThreads);
+    compare("csr", y);
+    fused_spmv(sell_matrix<Nbits, ES>(A, 4, 16), x, z, nrOfThreads);
+    compare("sell", z);
+
+    // run-time entry point, both layouts
+    vector<raw_type> values(A.nnz()), rx(cols), ry(rows);
+    for (size_t k = 0; k < values.size(); ++k)
+        values[k] = raw_type(A.address_data()[k].get().to_ullong());
+    for (size_t c = 0; c < cols; ++c)
+        rx[c] = raw_type(x[c].get().to_ullong());
+    for (spmv_layout layout : { spmv_layout::csr, spmv_layout::sell_c_sigma }) {
+        dispatch_status status = fused_spmv(starts, indices, values.data(), rows, cols, rx.data(), ry.data(),
+                                            nbits_select(Nbits), es_select(ES), nrOfThreads, layout);
+        mtl::dense_vector<posit_type> w(rows);
+        for (size_t r = 0; r < rows; ++r)
+            w[r].set_raw_bits(ry[r]);
+        if (status != dispatch_status::ok) {
+            cerr << "FAIL: " << tag << "run-time entry point: " << to_string(status) << '\n';
+            ++nrOfFailedTestCases;
+        }
+        compare(layout == spmv_layout::csr ? "run-time csr" : "run-time sell", w);
+    }
+    return nrOfFailedTestCases;
+}
+
+int VerifyBalancedPartition()
+{
+    int nrOfFailedTestCases = 0;
+    // one heavy row followed by light ones
+    vector<size_t> starts = { 0, 100, 101, 102, 103, 104, 105, 106, 107 };
+    vector<size_t> bounds = balanced_partition(starts.data(), starts.size() - 1, 4);
+    vector<size_t> expected = { 0, 1, 1, 1, 8 };
+    if (bounds != expected) {
+        cerr << "FAIL: balanced_partition does not isolate the heavy row\n";
+        ++nrOfFailedTestCases;
+    }
+    bounds = balanced_partition(starts.data(), 0, 3);
+    if (bounds != vector<size_t>(4, 0)) {
+        cerr << "FAIL: balanced_partition of an empty range\n";
+        ++nrOfFailedTestCases;
+    }
+    return nrOfFailedTestCases;
+}
+
+int main()
+try {
+    cout << "This is the fused SpMV test.\n";
+
+    int nrOfFailedTestCases = VerifyBalancedPartition();
+    nrOfFailedTestCases += VerifyFusedSpmv<16, 1>(37, 23, 1, false);
+    nrOfFailedTestCases += VerifyFusedSpmv<16, 1>(37, 23, 3, false);
+    nrOfFailedTestCases += VerifyFusedSpmv<8, 0>(10, 9, 2, true);
+    nrOfFailedTestCases += VerifyFusedSpmv<20, 2>(50, 40, 4, true);
+
+	return (nrOfFailedTestCases > 0 ? EXIT_FAILURE : EXIT_SUCCESS);
+}
+catch (char* msg) {
+	cerr << msg << endl;
+	return EXIT_FAILURE;
+}
@@ -0,0 +1,127 @@
+// kernel_library_test.cpp: Test the C function tables of the prebuilt kernel library against the posit templates
+//
+// Copyright (C) 2017 Stillwater Supercomputing, Inc.
+//
+// This file is part of the universal numbers project, which is released under an MIT Open Source license.
+
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include <posit>
+
+#include "../../lib/ef_kernels.h"
+
+using namespace std;
+
+template <size_t Nbits, size_t ES, typename Raw>
+int VerifyFormat()
+{
+    using posit_type = sw::unum::posit<Nbits, ES>;
+    int nrOfFailedTestCases = 0;
+    const ef_kernels* k = ef_kernels_lookup(Nbits, ES);
+    if (k == nullptr || k->abi_version != EF_KERNELS_ABI_VERSION || k->nbits != Nbits || k->es != ES || k->elem_bytes != sizeof(Raw)) {
+        cerr << "FAIL: posit<" << Nbits << "," << ES << "> has no valid kernel table\n";
+        return 1;
+    }
+
+    const size_t n = 1000;
+    mt19937_64 eng(Nbits * 16 + ES);
+    uniform_real_distribution<double> magnitude(-8.0, 8.0);
+    vector<double> x(n), y(n), back(n);
+    for (size_t i = 0; i < n; ++i) {
+        x[i] = (eng() & 1 ? -1.0 : 1.0) * exp2(magnitude(eng));
+        y[i] = (eng() & 1 ? -1.0 : 1.0) * exp2(magnitude(eng));
+    }
+    vector<Raw> a(n), b(n), c(n);
+    nrOfFailedTestCases += k->encode(x.data(), n, a.data()) != EF_KERNELS_OK;
+    nrOfFailedTestCases += k->encode(y.data(), n, b.data()) != EF_KERNELS_OK;
+    nrOfFailedTestCases += k->decode(a.data(), n, back.data()) != EF_KERNELS_OK;
+    nrOfFailedTestCases += k->add(a.data(), b.data(), n, c.data()) != EF_KERNELS_OK;
+    posit_type pa, pb, pc;
+    for (size_t i = 0; i < n; ++i) {
+        pa = x[i];
+        pb = y[i];
+        pc.set_raw_bits(c[i]);
+        if (a[i] != Raw(pa.get().to_ullong()) || back[i] != double(pa) || pc != pa + pb) {
+            if (nrOfFailedTestCases < 5)
+                cerr << "FAIL: posit<" << Nbits << "," << ES << "> element " << i << " of " << x[i] << " + " << y[i] << '\n';
+            ++nrOfFailedTestCases;
+        }
+    }
+    nrOfFailedTestCases += k->mul(a.data(), b.data(), n, c.data()) != EF_KERNELS_OK;
+    for (size_t i = 0; i < n; ++i) {
+        pa.set_raw_bits(a[i]);
+        pb.set_raw_bits(b[i]);
+        pc.set_raw_bits(c[i]);
+        if (pc != pa * pb)
+            ++nrOfFailedTestCases;
+    }
+
+    // every element of a gemm is the dot product of a row and a column
+    const size_t M = 7, N = 5, K = 9;
+    vector<Raw> A(a.begin(), a.begin() + M * K), B(b.begin(), b.begin() + K * N), C(M * N), row(K), col(K);
+    nrOfFailedTestCases += k->gemm(A.data(), B.data(), C.data(), M, N, K, 2) != EF_KERNELS_OK;
+    for (size_t i = 0; i < M; ++i) {
+        for (size_t j = 0; j < N; ++j) {
+            for (size_t p = 0; p < K; ++p) {
+                row[p] = A[i * K + p];
+                col[p] = B[p * N + j];
+            }
+            Raw expected = 0;
+            nrOfFailedTestCases += k->dot(row.data(), col.data(), K, &expected) != EF_KERNELS_OK;
+            if (C[i * N + j] != expected) {
+                if (nrOfFailedTestCases < 5)
+                    cerr << "FAIL: posit<" << Nbits << "," << ES << "> gemm element (" << i << "," << j << ")\n";
+                ++nrOfFailedTestCases;
+            }
+        }
+    }
+    return nrOfFailedTestCases;
+}
+
+int VerifyCoverage()
+{
+    int nrOfFailedTestCases = 0;
+    size_t valid = 2;   // posit<32,2> and posit<64,3>
+    for (unsigned nbits = 3; nbits <= 22; ++nbits) {
+        for (unsigned es = 0; es <= 5; ++es) {
+            const bool expected = es + 2 <= nbits;
+            valid += expected;
+            if ((ef_kernels_lookup(nbits, es) != nullptr) != expected) {
+                cerr << "FAIL: posit<" << nbits << "," << es << "> lookup\n";
+                ++nrOfFailedTestCases;
+            }
+        }
+    }
+    if (ef_kernels_count() != valid) {
+        cerr << "FAIL: library reports " << ef_kernels_count() << " formats instead of " << valid << '\n';
+        ++nrOfFailedTestCases;
+    }
+    if (ef_kernels_lookup(23, 1) != nullptr || ef_kernels_lookup(32, 1) != nullptr || ef_kernels_lookup(8, 6) != nullptr) {
+        cerr << "FAIL: lookup of formats outside the library\n";
+        ++nrOfFailedTestCases;
+    }
+    return nrOfFailedTestCases;
+}
+
+int main()
+try {
+    cout << "This is the kernel library test.\n";
+
+    int nrOfFailedTestCases = 0;
+    nrOfFailedTestCases += VerifyCoverage();
+    nrOfFailedTestCases += VerifyFormat<8, 0, uint8_t>();
+    nrOfFailedTestCases += VerifyFormat<12, 1, uint16_t>();
+    nrOfFailedTestCases += VerifyFormat<16, 1, uint16_t>();
+    nrOfFailedTestCases += VerifyFormat<20, 2, uint32_t>();
+    nrOfFailedTestCases += VerifyFormat<32, 2, uint32_t>();
+
+	return (nrOfFailedTestCases > 0 ? EXIT_FAILURE : EXIT_SUCCESS);
+}
+catch (char* msg) {
+	cerr << msg << endl;
+	return EXIT_FAILURE;
+}
@@ -0,0 +1,98 @@
+// tensor_ops_test.cpp: Test element-wise arithmetic and the fused dot product on packed posit tensors
+//
+// Copyright (C) 2017 Stillwater Supercomputing, Inc.
+//
+// This file is part of the universal numbers project, which is released under an MIT Open Source license.
+
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <string>
+
+#include <boost/numeric/mtl/mtl.hpp>
+#include <posit>
+
+#include "../../kernels/fused_dot.hpp"
+#include "../../kernels/tensor_ops.hpp"
+
+using namespace std;
+
+template <size_t Nbits, size_t ES>
+int VerifyTensorOps()
+{
+    using posit_type = sw::unum::posit<Nbits, ES>;
+    int nrOfFailedTestCases = 0;
+    string tag = "posit<" + to_string(Nbits) + "," + to_string(ES) + "> ";
+
+    // a is 5 x 7, b the transpose of a 7 x 5 tensor: the kernels walk different strides per operand
+    const size_t R = 5, C = 7;
+    posit_tensor a(Nbits, ES, { R, C }), b(Nbits, ES, { C, R }), c(Nbits, ES, { R, C });
+    mt19937_64 eng(Nbits);
+    for (size_t i = 0; i < R * C; ++i) {
+        a.set_raw(i, eng());
+        b.set_raw(i, eng());
+    }
+    posit_tensor_view va = a.view(), vb = b.view().transpose(0, 1), vc = c.view();
+
+    const tensor_op ops[] = { tensor_op::add, tensor_op::sub, tensor_op::mul, tensor_op::div };
+    const char* names[] = { "add", "sub", "mul", "div" };
+    for (int o = 0; o < 4; ++o) {
+        tensor_binary_op(ops[o], va, vb, vc);
+        for (size_t i = 0; i < R; ++i) {
+            for (size_t j = 0; j < C; ++j) {
+                posit_type x, y, z;
+                x.set_raw_bits(a.get_raw(i * C + j));
+                y.set_raw_bits(b.get_raw(j * R + i));
+                switch (ops[o]) {
+                    case tensor_op::add: z = x + y; break;
+                    case tensor_op::sub: z = x - y; break;
+                    case tensor_op::mul: z = x * y; break;
+                    case tensor_op::div: z = x / y; break;
+                }
+                if (c.get_raw(i * C + j) != z.get().to_ullong()) {
+                    cerr << "FAIL: " << tag << names[o] << " element (" << i << "," << j << ")\n";
+                    ++nrOfFailedTestCases;
+                }
+            }
+        }
+    }
+
+    // dot of a row of a with a strided column of the transposed b
+    posit_tensor_view row = va.slice(0, 2, 3), col = vb.slice(0, 2, 3);
+    mtl::dense_vector<posit_type> x(C), y(C);
+    for (size_t j = 0; j < C; ++j) {
+        x[j].set_raw_bits(a.get_raw(2 * C + j));
+        y[j].set_raw_bits(b.get_raw(j * R + 2));
+    }
+    uint64_t raw = 0;
+    if (tensor_dot(row, col, raw) != dispatch_status::ok || raw != fused_dot(x, y).get().to_ullong()) {
+        cerr << "FAIL: " << tag << "tensor_dot disagrees with fused_dot\n";
+        ++nrOfFailedTestCases;
+    }
+
+    // mismatched shapes are rejected
+    try {
+        tensor_binary_op(tensor_op::add, va, b.view(), vc);
+        cerr << "FAIL: " << tag << "shape mismatch accepted\n";
+        ++nrOfFailedTestCases;
+    }
+    catch (const std::invalid_argument&) {}
+
+    return nrOfFailedTestCases;
+}
+
+int main()
+try {
+    cout << "This is the posit tensor operations test.\n";
+
+    int nrOfFailedTestCases = 0;
+    nrOfFailedTestCases += VerifyTensorOps<8, 0>();
+    nrOfFailedTestCases += VerifyTensorOps<12, 1>();
+    nrOfFailedTestCases += VerifyTensorOps<19, 2>();
+
+	return (nrOfFailedTestCases > 0 ? EXIT_FAILURE : EXIT_SUCCESS);
+}
+catch (char* msg) {
+	cerr << msg << endl;
+	return EXIT_FAILURE;
+}
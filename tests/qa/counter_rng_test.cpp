@@ -0,0 +1,80 @@
+// counter_rng_test.cpp: Test the counter-based generator of the random QA sweeps
+//
+// Copyright (C) 2017 Stillwater Supercomputing, Inc.
+//
+// This file is part of the universal numbers project, which is released under an MIT Open Source license.
+
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+
+#include "../../tools/qa/counter_rng.hpp"
+
+using namespace std;
+using sw::qa::philox4x32;
+
+// known-answer vectors of Philox4x32-10 from the Random123 distribution (kat_vectors)
+struct philox_kat
+{
+    philox4x32::counter_type ctr;
+    philox4x32::key_type key;
+    philox4x32::counter_type expected;
+};
+
+int VerifyKnownAnswers()
+{
+    const philox_kat kats[] = {
+        { { { 0x00000000, 0x00000000, 0x00000000, 0x00000000 } }, { { 0x00000000, 0x00000000 } },
+          { { 0x6627e8d5, 0xe169c58d, 0xbc57ac4c, 0x9b00dbd8 } } },
+        { { { 0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff } }, { { 0xffffffff, 0xffffffff } },
+          { { 0x408f276d, 0x41c83b0e, 0xa20bc7c6, 0x6d5451fd } } },
+        { { { 0x243f6a88, 0x85a308d3, 0x13198a2e, 0x03707344 } }, { { 0xa4093822, 0x299f31d0 } },
+          { { 0xd16cfe09, 0x94fdcceb, 0x5001e420, 0x24126ea1 } } },
+    };
+    int nrOfFailedTestCases = 0;
+    for (const philox_kat& kat : kats) {
+        philox4x32::counter_type result = philox4x32::generate(kat.ctr, kat.key);
+        if (result != kat.expected) {
+            cerr << "FAIL: philox4x32-10 of counter " << hex << kat.ctr[0] << " key " << kat.key[0] << " gives";
+            for (uint32_t word : result)
+                cerr << ' ' << setw(8) << setfill('0') << word;
+            cerr << dec << setfill(' ') << '\n';
+            ++nrOfFailedTestCases;
+        }
+    }
+    return nrOfFailedTestCases;
+}
+
+// a sample is a pure function of (seed, index, stream), whatever was drawn before
+int VerifyCounterAccess()
+{
+    int nrOfFailedTestCases = 0;
+    const sw::qa::counter_rng rng(0x0123456789abcdefull), other(0x0123456789abcdeeull);
+    const auto first = rng(1000000007, 1);
+    for (uint64_t i = 0; i < 1000; ++i)
+        rng(i);
+    if (rng(1000000007, 1) != first) {
+        cerr << "FAIL: sample depends on the samples drawn before\n";
+        ++nrOfFailedTestCases;
+    }
+    if (rng(1000000007, 2) == first || other(1000000007, 1) == first || rng(1000000008, 1) == first) {
+        cerr << "FAIL: stream, seed, or index do not select independent samples\n";
+        ++nrOfFailedTestCases;
+    }
+    return nrOfFailedTestCases;
+}
+
+int main()
+try {
+    cout << "This is the counter-based generator test.\n";
+
+    int nrOfFailedTestCases = 0;
+    nrOfFailedTestCases += VerifyKnownAnswers();
+    nrOfFailedTestCases += VerifyCounterAccess();
+
+	return (nrOfFailedTestCases > 0 ? EXIT_FAILURE : EXIT_SUCCESS);
+}
+catch (char* msg) {
+	cerr << msg << endl;
+	return EXIT_FAILURE;
+}
@@ -0,0 +1,204 @@
+// coverage_map_test.cpp: Test the rounding coverage cells and the saturation of QA sweeps
+//
+// Copyright (C) 2017 Stillwater Supercomputing, Inc.
+//
+// This file is part of the universal numbers project, which is released under an MIT Open Source license.
+
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "../../tools/qa/coverage_map.hpp"
+
+using namespace std;
+using sw::qa::CoverageMap;
+
+// regime, exponent field and value of a positive encoding, decoded bit by bit
+struct decoded_posit
+{
+    int k;
+    unsigned exponent;
+    double value;
+};
+
+decoded_posit Decode(uint64_t raw, size_t nbits, size_t es)
+{
+    int i = int(nbits) - 2;
+    const bool r0 = (raw >> i) & 1;
+    int run = 0;
+    while (i >= 0 && bool((raw >> i) & 1) == r0) {
+        ++run;
+        --i;
+    }
+    if (i >= 0) --i;    // terminating bit of the regime, absent when the run fills the word
+    decoded_posit d;
+    d.k = r0 ? run - 1 : -run;
+    d.exponent = 0;
+    size_t exponent_bits = 0;
+    for (; exponent_bits < es && i >= 0; ++exponent_bits, --i)
+        d.exponent = (d.exponent << 1) | unsigned((raw >> i) & 1);
+    const int fraction_bits = i + 1;
+    const uint64_t fraction = raw & ((uint64_t(1) << fraction_bits) - 1);
+    d.value = std::ldexp(1.0 + std::ldexp(double(fraction), -fraction_bits), d.k * (1 << es) + int(d.exponent << (es - exponent_bits)));
+    return d;
+}
+
+// the value halfway between raw and raw + 1 in posit rounding: raw extended by a 1 bit
+double Midpoint(uint64_t raw, size_t nbits, size_t es)
+{
+    return Decode((raw << 1) | 1, nbits + 1, es).value;
+}
+
+size_t ExpectedCell(uint64_t raw, size_t nbits, size_t es, unsigned outcome)
+{
+    decoded_posit d = Decode(raw, nbits, es);
+    return ((size_t(d.k + int(nbits - 2)) << es) + d.exponent) * sw::qa::NR_ROUNDING_OUTCOMES + outcome;
+}
+
+int ExpectCell(const CoverageMap& map, uint64_t preference, double reference, size_t expected, const string& what)
+{
+    size_t cell = map.Cell(preference, reference);
+    if (cell == expected)
+        return 0;
+    cerr << "FAIL: " << what << ": cell " << cell << " instead of " << expected << '\n';
+    return 1;
+}
+
+// zero, NaR, minpos, maxpos, the regime boundary at 1.0, and both signs of each
+int VerifyCells(size_t nbits, size_t es)
+{
+    int nrOfFailedTestCases = 0;
+    const CoverageMap map(nbits, es);
+    const string tag = "posit<" + to_string(nbits) + "," + to_string(es) + "> ";
+    const uint64_t mask = (uint64_t(1) << nbits) - 1, nar = uint64_t(1) << (nbits - 1), maxpos = nar - 1, one = nar >> 1;
+    auto negate = [mask](uint64_t raw) { return (0 - raw) & mask; };
+
+    nrOfFailedTestCases += ExpectCell(map, 0, 0.0, map.Cells() - 2, tag + "zero");
+    nrOfFailedTestCases += ExpectCell(map, 0, 1.0e-300, map.Cells() - 2, tag + "zero of an underflow");
+    nrOfFailedTestCases += ExpectCell(map, nar, NAN, map.Cells() - 1, tag + "NaR");
+
+    const double vmaxpos = Decode(maxpos, nbits, es).value, vminpos = Decode(1, nbits, es).value;
+    for (int sign = 1; sign >= -1; sign -= 2) {
+        auto raw = [&](uint64_t magnitude) { return sign > 0 ? magnitude : negate(magnitude); };
+        const string side = tag + (sign > 0 ? "+" : "-");
+        nrOfFailedTestCases += ExpectCell(map, raw(maxpos), sign * vmaxpos, ExpectedCell(maxpos, nbits, es, sw::qa::ROUND_EXACT), side + "maxpos exact");
+        nrOfFailedTestCases += ExpectCell(map, raw(maxpos), sign * vmaxpos * 4, ExpectedCell(maxpos, nbits, es, sw::qa::ROUND_SATURATE), side + "maxpos saturated");
+        nrOfFailedTestCases += ExpectCell(map, raw(1), sign * vminpos, ExpectedCell(1, nbits, es, sw::qa::ROUND_EXACT), side + "minpos exact");
+        nrOfFailedTestCases += ExpectCell(map, raw(1), sign * vminpos / 4, ExpectedCell(1, nbits, es, sw::qa::ROUND_SATURATE), side + "minpos saturated");
+
+        // 1.0 opens regime 0; the encoding below it is the top of regime -1
+        const double below = Decode(one - 1, nbits, es).value, above = Decode(one + 1, nbits, es).value;
+        const double mid_below = Midpoint(one - 1, nbits, es), mid_above = Midpoint(one, nbits, es);
+        nrOfFailedTestCases += ExpectCell(map, raw(one), sign * 1.0, ExpectedCell(one, nbits, es, sw::qa::ROUND_EXACT), side + "1.0 exact");
+        nrOfFailedTestCases += ExpectCell(map, raw(one), sign * (1.0 + mid_above) / 2, ExpectedCell(one, nbits, es, sw::qa::ROUND_DOWN_STICKY), side + "1.0 rounded down");
+        nrOfFailedTestCases += ExpectCell(map, raw(one), sign * mid_above, ExpectedCell(one, nbits, es, sw::qa::ROUND_DOWN_TIE), side + "1.0 tie rounded down");
+        nrOfFailedTestCases += ExpectCell(map, raw(one), sign * mid_below, ExpectedCell(one, nbits, es, sw::qa::ROUND_UP_TIE), side + "1.0 tie rounded up");
+        nrOfFailedTestCases += ExpectCell(map, raw(one), sign * (mid_below + 1.0) / 2, ExpectedCell(one, nbits, es, sw::qa::ROUND_UP_STICKY), side + "1.0 rounded up");
+        nrOfFailedTestCases += ExpectCell(map, raw(one - 1), sign * below, ExpectedCell(one - 1, nbits, es, sw::qa::ROUND_EXACT), side + "top of regime -1");
+        nrOfFailedTestCases += ExpectCell(map, raw(one + 1), sign * above, ExpectedCell(one + 1, nbits, es, sw::qa::ROUND_EXACT), side + "1.0 + ulp");
+        if (Decode(one - 1, nbits, es).k != -1 || ExpectedCell(one - 1, nbits, es, 0) == ExpectedCell(one, nbits, es, 0)) {
+            cerr << "FAIL: " << side << "1.0 and its predecessor share a regime\n";
+            ++nrOfFailedTestCases;
+        }
+    }
+    return nrOfFailedTestCases;
+}
+
+// The cases of all rounding outcomes of every positive encoding, one chunk per binade, each correctly rounded.
+// The sweep saturates only after all their cells are covered, and then after exactly the saturation window
+// of chunks that add nothing, here the same cases with negative sign.
+int VerifySaturation(size_t nbits, size_t es, unsigned window)
+{
+    int nrOfFailedTestCases = 0;
+    const string tag = "posit<" + to_string(nbits) + "," + to_string(es) + "> ";
+    const uint64_t mask = (uint64_t(1) << nbits) - 1, maxpos = (uint64_t(1) << (nbits - 1)) - 1;
+
+    vector< vector<uint64_t> > chunk_preference;
+    vector< vector<double> > chunk_reference;
+    set<size_t> expected;
+    auto add = [&](uint64_t raw, double reference, unsigned outcome) {
+        chunk_preference.back().push_back(raw);
+        chunk_reference.back().push_back(reference);
+        expected.insert(ExpectedCell(raw, nbits, es, outcome));
+    };
+    for (uint64_t p = 1; p <= maxpos; ++p) {
+        const decoded_posit d = Decode(p, nbits, es);
+        if (p == 1 || d.k != Decode(p - 1, nbits, es).k || d.exponent != Decode(p - 1, nbits, es).exponent) {
+            chunk_preference.emplace_back();
+            chunk_reference.emplace_back();
+        }
+        add(p, d.value, sw::qa::ROUND_EXACT);
+        if (p == 1) add(p, d.value / 4, sw::qa::ROUND_SATURATE);
+        if (p == maxpos) {
+            add(p, d.value * 4, sw::qa::ROUND_SATURATE);
+            continue;
+        }
+        // between p and p + 1, ties go to the even encoding
+        const double mid = Midpoint(p, nbits, es), next = Decode(p + 1, nbits, es).value;
+        add(p, (d.value + mid) / 2, sw::qa::ROUND_DOWN_STICKY);
+        if (p % 2 == 0) add(p, mid, sw::qa::ROUND_DOWN_TIE);
+        else add(p + 1, mid, sw::qa::ROUND_UP_TIE);
+        add(p + 1, (mid + next) / 2, sw::qa::ROUND_UP_STICKY);
+    }
+
+    CoverageMap map(nbits, es, window);
+    expected.insert(map.Cells() - 2);
+    expected.insert(map.Cells() - 1);
+    const uint64_t zero_nar[] = { 0, uint64_t(1) << (nbits - 1) };
+    const double zero_nar_reference[] = { 0.0, NAN };
+    bool saturated = map.Advance(2, map.Cover(zero_nar, zero_nar_reference, 2));
+    for (size_t c = 0; c < chunk_preference.size(); ++c)
+        saturated = saturated || map.Advance(chunk_preference[c].size(), map.Cover(chunk_preference[c].data(), chunk_reference[c].data(), chunk_preference[c].size()));
+    if (saturated || map.Covered() != expected.size()) {
+        cerr << "FAIL: " << tag << (saturated ? "saturated with " : "covered ") << map.Covered() << " of " << expected.size() << " cells\n";
+        ++nrOfFailedTestCases;
+    }
+    for (size_t cell : expected) {
+        if (!map.Test(cell)) {
+            cerr << "FAIL: " << tag << "cell " << cell << " not covered\n";
+            ++nrOfFailedTestCases;
+        }
+    }
+
+    // the negative cases fall into the same cells: window - 1 such chunks leave the sweep running, the next one ends it
+    for (unsigned c = 0; c < window && c < chunk_preference.size(); ++c) {
+        vector<uint64_t> negative(chunk_preference[c].size());
+        vector<double> reference(chunk_reference[c].size());
+        for (size_t i = 0; i < negative.size(); ++i) {
+            negative[i] = (0 - chunk_preference[c][i]) & mask;
+            reference[i] = -chunk_reference[c][i];
+        }
+        saturated = map.Advance(negative.size(), map.Cover(negative.data(), reference.data(), negative.size()));
+        if (saturated != (c + 1 == window)) {
+            cerr << "FAIL: " << tag << "saturation " << (saturated ? "reported" : "not reported") << " after " << c + 1 << " stale chunks\n";
+            ++nrOfFailedTestCases;
+        }
+    }
+    if (map.Covered() != expected.size() || !map.Saturated()) {
+        cerr << "FAIL: " << tag << "negative cases covered new cells\n";
+        ++nrOfFailedTestCases;
+    }
+    return nrOfFailedTestCases;
+}
+
+int main()
+try {
+    cout << "This is the rounding coverage map test.\n";
+
+    int nrOfFailedTestCases = 0;
+    nrOfFailedTestCases += VerifyCells(8, 0);
+    nrOfFailedTestCases += VerifyCells(8, 1);
+    nrOfFailedTestCases += VerifyCells(16, 2);
+    nrOfFailedTestCases += VerifySaturation(8, 0, 3);
+    nrOfFailedTestCases += VerifySaturation(8, 2, 3);
+    nrOfFailedTestCases += VerifySaturation(12, 1, 5);
+
+	return (nrOfFailedTestCases > 0 ? EXIT_FAILURE : EXIT_SUCCESS);
+}
+catch (char* msg) {
+	cerr << msg << endl;
+	return EXIT_FAILURE;
+}
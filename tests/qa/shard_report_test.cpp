@@ -0,0 +1,138 @@
+// shard_report_test.cpp: Test the shard ranges and the merging of shard reports of random QA sweeps
+//
+// Copyright (C) 2017 Stillwater Supercomputing, Inc.
+//
+// This file is part of the universal numbers project, which is released under an MIT Open Source license.
+
+#include <cstdint>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "../../tools/qa/shard_report.hpp"
+
+using namespace std;
+using sw::qa::ShardReport;
+
+typedef pair<uint64_t, uint64_t> case_range;
+
+int ExpectRange(case_range range, case_range expected, const string& what)
+{
+    if (range == expected)
+        return 0;
+    cerr << "FAIL: " << what << ": [" << range.first << ", " << range.second << ") instead of ["
+         << expected.first << ", " << expected.second << ")\n";
+    return 1;
+}
+
+// shards tile the sweep, start and count narrow a shard down, and a start past the shard clamps to an empty range
+int VerifyShardRanges()
+{
+    int nrOfFailedTestCases = 0;
+    nrOfFailedTestCases += ExpectRange(sw::qa::ShardRange(1000, 0, 2), case_range(0, 500), "shard 0/2");
+    nrOfFailedTestCases += ExpectRange(sw::qa::ShardRange(1000, 1, 2), case_range(500, 1000), "shard 1/2");
+    nrOfFailedTestCases += ExpectRange(sw::qa::ShardRange(10, 0, 3), case_range(0, 4), "shard 0/3");
+    nrOfFailedTestCases += ExpectRange(sw::qa::ShardRange(10, 2, 3), case_range(7, 10), "shard 2/3");
+    nrOfFailedTestCases += ExpectRange(sw::qa::ShardRange(1000, 1, 2, 900), case_range(900, 1000), "start inside the shard");
+    nrOfFailedTestCases += ExpectRange(sw::qa::ShardRange(1000, 1, 2, 900, 50), case_range(900, 950), "start and count");
+    nrOfFailedTestCases += ExpectRange(sw::qa::ShardRange(1000, 0, 2, 900), case_range(500, 500), "start past the shard");
+    nrOfFailedTestCases += ExpectRange(sw::qa::ShardRange(1000, 0, 1, 2000, 1), case_range(1000, 1000), "start past the sweep");
+    return nrOfFailedTestCases;
+}
+
+ShardReport Shard(uint64_t seed, vector<case_range> ranges, vector<uint64_t> failed_cases)
+{
+    ShardReport report;
+    report.nbits = 32;
+    report.es = 2;
+    report.op = "add";
+    report.seed = seed;
+    report.total = 1000;
+    report.ranges = ranges;
+    report.failed_cases = failed_cases;
+    return report;
+}
+
+bool MergeThrows(const vector<ShardReport>& shards)
+{
+    try {
+        sw::qa::MergeShardReports(shards);
+    }
+    catch (const runtime_error&) {
+        return true;
+    }
+    return false;
+}
+
+int VerifyMerge()
+{
+    int nrOfFailedTestCases = 0;
+
+    // two halves merge into the complete sweep, with the failures of both in order
+    ShardReport merged = sw::qa::MergeShardReports({ Shard(7, { case_range(500, 1000) }, { 600 }), Shard(7, { case_range(0, 500) }, { 42, 3 }) });
+    if (merged.ranges != vector<case_range>{ case_range(0, 1000) } || merged.CoveredCases() != 1000 || !merged.Complete()
+        || merged.failed_cases != vector<uint64_t>{ 3, 42, 600 }) {
+        cerr << "FAIL: merge of two halves covers " << merged.CoveredCases() << " cases with " << merged.failed_cases.size() << " failures\n";
+        ++nrOfFailedTestCases;
+    }
+
+    // shard 0/2 started past its end contributes its clamped, empty range and leaves the sweep incomplete
+    merged = sw::qa::MergeShardReports({ Shard(7, { sw::qa::ShardRange(1000, 0, 2, 900) }, {}), Shard(7, { sw::qa::ShardRange(1000, 1, 2, 900) }, { 901 }) });
+    if (merged.CoveredCases() != 100 || merged.Complete() || merged.failed_cases.size() != 1) {
+        cerr << "FAIL: merge of clamped shards covers " << merged.CoveredCases() << " cases\n";
+        ++nrOfFailedTestCases;
+    }
+
+    // overlapping shards, ranges past the end of the sweep, reversed ranges, and different sweeps are rejected
+    if (!MergeThrows({ Shard(7, { case_range(0, 600) }, {}), Shard(7, { case_range(500, 1000) }, {}) })) {
+        cerr << "FAIL: overlapping shards merged\n";
+        ++nrOfFailedTestCases;
+    }
+    if (!MergeThrows({ Shard(7, { case_range(0, 500) }, {}), Shard(7, { case_range(500, 1200) }, {}) })) {
+        cerr << "FAIL: shard past the end of the sweep merged\n";
+        ++nrOfFailedTestCases;
+    }
+    if (!MergeThrows({ Shard(7, { case_range(900, 500) }, {}) })) {
+        cerr << "FAIL: reversed range merged\n";
+        ++nrOfFailedTestCases;
+    }
+    if (!MergeThrows({ Shard(7, { case_range(0, 500) }, {}), Shard(8, { case_range(500, 1000) }, {}) })) {
+        cerr << "FAIL: shards of different sweeps merged\n";
+        ++nrOfFailedTestCases;
+    }
+    return nrOfFailedTestCases;
+}
+
+// a report survives the text format the shards exchange
+int VerifyRoundTrip()
+{
+    int nrOfFailedTestCases = 0;
+    ShardReport report = Shard(7, { case_range(0, 250), case_range(750, 1000) }, { 5, 800 });
+    stringstream text;
+    sw::qa::WriteShardReport(text, report);
+    ShardReport read = sw::qa::ReadShardReport(text);
+    if (!read.SameSweep(report) || read.ranges != report.ranges || read.failed_cases != report.failed_cases) {
+        cerr << "FAIL: report does not read back\n";
+        ++nrOfFailedTestCases;
+    }
+    return nrOfFailedTestCases;
+}
+
+int main()
+try {
+    cout << "This is the shard report test.\n";
+
+    int nrOfFailedTestCases = 0;
+    nrOfFailedTestCases += VerifyShardRanges();
+    nrOfFailedTestCases += VerifyMerge();
+    nrOfFailedTestCases += VerifyRoundTrip();
+
+	return (nrOfFailedTestCases > 0 ? EXIT_FAILURE : EXIT_SUCCESS);
+}
+catch (char* msg) {
+	cerr << msg << endl;
+	return EXIT_FAILURE;
+}
@@ -0,0 +1,118 @@
+// stratified_sampler_test.cpp: Test the strata of the regime-aware operand sampler
+//
+// Copyright (C) 2017 Stillwater Supercomputing, Inc.
+//
+// This file is part of the universal numbers project, which is released under an MIT Open Source license.
+
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+#include "../../tools/qa/counter_rng.hpp"
+#include "../../tools/qa/stratified_sampler.hpp"
+
+using namespace std;
+using sw::qa::OperandStratum;
+using sw::qa::RegimeLayout;
+
+// index of a stratum in a dense nbits x es histogram, like OperandStrata
+size_t StratumIndex(size_t nbits, size_t es, const OperandStratum& s)
+{
+    return ((size_t(s.k + int(nbits - 2)) << es) + s.exponent) * sw::qa::NR_FRACTION_CLASSES + s.fraction_class;
+}
+
+// every stratum the format can encode decodes back to itself, with either sign
+int VerifyRoundTrip(size_t nbits, size_t es)
+{
+    int nrOfFailedTestCases = 0;
+    const sw::qa::counter_rng rng(nbits * 16 + es);
+    uint64_t i = 0;
+    for (int k = -int(nbits - 2); k <= int(nbits - 2); ++k) {
+        RegimeLayout layout = sw::qa::LayoutOfRegime(nbits, es, k);
+        for (unsigned e = 0; e < (1u << layout.exponent_bits); ++e) {
+            for (unsigned c = 0; c < sw::qa::NrOfFractionClasses(layout.fraction_bits); ++c) {
+                for (int negative = 0; negative < 2; ++negative) {
+                    OperandStratum s = { k, e, c }, decoded = {};
+                    uint64_t raw = sw::qa::EncodeStratum(nbits, es, s, negative != 0, rng(i++)[0]);
+                    if (!sw::qa::StratumOf(nbits, es, raw, decoded) || decoded.k != s.k || decoded.exponent != s.exponent
+                        || decoded.fraction_class != s.fraction_class) {
+                        cerr << "FAIL: posit<" << nbits << "," << es << "> stratum (" << k << ", " << e << ", " << sw::qa::FRACTION_CLASS_NAMES[c]
+                             << ") encodes to " << hex << raw << dec << ", which decodes to (" << decoded.k << ", " << decoded.exponent << ", "
+                             << sw::qa::FRACTION_CLASS_NAMES[decoded.fraction_class] << ")\n";
+                        ++nrOfFailedTestCases;
+                    }
+                }
+            }
+        }
+    }
+    // zero and NaR have no stratum
+    OperandStratum s = {};
+    if (sw::qa::StratumOf(nbits, es, 0, s) || sw::qa::StratumOf(nbits, es, uint64_t(1) << (nbits - 1), s)) {
+        cerr << "FAIL: posit<" << nbits << "," << es << "> zero or NaR has a stratum\n";
+        ++nrOfFailedTestCases;
+    }
+    return nrOfFailedTestCases;
+}
+
+// The first operands of the sampler hit each stratum with the probability of its allocation: a uniform regime,
+// a uniform exponent field among those that fit after it, and a uniform fraction class among those that fit.
+int VerifyAllocation(size_t nbits, size_t es, uint64_t nrOfSamples)
+{
+    int nrOfFailedTestCases = 0;
+    const sw::qa::counter_rng rng(0x5eed + nbits * 16 + es);
+    vector<uint64_t> counts(size_t(sw::qa::NrOfRegimes(nbits)) * sw::qa::NR_FRACTION_CLASSES << es, 0);
+    sw::qa::OperandStrata strata(nbits, es);
+    for (uint64_t i = 0; i < nrOfSamples; ++i) {
+        uint64_t a, b;
+        sw::qa::StratifiedPair(nbits, es, rng(i, 1), rng(i, 2), a, b);
+        strata.Record(a);
+        OperandStratum s = {};
+        if (!sw::qa::StratumOf(nbits, es, a, s)) {
+            cerr << "FAIL: posit<" << nbits << "," << es << "> sampled zero or NaR\n";
+            return nrOfFailedTestCases + 1;
+        }
+        ++counts[StratumIndex(nbits, es, s)];
+    }
+
+    for (int k = -int(nbits - 2); k <= int(nbits - 2); ++k) {
+        RegimeLayout layout = sw::qa::LayoutOfRegime(nbits, es, k);
+        const unsigned classes = sw::qa::NrOfFractionClasses(layout.fraction_bits);
+        const double expected = double(nrOfSamples) / sw::qa::NrOfRegimes(nbits) / double(1u << layout.exponent_bits) / classes;
+        for (unsigned e = 0; e < (1u << layout.exponent_bits); ++e) {
+            for (unsigned c = 0; c < classes; ++c) {
+                const uint64_t count = counts[StratumIndex(nbits, es, { k, e, c })];
+                if (std::abs(double(count) - expected) > 5.0 * std::sqrt(expected) + 1.0) {
+                    cerr << "FAIL: posit<" << nbits << "," << es << "> stratum (" << k << ", " << e << ", " << sw::qa::FRACTION_CLASS_NAMES[c]
+                         << ") sampled " << count << " times, expected " << expected << '\n';
+                    ++nrOfFailedTestCases;
+                }
+            }
+        }
+    }
+    if (strata.Hit() != strata.Reachable()) {
+        cerr << "FAIL: posit<" << nbits << "," << es << "> " << strata.Hit() << " of " << strata.Reachable() << " strata hit\n";
+        ++nrOfFailedTestCases;
+    }
+    return nrOfFailedTestCases;
+}
+
+int main()
+try {
+    cout << "This is the stratified sampler test.\n";
+
+    int nrOfFailedTestCases = 0;
+    nrOfFailedTestCases += VerifyRoundTrip(8, 0);
+    nrOfFailedTestCases += VerifyRoundTrip(8, 2);
+    nrOfFailedTestCases += VerifyRoundTrip(16, 1);
+    nrOfFailedTestCases += VerifyRoundTrip(32, 2);
+    nrOfFailedTestCases += VerifyRoundTrip(64, 3);
+    nrOfFailedTestCases += VerifyAllocation(8, 0, 200000);
+    nrOfFailedTestCases += VerifyAllocation(16, 1, 400000);
+
+	return (nrOfFailedTestCases > 0 ? EXIT_FAILURE : EXIT_SUCCESS);
+}
+catch (char* msg) {
+	cerr << msg << endl;
+	return EXIT_FAILURE;
+}
@@ -0,0 +1,93 @@
+// batch_ops_test.cpp: Test the batch operations against element-by-element engine calls
+//
+// Copyright (C) 2017 Stillwater Supercomputing, Inc.
+//
+// This file is part of the universal numbers project, which is released under an MIT Open Source license.
+
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include <posit>
+
+#include "../../utilities/batch_ops.hpp"
+#include "../../utilities/dispatch_table.hpp"
+
+using namespace std;
+
+// every operation of every configuration on random encodings, out of place and in place
+struct verify_batch
+{
+    template <size_t Nbits, size_t ES>
+    void operator()()
+    {
+        using raw_type = posit_storage_t<Nbits>;
+        const size_t n = 1000;
+        mt19937_64 eng(Nbits * 16 + ES);
+        vector<raw_type> a(n), b(n), c(n), in_place(n);
+        for (size_t i = 0; i < n; ++i) {
+            a[i] = raw_type(eng() & ((uint64_t(1) << Nbits) - 1));
+            b[i] = raw_type(eng() & ((uint64_t(1) << Nbits) - 1));
+        }
+        generic_posit_engine<Nbits, ES> generic;
+        for (binary_op op : { binary_op::add, binary_op::sub, binary_op::mul, binary_op::div }) {
+            batch_apply<Nbits, ES>(op, a.data(), b.data(), c.data(), n);
+            in_place = a;
+            batch_apply<Nbits, ES>(op, in_place.data(), b.data(), in_place.data(), n);
+            int failures = 0;
+            for (size_t i = 0; i < n; ++i) {
+                raw_type expected = 0;
+                switch (op) {
+                    case binary_op::add: expected = generic.add(a[i], b[i]); break;
+                    case binary_op::sub: expected = generic.sub(a[i], b[i]); break;
+                    case binary_op::mul: expected = generic.mul(a[i], b[i]); break;
+                    case binary_op::div: expected = generic.div(a[i], b[i]); break;
+                }
+                failures += c[i] != expected;
+                failures += in_place[i] != expected;
+            }
+            if (failures) {
+                cerr << "FAIL: posit<" << Nbits << "," << ES << "> operation " << int(op) << " disagrees in " << failures << " cases\n";
+                nrOfFailedTestCases += failures;
+            }
+        }
+    }
+
+    int nrOfFailedTestCases = 0;
+};
+
+int VerifyReference()
+{
+    const double a[] = { 1.5, -2.0, 0.25 }, b[] = { 0.5, 4.0, -8.0 };
+    const double expected[4][3] = { { 2.0, 2.0, -7.75 }, { 1.0, -6.0, 8.25 }, { 0.75, -8.0, -2.0 }, { 3.0, -0.5, -0.03125 } };
+    int nrOfFailedTestCases = 0;
+    double c[3];
+    for (binary_op op : { binary_op::add, binary_op::sub, binary_op::mul, binary_op::div }) {
+        batch_reference(op, a, b, c, 3);
+        for (int i = 0; i < 3; ++i) {
+            if (c[i] != expected[int(op)][i]) {
+                cerr << "FAIL: reference of operation " << int(op) << " element " << i << " is " << c[i] << '\n';
+                ++nrOfFailedTestCases;
+            }
+        }
+    }
+    return nrOfFailedTestCases;
+}
+
+int main()
+try {
+    cout << "This is the batch operations test.\n";
+
+    verify_batch verifier;
+    for (size_t nbits = dispatch_min_nbits; nbits <= dispatch_max_nbits; ++nbits)
+        for (size_t es = 0; es <= dispatch_max_es; ++es)
+            table_dispatch(verifier, nbits, es);
+    int nrOfFailedTestCases = verifier.nrOfFailedTestCases + VerifyReference();
+
+	return (nrOfFailedTestCases > 0 ? EXIT_FAILURE : EXIT_SUCCESS);
+}
+catch (char* msg) {
+	cerr << msg << endl;
+	return EXIT_FAILURE;
+}
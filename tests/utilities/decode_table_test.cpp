@@ -0,0 +1,140 @@
+// decode_table_test.cpp: Test the shared posit decode tables against the library conversion
+//
+// Copyright (C) 2017 Stillwater Supercomputing, Inc.
+//
+// This file is part of the universal numbers project, which is released under an MIT Open Source license.
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <posit>
+
+#include "../../utilities/decode_table.hpp"
+#include "../../utilities/batch_convert.hpp"
+
+using namespace std;
+
+bool SameDouble(double a, double b)
+{
+    return (std::isnan(a) && std::isnan(b)) || std::memcmp(&a, &b, sizeof(double)) == 0;
+}
+
+// every encoding decodes to the library value, and less() is the posit order
+template <size_t Nbits, size_t ES>
+int VerifyTable()
+{
+    int nrOfFailedTestCases = 0;
+    const decode_table& table = decode_table_for<Nbits, ES>();
+    if (&table != &decode_table_for(Nbits, ES)) {
+        cerr << "FAIL: posit<" << Nbits << "," << ES << "> typed and run-time lookup differ\n";
+        ++nrOfFailedTestCases;
+    }
+    sw::unum::posit<Nbits, ES> p, q;
+    for (uint64_t raw = 0; raw < (uint64_t(1) << Nbits); ++raw) {
+        p.set_raw_bits(raw);
+        if (!SameDouble(table[raw], double(p))) {
+            cerr << "FAIL: posit<" << Nbits << "," << ES << "> " << raw << " decodes to " << table[raw] << " instead of " << double(p) << '\n';
+            ++nrOfFailedTestCases;
+        }
+        // neighbours on the posit circle, NaR sorts below everything
+        const uint64_t next = (raw + 1) & ((uint64_t(1) << Nbits) - 1);
+        q.set_raw_bits(next);
+        const bool expected = p.isNaR() ? !q.isNaR() : (!q.isNaR() && double(p) < double(q));
+        if (table.less(raw, next) != expected) {
+            cerr << "FAIL: posit<" << Nbits << "," << ES << "> order of " << raw << " and " << next << '\n';
+            ++nrOfFailedTestCases;
+        }
+    }
+    return nrOfFailedTestCases;
+}
+
+// threads racing for the first use of a table all get the same, complete one
+int VerifyConcurrentFirstUse()
+{
+    int nrOfFailedTestCases = 0;
+    const size_t nrOfThreads = 8;
+    vector<const decode_table*> seen(nrOfThreads);
+    vector<thread> threads;
+    for (size_t t = 0; t < nrOfThreads; ++t)
+        threads.emplace_back([&seen, t]() { seen[t] = &decode_table_for(14, 2); });
+    for (auto& t : threads)
+        t.join();
+    sw::unum::posit<14, 2> p;
+    for (size_t t = 0; t < nrOfThreads; ++t) {
+        if (seen[t] != seen[0]) {
+            cerr << "FAIL: thread " << t << " got a different posit<14,2> table\n";
+            ++nrOfFailedTestCases;
+        }
+    }
+    for (uint64_t raw = 0; raw < (uint64_t(1) << 14); ++raw) {
+        p.set_raw_bits(raw);
+        if (!SameDouble((*seen[0])[raw], double(p))) {
+            ++nrOfFailedTestCases;
+            break;
+        }
+    }
+    return nrOfFailedTestCases;
+}
+
+// batch decoding goes through the tables up to 16 bits
+int VerifyBatchDecode()
+{
+    int nrOfFailedTestCases = 0;
+    vector<uint16_t> raw(1 << 12);
+    for (size_t i = 0; i < raw.size(); ++i)
+        raw[i] = uint16_t(i * 17);
+    vector<double> out(raw.size());
+    convert_from_posit(raw.data(), raw.size(), out.data(), nbits_select(16), es_select(1));
+    sw::unum::posit<16, 1> p;
+    for (size_t i = 0; i < raw.size(); ++i) {
+        p.set_raw_bits(raw[i]);
+        if (!SameDouble(out[i], double(p))) {
+            cerr << "FAIL: batch decode of posit<16,1> " << raw[i] << '\n';
+            ++nrOfFailedTestCases;
+        }
+    }
+    return nrOfFailedTestCases;
+}
+
+int VerifyFormats()
+{
+    int nrOfFailedTestCases = 0;
+    for (auto format : { make_pair(17, 1), make_pair(5, 4), make_pair(2, 0) }) {
+        try {
+            decode_table_for(size_t(format.first), size_t(format.second));
+            cerr << "FAIL: posit<" << format.first << "," << format.second << "> got a decode table\n";
+            ++nrOfFailedTestCases;
+        }
+        catch (const std::invalid_argument&) {}
+    }
+    return nrOfFailedTestCases;
+}
+
+int main()
+try {
+    cout << "This is the decode table test.\n";
+
+    int nrOfFailedTestCases = 0;
+    nrOfFailedTestCases += VerifyTable<3, 0>();
+    nrOfFailedTestCases += VerifyTable<5, 3>();
+    nrOfFailedTestCases += VerifyTable<8, 0>();
+    nrOfFailedTestCases += VerifyTable<8, 2>();
+    nrOfFailedTestCases += VerifyTable<12, 1>();
+    nrOfFailedTestCases += VerifyTable<16, 1>();
+    nrOfFailedTestCases += VerifyTable<16, 5>();
+    nrOfFailedTestCases += VerifyConcurrentFirstUse();
+    nrOfFailedTestCases += VerifyBatchDecode();
+    nrOfFailedTestCases += VerifyFormats();
+
+	return (nrOfFailedTestCases > 0 ? EXIT_FAILURE : EXIT_SUCCESS);
+}
+catch (char* msg) {
+	cerr << msg << endl;
+	return EXIT_FAILURE;
+}
@@ -0,0 +1,86 @@
+// dispatch_table_test.cpp: Test the jump-table selection of posit formats
+//
+// Copyright (C) 2017 Stillwater Supercomputing, Inc.
+//
+// This file is part of the universal numbers project, which is released under an MIT Open Source license.
+
+#include <iostream>
+#include <string>
+
+#include "../../utilities/dispatch_table.hpp"
+
+using namespace std;
+
+struct record_configuration
+{
+    template <std::size_t Nbits, std::size_t ES>
+    void operator()()
+    {
+        nbits = Nbits;
+        es = ES;
+        ++calls;
+    }
+
+    size_t nbits = 0, es = 0, calls = 0;
+};
+
+int main()
+try {
+	int nrOfFailedTestCases = 0;
+
+    cout << "This is the posit dispatch table test.\n";
+
+    size_t nrOfValidConfigurations = 0;
+    for (size_t nbits = 0; nbits < 30; ++nbits) {
+        for (size_t es = 0; es < 8; ++es) {
+            record_configuration rec;
+            dispatch_status status = table_dispatch(rec, nbits, es);
+
+            dispatch_status expected = dispatch_status::ok;
+            if (nbits < dispatch_min_nbits || nbits > dispatch_max_nbits)
+                expected = dispatch_status::unsupported_nbits;
+            else if (es > dispatch_max_es)
+                expected = dispatch_status::unsupported_es;
+            else if (!valid_posit_configuration(nbits, es))
+                expected = dispatch_status::invalid_configuration;
+
+            if (status != expected) {
+                cerr << "FAIL: (" << nbits << ", " << es << ") returned '" << to_string(status) << "' instead of '" << to_string(expected) << "'\n";
+                ++nrOfFailedTestCases;
+            }
+            if (status == dispatch_status::ok) {
+                ++nrOfValidConfigurations;
+                if (rec.calls != 1 || rec.nbits != nbits || rec.es != es) {
+                    cerr << "FAIL: (" << nbits << ", " << es << ") dispatched to (" << rec.nbits << ", " << rec.es << ")\n";
+                    ++nrOfFailedTestCases;
+                }
+            }
+            else if (rec.calls != 0) {
+                cerr << "FAIL: (" << nbits << ", " << es << ") called a kernel although dispatch failed\n";
+                ++nrOfFailedTestCases;
+            }
+        }
+    }
+
+    if (nrOfValidConfigurations != dispatch_table<record_configuration>::size()) {
+        cerr << "FAIL: table holds " << dispatch_table<record_configuration>::size() << " kernels but "
+             << nrOfValidConfigurations << " configurations dispatched\n";
+        ++nrOfFailedTestCases;
+    }
+
+    // variant entry point must agree with the selectors
+    record_configuration rec;
+    table_dispatch(rec, nbits_select(12), es_select(3));
+    if (rec.nbits != 12 || rec.es != 3) {
+        cerr << "FAIL: variant dispatch selected (" << rec.nbits << ", " << rec.es << ")\n";
+        ++nrOfFailedTestCases;
+    }
+
+    cout << nrOfValidConfigurations << " valid configurations\n";
+
+	return (nrOfFailedTestCases > 0 ? EXIT_FAILURE : EXIT_SUCCESS);
+}
+catch (char* msg) {
+	cerr << msg << endl;
+	return EXIT_FAILURE;
+}
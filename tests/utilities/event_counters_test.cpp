@@ -0,0 +1,149 @@
+// event_counters_test.cpp: Test the classification and per-thread aggregation of arithmetic events
+//
+// Copyright (C) 2017 Stillwater Supercomputing, Inc.
+//
+// This file is part of the universal numbers project, which is released under an MIT Open Source license.
+
+// the counters are tested whatever the build option
+#define EF_TENSORS_EVENT_COUNTERS 1
+
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <boost/numeric/mtl/mtl.hpp>
+#include <posit>
+
+#include "../../utilities/event_counters.hpp"
+#include "../../kernels/fused_dot.hpp"
+
+using namespace std;
+
+int Expect(const event_counts& counts, arithmetic_event e, uint64_t expected, const string& what)
+{
+    if (counts[e] == expected)
+        return 0;
+    cerr << "FAIL: " << what << ": " << to_string(e) << " = " << counts[e] << " instead of " << expected << '\n';
+    return 1;
+}
+
+int VerifyClassification()
+{
+    using posit_type = sw::unum::posit<8, 0>;
+    int nrOfFailedTestCases = 0;
+    reset_event_counts();
+
+    posit_type maxpos, minpos, one(1.0), zero(0.0), r;
+    maxpos.setToNaR();
+    --maxpos;
+    minpos.set_raw_bits(1);
+
+    record_rounding(one, 1.0);                          // exact
+    r = 1.0 / 3.0;
+    record_rounding(r, 1.0 / 3.0);                      // inexact
+    record_rounding(maxpos, double(maxpos) * 4);        // inexact, saturates
+    record_rounding(-maxpos, -double(maxpos) * 4);
+    record_rounding(minpos, double(minpos) / 4);        // inexact, saturates
+    r = one / zero;
+    record_rounding(r, 1.0 / 0.0);                      // NaR out of finite operands
+    r.setToNaR();
+    record_rounding(r, 0.0, true);                      // propagated NaR is no event
+
+    event_counts counts = collect_event_counts();
+    nrOfFailedTestCases += Expect(counts, arithmetic_event::inexact, 4, "classification");
+    nrOfFailedTestCases += Expect(counts, arithmetic_event::saturate_maxpos, 2, "classification");
+    nrOfFailedTestCases += Expect(counts, arithmetic_event::saturate_minpos, 1, "classification");
+    nrOfFailedTestCases += Expect(counts, arithmetic_event::nar_result, 1, "classification");
+    nrOfFailedTestCases += Expect(counts, arithmetic_event::quire_overflow, 0, "classification");
+    return nrOfFailedTestCases;
+}
+
+// finished threads keep their counts, reset clears them
+int VerifyAggregation()
+{
+    int nrOfFailedTestCases = 0;
+    reset_event_counts();
+    const unsigned nrOfThreads = 6;
+    const uint64_t perThread = 10000;
+    vector<thread> threads;
+    for (unsigned t = 0; t < nrOfThreads; ++t)
+        threads.emplace_back([]() {
+            for (uint64_t i = 0; i < perThread; ++i)
+                count_event(arithmetic_event::inexact);
+            count_event(arithmetic_event::quire_overflow, 3);
+        });
+    for (auto& t : threads)
+        t.join();
+    count_event(arithmetic_event::inexact);
+
+    event_counts counts = collect_event_counts();
+    nrOfFailedTestCases += Expect(counts, arithmetic_event::inexact, nrOfThreads * perThread + 1, "aggregation");
+    nrOfFailedTestCases += Expect(counts, arithmetic_event::quire_overflow, 3 * nrOfThreads, "aggregation");
+
+    ostringstream json;
+    write_event_counts_json(json, counts);
+    if (json.str().find("\"inexact\": " + to_string(nrOfThreads * perThread + 1)) == string::npos) {
+        cerr << "FAIL: json export\n" << json.str();
+        ++nrOfFailedTestCases;
+    }
+
+    reset_event_counts();
+    nrOfFailedTestCases += Expect(collect_event_counts(), arithmetic_event::inexact, 0, "reset");
+    return nrOfFailedTestCases;
+}
+
+// the quire kernels classify their single rounding
+int VerifyKernel()
+{
+    using posit_type = sw::unum::posit<16, 1>;
+    int nrOfFailedTestCases = 0;
+    reset_event_counts();
+    mtl::dense_vector<posit_type> x(3), y(3);
+    x[0] = 1.0; x[1] = 1.0 / 3.0; x[2] = 2.0;
+    y[0] = 1.0; y[1] = 1.0 / 3.0; y[2] = 0.5;
+    fused_dot(x, y);                    // 2 + (1/3)^2 rounds
+    x[1] = 0.5;
+    y[1] = 0.25;
+    fused_dot(x, y);                    // exact
+    nrOfFailedTestCases += Expect(collect_event_counts(), arithmetic_event::inexact, 1, "fused_dot");
+    return nrOfFailedTestCases;
+}
+
+// a quire sum wider than a long double still classifies its rounding
+int VerifyWideQuire()
+{
+    using posit_type = sw::unum::posit<32, 2>;
+    int nrOfFailedTestCases = 0;
+    reset_event_counts();
+    posit_type one(1.0), tiny(std::ldexp(1.0, -80)), result;
+    sw::unum::quire<32, 2, kernel_quire_capacity> q;
+    q += sw::unum::quire_mul(one, one);
+    q += sw::unum::quire_mul(tiny, one);    // 1 + 2^-80 rounds to 1, in a long double as well
+    convert(q.to_value(), result);
+    record_quire_result(result, q, 2, kernel_quire_capacity, false);
+    q -= sw::unum::quire_mul(tiny, one);
+    record_quire_result(result, q, 2, kernel_quire_capacity, false);
+    nrOfFailedTestCases += Expect(collect_event_counts(), arithmetic_event::inexact, 1, "wide quire");
+    return nrOfFailedTestCases;
+}
+
+int main()
+try {
+    cout << "This is the event counters test.\n";
+
+    int nrOfFailedTestCases = 0;
+    nrOfFailedTestCases += VerifyClassification();
+    nrOfFailedTestCases += VerifyWideQuire();
+    nrOfFailedTestCases += VerifyAggregation();
+    nrOfFailedTestCases += VerifyKernel();
+
+	return (nrOfFailedTestCases > 0 ? EXIT_FAILURE : EXIT_SUCCESS);
+}
+catch (char* msg) {
+	cerr << msg << endl;
+	return EXIT_FAILURE;
+}
@@ -0,0 +1,98 @@
+// format_search_test.cpp: Test the pruned minimum-precision search on a synthetic error model
+//
+// Copyright (C) 2017 Stillwater Supercomputing, Inc.
+//
+// This file is part of the universal numbers project, which is released under an MIT Open Source license.
+
+#include <cmath>
+#include <cstddef>
+#include <iostream>
+#include <set>
+#include <utility>
+
+#include "../../utilities/format_search.hpp"
+
+using namespace std;
+
+// Precision of 2^-(nbits - es - 3), and a range that saturates for es below min_es:
+// non-increasing in nbits at fixed es, as the search assumes, with its optimum at es = min_es.
+struct model_workload
+{
+    template <size_t Nbits, size_t ES>
+    double operator()() const
+    {
+        if (ES < min_es)
+            return 1.0;
+        return exp2(-double(Nbits) + double(ES) + 3.0);
+    }
+
+    size_t min_es;
+};
+
+// the narrowest feasible format of the model by brute force
+pair<size_t, size_t> Exhaustive(const model_workload& model, double bound)
+{
+    for (size_t nbits = dispatch_min_nbits; nbits <= dispatch_max_nbits; ++nbits)
+        for (size_t es = 0; es <= dispatch_max_es && es + 2 <= nbits; ++es)
+            if (es >= model.min_es && exp2(-double(nbits) + double(es) + 3.0) <= bound)
+                return make_pair(nbits, es);
+    return make_pair(size_t(0), size_t(0));
+}
+
+int VerifySearch(size_t min_es, double bound, unsigned nrOfThreads)
+{
+    int nrOfFailedTestCases = 0;
+    model_workload model{ min_es };
+    format_search_options options;
+    options.error_bound = bound;
+    options.nrOfThreads = nrOfThreads;
+    format_search_result result = minimum_precision_search(model, options);
+
+    pair<size_t, size_t> expected = Exhaustive(model, bound);
+    if (!result.found || result.smallest.nbits != expected.first || result.smallest.es != expected.second) {
+        cerr << "FAIL: min_es " << min_es << " bound " << bound << " found posit<" << result.smallest.nbits << "," << result.smallest.es
+             << "> instead of posit<" << expected.first << "," << expected.second << ">\n";
+        ++nrOfFailedTestCases;
+    }
+    // the pruning must beat brute force by a wide margin, and never measure a format twice
+    set<pair<size_t, size_t> > unique;
+    for (const auto& m : result.evaluated)
+        unique.insert(make_pair(m.nbits, m.es));
+    if (unique.size() != result.evaluated.size() || result.evaluated.size() > 40) {
+        cerr << "FAIL: min_es " << min_es << " bound " << bound << " measured " << result.evaluated.size() << " formats, "
+             << unique.size() << " distinct\n";
+        ++nrOfFailedTestCases;
+    }
+    return nrOfFailedTestCases;
+}
+
+int VerifyInfeasible()
+{
+    model_workload model{ 0 };
+    format_search_options options;
+    options.error_bound = 1.0e-12;
+    format_search_result result = minimum_precision_search(model, options);
+    if (result.found) {
+        cerr << "FAIL: an impossible bound was met\n";
+        return 1;
+    }
+    return 0;
+}
+
+int main()
+try {
+    cout << "This is the format search test.\n";
+
+    int nrOfFailedTestCases = 0;
+    for (size_t min_es : { 0, 1, 3, 5 })
+        for (double bound : { 1.0e-1, 1.0e-3, 1.0e-4 })
+            for (unsigned threads : { 1u, 4u })
+                nrOfFailedTestCases += VerifySearch(min_es, bound, threads);
+    nrOfFailedTestCases += VerifyInfeasible();
+
+	return (nrOfFailedTestCases > 0 ? EXIT_FAILURE : EXIT_SUCCESS);
+}
+catch (char* msg) {
+	cerr << msg << endl;
+	return EXIT_FAILURE;
+}
@@ -0,0 +1,107 @@
+// native_posit_test.cpp: Test that the native-integer engines of the standard posits agree with the generic implementation
+//
+// Copyright (C) 2017 Stillwater Supercomputing, Inc.
+//
+// This file is part of the universal numbers project, which is released under an MIT Open Source license.
+
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <posit>
+
+#include "../../utilities/posit_engine.hpp"
+#include "../../utilities/posit_native.hpp"
+
+using namespace std;
+
+template <size_t Nbits, size_t ES>
+int VerifyPair(posit_storage_t<Nbits> a, posit_storage_t<Nbits> b, int& reported)
+{
+    native_posit_engine<Nbits, ES> native;
+    generic_posit_engine<Nbits, ES> generic;
+    const posit_storage_t<Nbits> results[] = { native.add(a, b), native.sub(a, b), native.mul(a, b), native.div(a, b) };
+    const posit_storage_t<Nbits> expected[] = { generic.add(a, b), generic.sub(a, b), generic.mul(a, b), generic.div(a, b) };
+    const char* names[] = { "add", "sub", "mul", "div" };
+    int failures = 0;
+    for (int op = 0; op < 4; ++op) {
+        if (results[op] == expected[op])
+            continue;
+        if (reported++ < 10)
+            cerr << "FAIL: posit<" << Nbits << "," << ES << "> " << names[op] << " 0x" << hex << uint64_t(a) << " 0x" << uint64_t(b)
+                 << " native 0x" << uint64_t(results[op]) << " generic 0x" << uint64_t(expected[op]) << dec << '\n';
+        ++failures;
+    }
+    return failures;
+}
+
+// All operand pairs of the special encodings and their neighbors, then random pairs, half of them
+// close in magnitude to exercise cancellation and half spread over the regimes.
+template <size_t Nbits, size_t ES>
+int VerifyEngine(size_t nrOfRandoms)
+{
+    using raw_type = posit_storage_t<Nbits>;
+    const raw_type nar = raw_type(uint64_t(1) << (Nbits - 1));
+    const raw_type one = raw_type(uint64_t(1) << (Nbits - 2));
+    vector<raw_type> special;
+    for (raw_type center : { raw_type(0), nar, one, raw_type(nar - 1), raw_type(1) }) {     // maxpos and minpos around nar and 0
+        for (int delta = -2; delta <= 2; ++delta) {
+            special.push_back(raw_type(center + delta));
+            special.push_back(raw_type(0 - raw_type(center + delta)));
+        }
+    }
+
+    int failures = 0, reported = 0;
+    for (raw_type a : special)
+        for (raw_type b : special)
+            failures += VerifyPair<Nbits, ES>(a, b, reported);
+
+    mt19937_64 eng(Nbits * 16 + ES);
+    for (size_t i = 0; i < nrOfRandoms; ++i) {
+        raw_type a = raw_type(raw_type(eng()) >> (eng() % Nbits));
+        raw_type b = i % 2 ? raw_type(a ^ (eng() & 0xFF)) : raw_type(raw_type(eng()) >> (eng() % Nbits));
+        if (eng() & 1) a = raw_type(0 - a);
+        if (eng() & 1) b = raw_type(0 - b);
+        failures += VerifyPair<Nbits, ES>(a, b, reported);
+    }
+    if (failures)
+        cerr << "FAIL: posit<" << Nbits << "," << ES << "> native engine disagrees in " << failures << " cases\n";
+    return failures;
+}
+
+// all operand pairs of posit<8,0>
+int VerifyExhaustive()
+{
+    int failures = 0, reported = 0;
+    for (unsigned a = 0; a < 256; ++a)
+        for (unsigned b = 0; b < 256; ++b)
+            failures += VerifyPair<8, 0>(uint8_t(a), uint8_t(b), reported);
+    if (failures)
+        cerr << "FAIL: posit<8,0> native engine disagrees in " << failures << " cases\n";
+    return failures;
+}
+
+int main(int argc, char** argv)
+try {
+    cout << "This is the native posit engine test.\n";
+
+    size_t nrOfRandoms = 100000;
+    if (argc > 1)
+        nrOfRandoms = size_t(stoull(argv[1]));
+
+    int nrOfFailedTestCases = 0;
+    nrOfFailedTestCases += VerifyExhaustive();
+    nrOfFailedTestCases += VerifyEngine<16, 1>(nrOfRandoms);
+    nrOfFailedTestCases += VerifyEngine<32, 2>(nrOfRandoms);
+#if EF_TENSORS_HAS_INT128
+    nrOfFailedTestCases += VerifyEngine<64, 3>(nrOfRandoms);
+#endif
+
+	return (nrOfFailedTestCases > 0 ? EXIT_FAILURE : EXIT_SUCCESS);
+}
+catch (char* msg) {
+	cerr << msg << endl;
+	return EXIT_FAILURE;
+}
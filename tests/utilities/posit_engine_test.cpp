@@ -0,0 +1,97 @@
+// posit_engine_test.cpp: Test that the arithmetic engines agree with the generic posit implementation
+//
+// Copyright (C) 2017 Stillwater Supercomputing, Inc.
+//
+// This file is part of the universal numbers project, which is released under an MIT Open Source license.
+
+#include <iostream>
+#include <string>
+
+#include <posit>
+
+#include "../../utilities/dispatch_table.hpp"
+#include "../../utilities/posit_engine.hpp"
+
+using namespace std;
+
+// compare posit_engine<Nbits, ES> with the generic engine over all operand pairs
+struct verify_engine
+{
+    template <std::size_t Nbits, std::size_t ES>
+    void operator()()
+    {
+        using raw_type = typename posit_engine<Nbits, ES>::raw_type;
+        posit_engine<Nbits, ES> engine;
+        generic_posit_engine<Nbits, ES> generic;
+        const size_t NR_POSITS = size_t(1) << Nbits;
+        int failures = 0;
+        for (size_t i = 0; i < NR_POSITS; ++i) {
+            for (size_t j = 0; j < NR_POSITS; ++j) {
+                raw_type a = raw_type(i), b = raw_type(j);
+                failures += engine.add(a, b) != generic.add(a, b);
+                failures += engine.sub(a, b) != generic.sub(a, b);
+                failures += engine.mul(a, b) != generic.mul(a, b);
+                failures += engine.div(a, b) != generic.div(a, b);
+            }
+        }
+        if (failures) {
+            cerr << "FAIL: posit<" << Nbits << "," << ES << "> engine disagrees in " << failures << " cases\n";
+            nrOfFailedTestCases += failures;
+        }
+    }
+
+    int nrOfFailedTestCases = 0;
+};
+
+// The result tables are built from the generic engine, so check the engine of a small format against the
+// operators of sw::unum::posit directly, over all operand pairs
+template <std::size_t Nbits, std::size_t ES>
+int VerifyLibraryOperators()
+{
+    using posit_type = sw::unum::posit<Nbits, ES>;
+    using raw_type = typename posit_engine<Nbits, ES>::raw_type;
+    posit_engine<Nbits, ES> engine;
+    const size_t NR_POSITS = size_t(1) << Nbits;
+    int failures = 0;
+    posit_type pa, pb, pc;
+    for (size_t i = 0; i < NR_POSITS; ++i) {
+        pa.set_raw_bits(i);
+        for (size_t j = 0; j < NR_POSITS; ++j) {
+            pb.set_raw_bits(j);
+            raw_type a = raw_type(i), b = raw_type(j);
+            failures += pc.set_raw_bits(engine.add(a, b)) != pa + pb;
+            failures += pc.set_raw_bits(engine.sub(a, b)) != pa - pb;
+            failures += pc.set_raw_bits(engine.mul(a, b)) != pa * pb;
+            failures += pc.set_raw_bits(engine.div(a, b)) != pa / pb;
+        }
+    }
+    if (failures)
+        cerr << "FAIL: posit<" << Nbits << "," << ES << "> engine disagrees with the posit operators in " << failures << " cases\n";
+    return failures;
+}
+
+int main(int argc, char** argv)
+try {
+    cout << "This is the posit engine test.\n";
+
+    size_t maxNbits = 8;                     // all table configurations with argument 10
+    if (argc > 1)
+        maxNbits = size_t(stoull(argv[1]));
+
+    int nrOfFailedTestCases = 0;
+    nrOfFailedTestCases += VerifyLibraryOperators<8, 0>();
+    nrOfFailedTestCases += VerifyLibraryOperators<8, 2>();
+
+    verify_engine verifier;
+    for (size_t nbits = dispatch_min_nbits; nbits <= maxNbits; ++nbits)
+        for (size_t es = 0; es <= dispatch_max_es; ++es)
+            table_dispatch(verifier, nbits, es);
+
+    nrOfFailedTestCases += verifier.nrOfFailedTestCases;
+
+    return (nrOfFailedTestCases > 0 ? EXIT_FAILURE : EXIT_SUCCESS);
+}
+catch (char* msg) {
+	cerr << msg << endl;
+	return EXIT_FAILURE;
+}
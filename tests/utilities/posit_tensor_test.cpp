@@ -0,0 +1,122 @@
+// posit_tensor_test.cpp: Test bit-packed posit tensor storage, strided views, and pack/unpack
+//
+// Copyright (C) 2017 Stillwater Supercomputing, Inc.
+//
+// This file is part of the universal numbers project, which is released under an MIT Open Source license.
+
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <posit>
+
+#include "../../utilities/posit_tensor.hpp"
+
+using namespace std;
+
+int VerifyPacking(size_t nbits)
+{
+    int nrOfFailedTestCases = 0;
+    const size_t n = 1000;
+    posit_tensor t(nbits, 1, { n });
+    mt19937_64 eng(nbits);
+    vector<uint64_t> expected(n);
+    for (size_t i = 0; i < n; ++i) {
+        expected[i] = eng() & ((uint64_t(1) << nbits) - 1);
+        t.set_raw(i, expected[i]);
+    }
+    // overwrite every third element, the neighbours must survive
+    for (size_t i = 0; i < n; i += 3) {
+        expected[i] = ~expected[i] & ((uint64_t(1) << nbits) - 1);
+        t.set_raw(i, expected[i]);
+    }
+    for (size_t i = 0; i < n; ++i) {
+        if (t.get_raw(i) != expected[i]) {
+            cerr << "FAIL: nbits " << nbits << " element " << i << " reads " << t.get_raw(i) << " instead of " << expected[i] << '\n';
+            ++nrOfFailedTestCases;
+            break;
+        }
+    }
+    if (t.footprint() != ((n * nbits + 63) / 64 + 1) * 8) {
+        cerr << "FAIL: nbits " << nbits << " footprint " << t.footprint() << '\n';
+        ++nrOfFailedTestCases;
+    }
+    return nrOfFailedTestCases;
+}
+
+int VerifyViews()
+{
+    int nrOfFailedTestCases = 0;
+    // 4 x 6 matrix of posit<12,1> holding small integers, exact in the format
+    posit_tensor t(12, 1, { 4, 6 });
+    vector<double> values(24);
+    for (size_t i = 0; i < values.size(); ++i)
+        values[i] = double(i);
+    if (pack(values.data(), t.view()) != dispatch_status::ok) {
+        cerr << "FAIL: pack\n";
+        return 1;
+    }
+
+    // rows 1..3, every second column, transposed: 3 x 3 with element (j, i) = 6 * (1 + i) + 2 * j
+    posit_tensor_view v = t.view().slice(0, 1, 4).slice(1, 0, 6, 2).transpose(0, 1);
+    vector<double> out(v.size());
+    unpack(v, out.data());
+    for (size_t j = 0; j < 3; ++j) {
+        for (size_t i = 0; i < 3; ++i) {
+            if (out[j * 3 + i] != double(6 * (1 + i) + 2 * j)) {
+                cerr << "FAIL: view element (" << j << "," << i << ") = " << out[j * 3 + i] << '\n';
+                ++nrOfFailedTestCases;
+            }
+        }
+    }
+
+    // packing through the view touches only its elements
+    vector<double> minus(v.size(), -1.0);
+    pack(minus.data(), v);
+    unpack(t.view(), values.data());
+    for (size_t i = 0; i < values.size(); ++i) {
+        bool inView = i >= 6 && i % 2 == 0;
+        if (values[i] != (inView ? -1.0 : double(i))) {
+            cerr << "FAIL: element " << i << " = " << values[i] << " after packing into the view\n";
+            ++nrOfFailedTestCases;
+        }
+    }
+    return nrOfFailedTestCases;
+}
+
+int VerifyFormats()
+{
+    int nrOfFailedTestCases = 0;
+    try {
+        posit_tensor t(5, 4, { 2 });
+        cerr << "FAIL: posit<5,4> accepted\n";
+        ++nrOfFailedTestCases;
+    }
+    catch (const std::invalid_argument&) {}
+    try {
+        posit_tensor t(64, 3, { 2 });
+        cerr << "FAIL: nbits 64 accepted\n";
+        ++nrOfFailedTestCases;
+    }
+    catch (const unsupported_nbits_variant&) {}
+    return nrOfFailedTestCases;
+}
+
+int main()
+try {
+    cout << "This is the posit tensor test.\n";
+
+    int nrOfFailedTestCases = 0;
+    for (size_t nbits : { 3, 7, 8, 12, 16, 21, 22 })
+        nrOfFailedTestCases += VerifyPacking(nbits);
+    nrOfFailedTestCases += VerifyViews();
+    nrOfFailedTestCases += VerifyFormats();
+
+	return (nrOfFailedTestCases > 0 ? EXIT_FAILURE : EXIT_SUCCESS);
+}
+catch (char* msg) {
+	cerr << msg << endl;
+	return EXIT_FAILURE;
+}
@@ -0,0 +1,109 @@
+// simd_convert_test.cpp: Test the vectorized posit conversions lane by lane against the scalar library
+//
+// Copyright (C) 2017 Stillwater Supercomputing, Inc.
+//
+// This file is part of the universal numbers project, which is released under an MIT Open Source license.
+
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <posit>
+
+#include "../../utilities/simd_convert.hpp"
+
+using namespace std;
+
+// all encodings for nbits <= 16, random ones above, each with both neighbouring doubles;
+// random magnitudes over the whole double range; the special values
+template <size_t Nbits, size_t ES>
+vector<double> TestInputs()
+{
+    using codec = posit_codec<Nbits, ES>;
+    mt19937_64 eng(Nbits * 16 + ES);
+    vector<double> in;
+    const uint64_t nrOfPatterns = Nbits <= 16 ? (uint64_t(1) << Nbits) : 50000;
+    for (uint64_t i = 0; i < nrOfPatterns; ++i) {
+        double d = codec::decode(typename codec::raw_type(Nbits <= 16 ? i : eng() & codec::mask));
+        in.push_back(d);
+        in.push_back(nextafter(d, numeric_limits<double>::max()));
+        in.push_back(nextafter(d, -numeric_limits<double>::max()));
+    }
+    uniform_real_distribution<double> scale(-1070.0, 1020.0);
+    for (int i = 0; i < 50000; ++i)
+        in.push_back((eng() & 1 ? -1.0 : 1.0) * exp2(scale(eng)));
+    for (double d : { 0.0, -0.0, 1.0, -1.0, numeric_limits<double>::infinity(), -numeric_limits<double>::infinity(),
+                      numeric_limits<double>::quiet_NaN(), numeric_limits<double>::denorm_min(), -numeric_limits<double>::denorm_min(),
+                      numeric_limits<double>::max(), -numeric_limits<double>::max() })
+        in.push_back(d);
+    return in;
+}
+
+template <size_t Nbits, size_t ES>
+int VerifyLevel(simd_level level)
+{
+    vector<double> in = TestInputs<Nbits, ES>();
+    conversion_check check = verify_simd_conversion<Nbits, ES>(in.data(), in.size(), level);
+    if (!check.ok()) {
+        cerr << "FAIL: posit<" << Nbits << "," << ES << "> " << to_string(level) << ": " << check.encode_mismatches
+             << " encode and " << check.decode_mismatches << " decode mismatches in " << check.lanes
+             << " lanes, first for " << in[check.first_mismatch] << '\n';
+        return 1;
+    }
+    return 0;
+}
+
+// run-time width selection, float data, and the scalar posit<64,3> path
+int VerifyStandardVariant()
+{
+    int nrOfFailedTestCases = 0;
+    vector<float> in = { 0.0f, 1.0f, -2.5f, 3.0e-5f, 1.0e30f, -7.0f, 0.1f, 65504.0f, -1.0e-30f };
+    vector<float> out(in.size());
+    for (size_t nbits : { 8, 16, 32, 64 }) {
+        vector<uint64_t> raw(in.size());
+        simd_encode(in.data(), in.size(), raw.data(), standard_select(nbits));
+        simd_decode(raw.data(), in.size(), out.data(), standard_select(nbits));
+        for (size_t i = 0; i < in.size(); ++i) {
+            double expected = 0.0;
+            switch (nbits) {
+                case 8:  expected = double(sw::unum::posit<8, 0>(double(in[i]))); break;
+                case 16: expected = double(sw::unum::posit<16, 1>(double(in[i]))); break;
+                case 32: expected = double(sw::unum::posit<32, 2>(double(in[i]))); break;
+                case 64: expected = double(sw::unum::posit<64, 3>(double(in[i]))); break;
+            }
+            if (out[i] != float(expected)) {
+                cerr << "FAIL: standard posit of " << nbits << " bits round-trips " << in[i] << " to " << out[i] << '\n';
+                ++nrOfFailedTestCases;
+            }
+        }
+    }
+    return nrOfFailedTestCases;
+}
+
+int main()
+try {
+    cout << "This is the SIMD conversion test.\n";
+    cout << "detected instruction set: " << to_string(detect_simd_level()) << '\n';
+
+    int nrOfFailedTestCases = 0;
+    for (simd_level level : { simd_level::scalar, simd_level::avx2, simd_level::avx512 }) {
+        if (level > detect_simd_level())
+            continue;
+        nrOfFailedTestCases += VerifyLevel<8, 0>(level);
+        nrOfFailedTestCases += VerifyLevel<16, 1>(level);
+        nrOfFailedTestCases += VerifyLevel<32, 2>(level);
+        nrOfFailedTestCases += VerifyLevel<12, 1>(level);
+        nrOfFailedTestCases += VerifyLevel<24, 5>(level);
+    }
+    nrOfFailedTestCases += VerifyStandardVariant();
+
+	return (nrOfFailedTestCases > 0 ? EXIT_FAILURE : EXIT_SUCCESS);
+}
+catch (char* msg) {
+	cerr << msg << endl;
+	return EXIT_FAILURE;
+}
@@ -0,0 +1,153 @@
+// sweep_test.cpp: Test the concurrent sweep over the posit configurations
+//
+// Copyright (C) 2017 Stillwater Supercomputing, Inc.
+//
+// This file is part of the universal numbers project, which is released under an MIT Open Source license.
+
+#include <cstddef>
+#include <iostream>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+
+#include "../../utilities/sweep.hpp"
+
+using namespace std;
+
+// encodes the configuration in the result, so a row can be matched to the instantiation that produced it
+struct identity_visitor
+{
+    template <size_t Nbits, size_t ES>
+    pair<size_t, size_t> operator()() const
+    {
+        if (Nbits == throw_nbits)
+            throw runtime_error("no posit<" + to_string(Nbits) + "," + to_string(ES) + ">");
+        return make_pair(Nbits, ES);
+    }
+
+    size_t throw_nbits;
+};
+
+// posit<8,*> sleeps longer than all narrower configurations together, so the schedule shows in the wall time
+struct sleepy_visitor
+{
+    template <size_t Nbits, size_t ES>
+    int operator()() const
+    {
+        this_thread::sleep_for(chrono::milliseconds(Nbits == 8 ? 40 : 5));
+        return 0;
+    }
+};
+
+int VerifyCoverage(unsigned nrOfThreads)
+{
+    int nrOfFailedTestCases = 0;
+    sweep_options options;
+    options.nrOfThreads = nrOfThreads;
+    auto table = sweep(identity_visitor{ 0 }, options);
+
+    size_t expected = 0;
+    for (size_t nbits = dispatch_min_nbits; nbits <= dispatch_max_nbits; ++nbits)
+        for (size_t es = 0; es <= dispatch_max_es; ++es)
+            expected += valid_posit_configuration(nbits, es);
+    if (table.rows.size() != expected) {
+        cerr << "FAIL: " << table.rows.size() << " rows instead of " << expected << '\n';
+        ++nrOfFailedTestCases;
+    }
+    for (size_t i = 0; i < table.rows.size(); ++i) {
+        const auto& row = table.rows[i];
+        bool ordered = i == 0 || make_pair(table.rows[i - 1].nbits, table.rows[i - 1].es) < make_pair(row.nbits, row.es);
+        if (!row.ok || row.result != make_pair(row.nbits, row.es) || !ordered || row.worker >= table.nrOfThreads) {
+            cerr << "FAIL: row " << i << " posit<" << row.nbits << "," << row.es << "> holds the result of posit<"
+                 << row.result.first << "," << row.result.second << ">\n";
+            ++nrOfFailedTestCases;
+        }
+    }
+    return nrOfFailedTestCases;
+}
+
+int VerifyFilter()
+{
+    int nrOfFailedTestCases = 0;
+    sweep_options options;
+    options.min_nbits = 8;
+    options.max_nbits = 12;
+    options.max_es = 2;
+    options.filter = [](size_t nbits, size_t) { return nbits % 2 == 0; };
+    auto table = sweep(identity_visitor{ 0 }, options);
+    if (table.rows.size() != 9) {
+        cerr << "FAIL: filtered sweep has " << table.rows.size() << " rows instead of 9\n";
+        ++nrOfFailedTestCases;
+    }
+    for (const auto& row : table.rows) {
+        if (row.nbits % 2 != 0 || row.nbits < 8 || row.nbits > 12 || row.es > 2) {
+            cerr << "FAIL: filtered sweep visited posit<" << row.nbits << "," << row.es << ">\n";
+            ++nrOfFailedTestCases;
+        }
+    }
+    return nrOfFailedTestCases;
+}
+
+// a throwing configuration fails its own row only
+int VerifyExceptions()
+{
+    int nrOfFailedTestCases = 0;
+    sweep_options options;
+    options.nrOfThreads = 4;
+    auto table = sweep(identity_visitor{ 5 }, options);
+    for (const auto& row : table.rows) {
+        if (row.ok == (row.nbits == 5) || (!row.ok && row.error.find("posit<5,") == string::npos)) {
+            cerr << "FAIL: posit<" << row.nbits << "," << row.es << "> ok " << row.ok << " error '" << row.error << "'\n";
+            ++nrOfFailedTestCases;
+        }
+    }
+    return nrOfFailedTestCases;
+}
+
+// With two workers, the heaviest-first schedule finishes in about the time of the heavy configuration;
+// handing it out last adds the time the light ones take to drain ahead of it.
+int VerifySchedule()
+{
+    int nrOfFailedTestCases = 0;
+    sweep_options options;
+    options.max_nbits = 8;
+    options.nrOfThreads = 2;
+    options.filter = [](size_t, size_t es) { return es == 0; };     // posit<3..8,0>
+    options.cost = [](size_t nbits, size_t) { return double(nbits); };
+    sweep_options reversed = options;
+    reversed.cost = [](size_t nbits, size_t) { return -double(nbits); };
+
+    auto lpt = sweep(sleepy_visitor{}, options);
+    auto spt = sweep(sleepy_visitor{}, reversed);
+    if (lpt.rows[5].worker == lpt.rows[4].worker) {
+        cerr << "FAIL: the two heaviest configurations ran on the same worker\n";
+        ++nrOfFailedTestCases;
+    }
+    if (lpt.wall_seconds > spt.wall_seconds) {
+        cerr << "FAIL: heaviest first took " << lpt.wall_seconds << " s, lightest first " << spt.wall_seconds << " s\n";
+        ++nrOfFailedTestCases;
+    }
+    if (lpt.efficiency() <= 0.0 || lpt.efficiency() > 1.01) {
+        cerr << "FAIL: efficiency " << lpt.efficiency() << '\n';
+        ++nrOfFailedTestCases;
+    }
+    return nrOfFailedTestCases;
+}
+
+int main()
+try {
+    cout << "This is the configuration sweep test.\n";
+
+    int nrOfFailedTestCases = 0;
+    for (unsigned threads : { 1u, 3u, 0u })
+        nrOfFailedTestCases += VerifyCoverage(threads);
+    nrOfFailedTestCases += VerifyFilter();
+    nrOfFailedTestCases += VerifyExceptions();
+    nrOfFailedTestCases += VerifySchedule();
+
+	return (nrOfFailedTestCases > 0 ? EXIT_FAILURE : EXIT_SUCCESS);
+}
+catch (char* msg) {
+	cerr << msg << endl;
+	return EXIT_FAILURE;
+}
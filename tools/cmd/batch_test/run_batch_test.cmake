@@ -0,0 +1,22 @@
+# run_batch_test.cmake: run cmd_posit --batch on INPUT and compare its output with EXPECTED exactly
+#   cmake -DPROGRAM=cmd_posit -DARGS="nbits es [options]" -DINPUT=file -DOUTPUT=file -DEXPECTED=file -P run_batch_test.cmake
+# An EXPECTED file named *.raw.hex holds the bytes of the raw output as hex digits.
+separate_arguments(args UNIX_COMMAND "${ARGS}")
+execute_process(COMMAND ${PROGRAM} --batch ${args} INPUT_FILE ${INPUT} OUTPUT_FILE ${OUTPUT} RESULT_VARIABLE status)
+if (NOT status EQUAL 0)
+    message(FATAL_ERROR "cmd_posit --batch ${ARGS} exited with ${status}")
+endif()
+
+file(READ ${EXPECTED} expected)
+if (EXPECTED MATCHES "\\.raw\\.hex$")
+    file(READ ${OUTPUT} actual HEX)
+    string(STRIP "${expected}" expected)
+else()
+    # text output is compared line by line, whatever the line ending of the platform
+    file(READ ${OUTPUT} actual)
+    string(REPLACE "\r\n" "\n" actual "${actual}")
+    string(REPLACE "\r\n" "\n" expected "${expected}")
+endif()
+if (NOT actual STREQUAL expected)
+    message(FATAL_ERROR "cmd_posit --batch ${ARGS}: output differs from ${EXPECTED}\n${actual}")
+endif()
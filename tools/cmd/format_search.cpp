@@ -0,0 +1,197 @@
+// format_search.cpp: find the narrowest posit format that runs a dot or gemm workload within an error bound
+//
+// Copyright (C) 2017 Stillwater Supercomputing, Inc.
+//
+// This file is part of the universal numbers project, which is released under an MIT Open Source license.
+
+#include "common.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+#include <posit>
+
+#include "../../utilities/batch_convert.hpp"
+#include "../../utilities/format_search.hpp"
+#include "../../kernels/fused_dot.hpp"
+#include "../../kernels/fused_gemm.hpp"
+
+// Relative error of a quire dot product of the sample vectors, inputs rounded to the format,
+// against a compensated long double sum of the exact double products.
+struct dot_workload
+{
+    template <std::size_t Nbits, std::size_t ES>
+    double operator()() const
+    {
+        const std::size_t n = x.size();
+        std::vector<posit_storage_t<Nbits> > px(n), py(n);
+        convert_to_posit<Nbits, ES>(x.data(), n, px.data());
+        convert_to_posit<Nbits, ES>(y.data(), n, py.data());
+        const double result = double(fused_dot<Nbits, ES>(px.data(), py.data(), n));
+        return reference == 0 ? std::fabs(result) : double(std::fabs((result - reference) / reference));
+    }
+
+    dot_workload(std::vector<double> xs, std::vector<double> ys) : x(std::move(xs)), y(std::move(ys))
+    {
+        long double sum = 0, c = 0;
+        for (std::size_t i = 0; i < x.size(); ++i) {
+            long double p = (long double)x[i] * y[i], t = sum + p;
+            c += std::fabs(sum) >= std::fabs(p) ? (sum - t) + p : (p - t) + sum;
+            sum = t;
+        }
+        reference = sum + c;
+    }
+
+    std::vector<double> x, y;
+    long double reference;
+};
+
+// Normwise relative error ||C - Cref||_F / ||Cref||_F of an n x n quire gemm, Cref computed in long double.
+struct gemm_workload
+{
+    template <std::size_t Nbits, std::size_t ES>
+    double operator()() const
+    {
+        const std::size_t nn = n * n;
+        std::vector<posit_storage_t<Nbits> > pa(nn), pb(nn), pc(nn);
+        convert_to_posit<Nbits, ES>(a.data(), nn, pa.data());
+        convert_to_posit<Nbits, ES>(b.data(), nn, pb.data());
+        fused_gemm<Nbits, ES>(pa.data(), pb.data(), pc.data(), n, n, n, 1);   // the search runs formats in parallel
+        std::vector<double> c(nn);
+        convert_from_posit<Nbits, ES>(pc.data(), nn, c.data());
+        long double diff = 0, norm = 0;
+        for (std::size_t i = 0; i < nn; ++i) {
+            diff += (c[i] - reference[i]) * (c[i] - reference[i]);
+            norm += reference[i] * reference[i];
+        }
+        return norm == 0 ? double(std::sqrt(diff)) : double(std::sqrt(diff / norm));
+    }
+
+    gemm_workload(std::size_t dim, std::vector<double> as, std::vector<double> bs) : n(dim), a(std::move(as)), b(std::move(bs)), reference(n * n)
+    {
+        for (std::size_t i = 0; i < n; ++i)
+            for (std::size_t j = 0; j < n; ++j) {
+                long double sum = 0;
+                for (std::size_t p = 0; p < n; ++p)
+                    sum += (long double)a[i * n + p] * b[p * n + j];
+                reference[i * n + j] = sum;
+            }
+    }
+
+    std::size_t n;
+    std::vector<double> a, b;
+    std::vector<long double> reference;
+};
+
+std::vector<double> ReadSamples(const std::string& file)
+{
+    std::ifstream istr(file);
+    if (!istr)
+        throw std::runtime_error("unable to open " + file);
+    std::vector<double> samples;
+    for (double v; istr >> v;)
+        samples.push_back(v);
+    return samples;
+}
+
+std::vector<double> RandomSamples(std::size_t n, double log2_range, std::uint64_t seed)
+{
+    std::mt19937_64 eng(seed);
+    std::uniform_real_distribution<double> scale(-log2_range / 2, log2_range / 2);
+    std::vector<double> samples(n);
+    for (auto& v : samples)
+        v = (eng() & 1 ? -1.0 : 1.0) * std::exp2(scale(eng));
+    return samples;
+}
+
+void Report(const format_search_result& result, const format_search_options& options)
+{
+    using namespace std;
+    vector<format_measurement> evaluated = result.evaluated;
+    sort(evaluated.begin(), evaluated.end(), [](const format_measurement& a, const format_measurement& b) {
+        return a.es != b.es ? a.es < b.es : a.nbits < b.nbits;
+    });
+    cout << setw(14) << "format" << setw(14) << "error" << setw(14) << "seconds" << setw(10) << "within" << '\n';
+    for (const auto& m : evaluated)
+        cout << setw(14) << ("posit<" + to_string(m.nbits) + "," + to_string(m.es) + ">") << scientific << setprecision(3)
+             << setw(14) << m.error << setw(14) << m.seconds << setw(10) << (m.feasible ? "yes" : "no") << '\n';
+
+    size_t valid = 0;
+    for (size_t nbits = options.min_nbits; nbits <= options.max_nbits; ++nbits)
+        for (size_t es = 0; es <= options.max_es; ++es)
+            valid += valid_posit_configuration(nbits, es);
+    cout << "measured " << evaluated.size() << " of " << valid << " formats\n";
+    if (!result.found) {
+        cout << "no format meets the error bound " << options.error_bound << '\n';
+        return;
+    }
+    cout << "smallest: posit<" << result.smallest.nbits << "," << result.smallest.es << "> error " << result.smallest.error << '\n';
+    cout << "fastest:  posit<" << result.fastest.nbits << "," << result.fastest.es << "> error " << result.fastest.error
+         << " in " << result.fastest.seconds << " s\n";
+}
+
+// Usage: format_search [dot|gemm] [--bound e] [--n N] [--range log2] [--seed S] [--input file] [--threads T]
+//                      [--min-nbits n] [--max-nbits n] [--max-es e]
+//   dot    relative error of the dot product of two vectors of N samples (default)
+//   gemm   normwise relative error of the product of two N x N matrices
+//   --range     the random samples span 2^-range/2 .. 2^range/2 in magnitude (default 16)
+//   --input     whitespace separated samples instead of random ones: x then y, or A then B row-major
+int main(int argc, char** argv)
+try {
+    using namespace std;
+
+    string workload = "dot", input;
+    format_search_options options;
+    size_t n = 0;
+    double range = 16.0;
+    uint64_t seed = 0x5eed;
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        if (arg == "dot" || arg == "gemm") workload = arg;
+        else if (arg == "--bound" && i + 1 < argc) options.error_bound = stod(argv[++i]);
+        else if (arg == "--n" && i + 1 < argc) n = size_t(stoull(argv[++i]));
+        else if (arg == "--range" && i + 1 < argc) range = stod(argv[++i]);
+        else if (arg == "--seed" && i + 1 < argc) seed = stoull(argv[++i], nullptr, 0);
+        else if (arg == "--input" && i + 1 < argc) input = argv[++i];
+        else if (arg == "--threads" && i + 1 < argc) options.nrOfThreads = unsigned(stoul(argv[++i]));
+        else if (arg == "--min-nbits" && i + 1 < argc) options.min_nbits = size_t(stoull(argv[++i]));
+        else if (arg == "--max-nbits" && i + 1 < argc) options.max_nbits = size_t(stoull(argv[++i]));
+        else if (arg == "--max-es" && i + 1 < argc) options.max_es = size_t(stoull(argv[++i]));
+        else {
+            cerr << "Usage: format_search [dot|gemm] [--bound e] [--n N] [--range log2] [--seed S] [--input file] [--threads T]\n"
+                    "                     [--min-nbits n] [--max-nbits n] [--max-es e]\n";
+            return EXIT_FAILURE;
+        }
+    }
+    options.min_nbits = max(options.min_nbits, dispatch_min_nbits);
+    options.max_nbits = min(options.max_nbits, dispatch_max_nbits);
+    options.max_es = min(options.max_es, dispatch_max_es);
+
+    format_search_result result;
+    if (workload == "dot") {
+        vector<double> samples = input.empty() ? RandomSamples(2 * (n ? n : 1000), range, seed) : ReadSamples(input);
+        const size_t half = samples.size() / 2;
+        cout << "minimum precision search for a dot product of length " << half << ", error bound " << options.error_bound << '\n';
+        dot_workload dot(vector<double>(samples.begin(), samples.begin() + half), vector<double>(samples.begin() + half, samples.begin() + 2 * half));
+        result = minimum_precision_search(dot, options);
+    }
+    else {
+        if (n == 0)
+            n = input.empty() ? 32 : size_t(sqrt(ReadSamples(input).size() / 2.0));
+        vector<double> samples = input.empty() ? RandomSamples(2 * n * n, range, seed) : ReadSamples(input);
+        if (samples.size() < 2 * n * n)
+            throw runtime_error("gemm needs 2 N^2 samples");
+        cout << "minimum precision search for a " << n << " x " << n << " gemm, error bound " << options.error_bound << '\n';
+        gemm_workload gemm(n, vector<double>(samples.begin(), samples.begin() + n * n), vector<double>(samples.begin() + n * n, samples.begin() + 2 * n * n));
+        result = minimum_precision_search(gemm, options);
+    }
+    Report(result, options);
+    return EXIT_SUCCESS;
+}
+catch (std::exception& err) {
+    std::cerr << err.what() << std::endl;
+    return EXIT_FAILURE;
+}
@@ -6,13 +6,26 @@
 
 #include "common.hpp"
 
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#endif
+
 #include <posit>
 
 #include <boost/variant.hpp>
 
 #include "../../utilities/es_select.hpp"
 #include "../../utilities/nbits_select.hpp"
-#include "../../utilities/nested_apply_visitor.hpp"
+#include "../../utilities/dispatch_table.hpp"
+#include "../../lib/ef_kernels.h"
 
 
 struct print_es_variant 
@@ -64,20 +77,12 @@ struct posit_test1
 
 };
 
-double _global_value_to_assign = 0.0;
-
 struct posit_dispatcher
 {
-	posit_dispatcher() : _value(_global_value_to_assign) {}
-
+    // the dispatch table never instantiates configurations with es+2 > nbits
     template <std::size_t nbits, std::size_t es>
     void operator()() const
     {
-        if (es+2 > nbits) {
-            std::cerr << "Size of posit defined by nbits must be larger than es+2.\n";
-            throw "Invalid posit configuration";
-        }
-            
 		// from namespace sw::unum::
         sw::unum::posit<nbits, es> p(_value);
 		std::cout << spec_to_string(p) << std::endl;
@@ -87,15 +92,303 @@ struct posit_dispatcher
 	double _value;
 };
 
+////////////////////////////////// BATCH MODE //////////////////////////////////
+// posit --batch nbits es reads a stream of doubles and converts it a chunk at a time,
+// with one dispatch per chunk instead of one process per value.
+
+enum class batch_output { raw, hex, decoded };
+
+// Converts whole chunks with one call into the prebuilt kernel library: all formats of the
+// dispatch range, and posit<32,2> and <64,3>. The batch path instantiates no conversion templates.
+class chunk_converter
+{
+  public:
+    chunk_converter(std::size_t nbits, std::size_t es) : nbits_(nbits), kernels_(ef_kernels_lookup(unsigned(nbits), unsigned(es)))
+    {
+        if (kernels_ == nullptr) {
+            if (nbits > dispatch_max_nbits)
+                throw std::invalid_argument("posit<" + std::to_string(nbits) + "," + std::to_string(es) + ">: formats wider than "
+                                            + std::to_string(dispatch_max_nbits) + " bits must be posit<32,2> or posit<64,3>");
+            throw std::invalid_argument("posit<" + std::to_string(nbits) + "," + std::to_string(es) + ">: nbits must be at least es+2");
+        }
+    }
+
+    std::size_t nbits() const { return nbits_; }
+    std::size_t bytes() const { return kernels_->elem_bytes; }
+
+    void encode(const double* in, std::size_t n, void* out) const { check(kernels_->encode(in, n, out)); }
+    void decode(const void* in, std::size_t n, double* out) const { check(kernels_->decode(in, n, out)); }
+
+  private:
+    static void check(int status)
+    {
+        if (status != EF_KERNELS_OK)
+            throw std::runtime_error("posit kernel library: conversion failed");
+    }
+
+    std::size_t nbits_;
+    const ef_kernels* kernels_;
+};
+
+// Whitespace separated decimal numbers as understood by strtod, plus nar for NaR.
+// The input is read in large blocks; a number that straddles two blocks is moved to the front first.
+class decimal_reader
+{
+  public:
+    explicit decimal_reader(std::FILE* f, std::size_t block = std::size_t(1) << 20) : f_(f), buffer_(block + 1) {}
+
+    // read up to n values, returns fewer only at the end of the input
+    std::size_t read(double* out, std::size_t n)
+    {
+        std::size_t count = 0;
+        while (count < n) {
+            while (begin_ < end_ && is_space(buffer_[begin_]))
+                ++begin_;
+            std::size_t last = begin_;
+            while (last < end_ && !is_space(buffer_[last]))
+                ++last;
+            if (last == end_ && !eof_) {
+                if (begin_ == 0 && end_ == buffer_.size() - 1)
+                    throw std::runtime_error("decimal input: token longer than the read buffer");
+                refill();
+                continue;
+            }
+            if (begin_ == end_)
+                break;
+            out[count++] = parse(begin_, last);
+            begin_ = last;
+        }
+        return count;
+    }
+
+  private:
+    static bool is_space(char c) { return c == ' ' || c == '\n' || c == '\t' || c == '\r' || c == ',' || c == ';'; }
+
+    void refill()
+    {
+        std::memmove(buffer_.data(), buffer_.data() + begin_, end_ - begin_);
+        end_ -= begin_;
+        begin_ = 0;
+        const std::size_t got = std::fread(buffer_.data() + end_, 1, buffer_.size() - 1 - end_, f_);
+        if (got == 0)
+            eof_ = true;
+        end_ += got;
+        buffer_[end_] = '\0';     // strtod stops at the terminator after the last token
+    }
+
+    double parse(std::size_t first, std::size_t last) const
+    {
+        const char* token = buffer_.data() + first;
+        char* stop = nullptr;
+        double v = std::strtod(token, &stop);
+        if (stop == buffer_.data() + last)
+            return v;
+        const std::string word(token, last - first);
+        if (word == "nar" || word == "NaR" || word == "NAR")
+            return std::numeric_limits<double>::quiet_NaN();
+        throw std::runtime_error("decimal input: '" + word + "' is not a number");
+    }
+
+    std::FILE* f_;
+    std::vector<char> buffer_;
+    std::size_t begin_ = 0, end_ = 0;
+    bool eof_ = false;
+};
+
+// native doubles, as written by fwrite or numpy's tofile
+class binary_reader
+{
+  public:
+    explicit binary_reader(std::FILE* f) : f_(f) {}
+
+    std::size_t read(double* out, std::size_t n)
+    {
+        std::size_t got = std::fread(out, sizeof(double), n, f_);
+        if (got < n && std::ferror(f_))
+            throw std::runtime_error("binary input: read error");
+        return got;
+    }
+
+  private:
+    std::FILE* f_;
+};
+
+inline std::uint64_t load_encoding(const unsigned char* raw, std::size_t bytes, std::size_t i)
+{
+    switch (bytes) {
+        case 1:  return raw[i];
+        case 2:  { std::uint16_t v; std::memcpy(&v, raw + 2 * i, 2); return v; }
+        case 4:  { std::uint32_t v; std::memcpy(&v, raw + 4 * i, 4); return v; }
+        default: { std::uint64_t v; std::memcpy(&v, raw + 8 * i, 8); return v; }
+    }
+}
+
+inline void store_little_endian(unsigned char* out, std::uint64_t v, std::size_t bytes)
+{
+    for (std::size_t b = 0; b < bytes; ++b)
+        out[b] = static_cast<unsigned char>(v >> (8 * b));
+}
+
+inline bool host_is_little_endian()
+{
+    const std::uint16_t probe = 1;
+    unsigned char low;
+    std::memcpy(&low, &probe, 1);
+    return low == 1;
+}
+
+// Format a chunk of encodings into text and hand it to stdio in one write.
+class chunk_writer
+{
+  public:
+    chunk_writer(std::FILE* f, const chunk_converter& converter, batch_output format) : f_(f), converter_(converter), format_(format) {}
+
+    void write(const unsigned char* raw, std::size_t n)
+    {
+        const std::size_t bytes = converter_.bytes();
+        text_.clear();
+        if (format_ == batch_output::raw) {
+            // the kernels store host-order integers, the raw output is little-endian on every host
+            if (host_is_little_endian()) {
+                put(raw, n * bytes);
+                return;
+            }
+            text_.resize(n * bytes);
+            for (std::size_t i = 0; i < n; ++i)
+                store_little_endian(reinterpret_cast<unsigned char*>(text_.data()) + i * bytes, load_encoding(raw, bytes, i), bytes);
+        }
+        else if (format_ == batch_output::hex) {
+            static const char digits[] = "0123456789abcdef";
+            const std::size_t width = (converter_.nbits() + 3) / 4;
+            for (std::size_t i = 0; i < n; ++i) {
+                const std::uint64_t v = load_encoding(raw, bytes, i);
+                for (std::size_t d = width; d-- > 0;)
+                    text_.push_back(digits[(v >> (4 * d)) & 0xF]);
+                text_.push_back('\n');
+            }
+        }
+        else {
+            decoded_.resize(n);
+            converter_.decode(raw, n, decoded_.data());
+            char number[32];
+            for (std::size_t i = 0; i < n; ++i) {
+                // 17 significant digits read back as the same double
+                int len = std::isnan(decoded_[i]) ? std::snprintf(number, sizeof(number), "nar") : std::snprintf(number, sizeof(number), "%.17g", decoded_[i]);
+                text_.insert(text_.end(), number, number + len);
+                text_.push_back('\n');
+            }
+        }
+        put(text_.data(), text_.size());
+    }
+
+  private:
+    void put(const void* data, std::size_t size)
+    {
+        if (std::fwrite(data, 1, size, f_) != size)
+            throw std::runtime_error("output: write error");
+    }
+
+    std::FILE* f_;
+    const chunk_converter& converter_;
+    batch_output format_;
+    std::vector<char> text_;
+    std::vector<double> decoded_;
+};
+
+template <typename Reader>
+std::size_t convert_stream(Reader& reader, const chunk_converter& converter, chunk_writer& writer, std::size_t chunk)
+{
+    std::vector<double> values(chunk);
+    std::vector<unsigned char> raw(chunk * converter.bytes());
+    std::size_t total = 0;
+    for (std::size_t n; (n = reader.read(values.data(), chunk)) > 0; total += n) {
+        converter.encode(values.data(), n, raw.data());
+        writer.write(raw.data(), n);
+    }
+    return total;
+}
+
+const char* batch_usage = "Usage: posit --batch nbits es [--input file] [--binary] [--output raw|hex|decoded] [--chunk N] [--block N]\n"
+                          "  reads whitespace separated decimal doubles, or native binary doubles with --binary, from the file or stdin,\n"
+                          "  and writes the nbits encodings as packed little-endian integers (raw), one hex encoding per line (hex, default),\n"
+                          "  or one rounded value per line (decoded); --chunk sets the values converted per call (default 65536),\n"
+                          "  --block the bytes of decimal input read at a time (default 1 MiB, longer than any number)\n";
+
+int run_batch(int argc, char** argv)
+{
+    using namespace std;
+
+    if (argc < 2) {
+        cerr << batch_usage;
+        return EXIT_FAILURE;
+    }
+    chunk_converter converter(size_t(stoull(argv[0])), size_t(stoull(argv[1])));
+    string input = "-";
+    bool binary = false;
+    batch_output format = batch_output::hex;
+    size_t chunk = size_t(1) << 16;
+    size_t block = size_t(1) << 20;
+    for (int i = 2; i < argc; ++i) {
+        string arg = argv[i];
+        if (arg == "--input" && i + 1 < argc) input = argv[++i];
+        else if (arg == "--binary") binary = true;
+        else if (arg == "--output" && i + 1 < argc) {
+            string f = argv[++i];
+            if (f == "raw") format = batch_output::raw;
+            else if (f == "hex") format = batch_output::hex;
+            else if (f == "decoded") format = batch_output::decoded;
+            else { cerr << batch_usage; return EXIT_FAILURE; }
+        }
+        else if (arg == "--chunk" && i + 1 < argc) chunk = max<size_t>(1, size_t(stoull(argv[++i])));
+        else if (arg == "--block" && i + 1 < argc) block = max<size_t>(1, size_t(stoull(argv[++i])));
+        else {
+            cerr << batch_usage;
+            return EXIT_FAILURE;
+        }
+    }
+
+    FILE* in = stdin;
+    if (input != "-") {
+        in = fopen(input.c_str(), binary ? "rb" : "r");
+        if (in == nullptr) {
+            cerr << "cannot open " << input << '\n';
+            return EXIT_FAILURE;
+        }
+    }
+#ifdef _WIN32
+    if (in == stdin && binary) _setmode(_fileno(stdin), _O_BINARY);
+    if (format == batch_output::raw) _setmode(_fileno(stdout), _O_BINARY);
+#endif
+    static char output_buffer[1 << 20];
+    setvbuf(stdout, output_buffer, _IOFBF, sizeof(output_buffer));
+
+    chunk_writer writer(stdout, converter, format);
+    if (binary) {
+        binary_reader reader(in);
+        convert_stream(reader, converter, writer, chunk);
+    }
+    else {
+        decimal_reader reader(in, block);
+        convert_stream(reader, converter, writer, chunk);
+    }
+    if (in != stdin)
+        fclose(in);
+    return fflush(stdout) == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
 int main(int argc, char** argv)
 try {
 	using namespace std;
 	using namespace sw::unum;
 
-	_global_value_to_assign = 1.0;
+	if (argc > 1 && string(argv[1]) == "--batch")
+		return run_batch(argc - 2, argv + 2);
+
 	int errorNr = 0;
 
     cout << "Usage: posit nbits es float-value\n";
+    if (argc < 4)
+        cout << batch_usage;
    
     nbits_variant nbitsv = nbits_tag<8>{};               // init to avoid trouble without cmd line args
     if (argc > 1)
@@ -108,19 +401,27 @@ try {
         esv = es_select(size_t(stoull(argv[2])));
     
     boost::apply_visitor(print_es_variant{}, esv);
-#if 0 
-	if (argc > 3)
-		_global_value_to_assign = stod(argv[3]);
 
-    
-    // And now it all boils down to this:
-	nested_apply_visitor(posit_dispatcher{}, nbitsv, esv);
-#endif
+	if (argc > 3) {
+		// And now it all boils down to this:
+		dispatch_status status = table_dispatch(posit_dispatcher{ stod(argv[3]) }, nbitsv, esv);
+		if (status != dispatch_status::ok) {
+			cerr << to_string(status) << endl;
+			cerr << batch_usage;
+			++errorNr;
+		}
+	}
 
 	return (errorNr > 0 ? EXIT_FAILURE : EXIT_SUCCESS);
 }
 catch (unsupported_nbits_variant& err) {
 	std::cerr << err.what() << std::endl;
+	std::cerr << batch_usage;
+	return EXIT_FAILURE;
+}
+catch (std::exception& err) {
+	std::cerr << err.what() << std::endl;
+	std::cerr << batch_usage;
 	return EXIT_FAILURE;
 }
 catch (...) {
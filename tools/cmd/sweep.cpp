@@ -0,0 +1,214 @@
+// sweep.cpp: characterize every posit configuration in one process, configurations run concurrently
+//
+// Copyright (C) 2017 Stillwater Supercomputing, Inc.
+//
+// This file is part of the universal numbers project, which is released under an MIT Open Source license.
+
+#include "common.hpp"
+
+#include <fstream>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+#include <posit>
+
+#include "../../utilities/batch_convert.hpp"
+#include "../../utilities/sweep.hpp"
+#include "../../kernels/fused_dot.hpp"
+
+// minpos, maxpos, and the distance from 1 to the next posit
+struct range_task
+{
+    template <std::size_t Nbits, std::size_t ES>
+    std::vector<double> operator()() const
+    {
+        const double minpos = double(sw::unum::minpos_value<Nbits, ES>());
+        const double maxpos = double(sw::unum::maxpos_value<Nbits, ES>());
+        sw::unum::posit<Nbits, ES> next(1.0);
+        ++next;
+        return { minpos, maxpos, double(next) - 1.0, std::log10(maxpos) - std::log10(minpos) };
+    }
+
+    static std::vector<std::string> columns() { return { "minpos", "maxpos", "epsilon", "decades" }; }
+    static double cost(std::size_t nbits, std::size_t) { return double(nbits); }
+};
+
+// all operand pairs of one operator against the rounded double result
+struct verify_task
+{
+    template <std::size_t Nbits, std::size_t ES>
+    std::vector<double> operator()() const
+    {
+        using posit_type = sw::unum::posit<Nbits, ES>;
+        const std::uint64_t n = std::uint64_t(1) << Nbits;
+        std::vector<posit_storage_t<Nbits> > raw(n);
+        for (std::uint64_t i = 0; i < n; ++i)
+            raw[i] = posit_storage_t<Nbits>(i);
+        std::vector<double> values(n);
+        convert_from_posit<Nbits, ES>(raw.data(), n, values.data());
+
+        posit_type a, b, result, reference;
+        std::uint64_t failures = 0;
+        for (std::uint64_t i = 0; i < n; ++i) {
+            a.set_raw_bits(i);
+            for (std::uint64_t j = 0; j < n; ++j) {
+                b.set_raw_bits(j);
+                switch (op) {
+                    default:
+                    case '+': result = a + b; reference = values[i] + values[j]; break;
+                    case '-': result = a - b; reference = values[i] - values[j]; break;
+                    case '*': result = a * b; reference = values[i] * values[j]; break;
+                    case '/': result = a / b; reference = values[i] / values[j]; break;
+                }
+                failures += result != reference;
+            }
+        }
+        return { double(n * n), double(failures) };
+    }
+
+    static std::vector<std::string> columns() { return { "cases", "failures" }; }
+    static double cost(std::size_t nbits, std::size_t) { return double(std::uint64_t(1) << (2 * nbits)); }
+
+    char op;
+};
+
+// relative error of a quire dot product of random vectors, inputs rounded to the configuration
+struct dot_task
+{
+    template <std::size_t Nbits, std::size_t ES>
+    std::vector<double> operator()() const
+    {
+        const std::size_t n = x.size();
+        std::vector<posit_storage_t<Nbits> > px(n), py(n);
+        convert_to_posit<Nbits, ES>(x.data(), n, px.data());
+        convert_to_posit<Nbits, ES>(y.data(), n, py.data());
+        const double result = double(fused_dot<Nbits, ES>(px.data(), py.data(), n));
+        return { result, double(std::fabs((result - reference) / reference)) };
+    }
+
+    static std::vector<std::string> columns() { return { "dot", "rel.error" }; }
+    double cost(std::size_t nbits, std::size_t) const { return double(nbits) * x.size(); }
+
+    std::vector<double> x, y;
+    long double reference;
+};
+
+template <typename Task>
+int RunSweep(const Task& task, sweep_options options, const std::string& csv)
+{
+    using namespace std;
+    options.cost = [&task](size_t nbits, size_t es) { return task.cost(nbits, es); };
+    auto table = sweep(task, options);
+
+    const vector<string> columns = Task::columns();
+    cout << setw(14) << "config";
+    for (const auto& c : columns)
+        cout << setw(14) << c;
+    cout << setw(12) << "seconds" << setw(8) << "worker" << '\n';
+    int errors = 0;
+    for (const auto& row : table.rows) {
+        cout << setw(14) << ("posit<" + to_string(row.nbits) + "," + to_string(row.es) + ">");
+        if (row.ok) {
+            for (double v : row.result)
+                cout << setw(14) << setprecision(6) << defaultfloat << v;
+        }
+        else {
+            cout << "  " << row.error;
+            ++errors;
+        }
+        cout << setw(12) << fixed << setprecision(4) << row.seconds << setw(8) << row.worker << defaultfloat << '\n';
+    }
+    cout << table.rows.size() << " configurations in " << fixed << setprecision(3) << table.wall_seconds << " s on " << table.nrOfThreads
+         << " threads, " << setprecision(1) << 100.0 * table.efficiency() << "% busy\n" << defaultfloat;
+
+    if (!csv.empty()) {
+        ofstream ostr(csv);
+        ostr << "nbits,es";
+        for (const auto& c : columns)
+            ostr << ',' << c;
+        ostr << ",seconds\n" << setprecision(17);
+        for (const auto& row : table.rows) {
+            ostr << row.nbits << ',' << row.es;
+            for (double v : row.result)
+                ostr << ',' << v;
+            ostr << ',' << row.seconds << '\n';
+        }
+        if (!ostr)
+            throw runtime_error("unable to write " + csv);
+    }
+    return errors;
+}
+
+std::pair<std::size_t, std::size_t> ParseRange(const std::string& spec)
+{
+    std::size_t dash = spec.find('-');
+    if (dash == std::string::npos)
+        return { std::stoul(spec), std::stoul(spec) };
+    return { std::stoul(spec.substr(0, dash)), std::stoul(spec.substr(dash + 1)) };
+}
+
+// Usage: sweep [range | verify add|sub|mul|div | dot] [--nbits lo-hi] [--es lo-hi] [--threads N] [--n N] [--csv file]
+//   range    minpos, maxpos, epsilon, and dynamic range of every configuration (default)
+//   verify   all operand pairs of an operator; nbits defaults to 3-10 for this task
+//   dot      relative error of a quire dot product of --n random elements (default 10000)
+int main(int argc, char** argv)
+try {
+    using namespace std;
+
+    string task = "range", csv;
+    char op = '+';
+    sweep_options options;
+    size_t n = 10000;
+    bool nbitsGiven = false;
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        if (arg == "range" || arg == "dot") task = arg;
+        else if (arg == "verify" && i + 1 < argc) {
+            task = arg;
+            string o = argv[++i];
+            if (o == "add") op = '+';
+            else if (o == "sub") op = '-';
+            else if (o == "mul") op = '*';
+            else if (o == "div") op = '/';
+            else throw runtime_error("unknown operator " + o);
+        }
+        else if (arg == "--nbits" && i + 1 < argc) { tie(options.min_nbits, options.max_nbits) = ParseRange(argv[++i]); nbitsGiven = true; }
+        else if (arg == "--es" && i + 1 < argc) tie(options.min_es, options.max_es) = ParseRange(argv[++i]);
+        else if (arg == "--threads" && i + 1 < argc) options.nrOfThreads = unsigned(stoul(argv[++i]));
+        else if (arg == "--n" && i + 1 < argc) n = size_t(stoull(argv[++i]));
+        else if (arg == "--csv" && i + 1 < argc) csv = argv[++i];
+        else {
+            cerr << "Usage: sweep [range | verify add|sub|mul|div | dot] [--nbits lo-hi] [--es lo-hi] [--threads N] [--n N] [--csv file]\n";
+            return EXIT_FAILURE;
+        }
+    }
+
+    int errors = 0;
+    if (task == "range") {
+        errors = RunSweep(range_task{}, options, csv);
+    }
+    else if (task == "verify") {
+        if (!nbitsGiven)
+            options.max_nbits = 10;
+        errors = RunSweep(verify_task{ op }, options, csv);
+    }
+    else {
+        mt19937_64 eng(0x5eed);
+        uniform_real_distribution<double> scale(-8.0, 8.0);
+        dot_task dot{ vector<double>(n), vector<double>(n), 0 };
+        long double sum = 0;
+        for (size_t i = 0; i < n; ++i) {
+            dot.x[i] = (eng() & 1 ? -1.0 : 1.0) * exp2(scale(eng));
+            dot.y[i] = exp2(scale(eng));
+            sum += (long double)dot.x[i] * dot.y[i];
+        }
+        dot.reference = sum;
+        errors = RunSweep(dot, options, csv);
+    }
+    return errors > 0 ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+catch (std::exception& err) {
+    std::cerr << err.what() << std::endl;
+    return EXIT_FAILURE;
+}
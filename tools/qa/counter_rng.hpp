@@ -0,0 +1,58 @@
+#pragma once
+// counter_rng.hpp: counter-based random number generator for reproducible, shardable QA sweeps
+//
+// Copyright (C) 2017 Stillwater Supercomputing, Inc.
+//
+// This file is part of the universal numbers project, which is released under an MIT Open Source license.
+#include <cstdint>
+#include <array>
+#include <random>
+
+namespace sw {
+	namespace qa {
+
+		// Philox4x32-10 (Salmon et al., "Parallel Random Numbers: As Easy as 1, 2, 3", SC'11).
+		// The output is a pure function of (key, counter): there is no state to advance,
+		// so any sample of a sweep can be generated directly from its index.
+		class philox4x32 {
+		public:
+			typedef std::array<uint32_t, 4> counter_type;
+			typedef std::array<uint32_t, 2> key_type;
+
+			static counter_type generate(counter_type ctr, key_type key) {
+				for (int round = 0; round < 10; round++) {
+					if (round > 0) {
+						key[0] += 0x9E3779B9;
+						key[1] += 0xBB67AE85;
+					}
+					uint64_t p0 = uint64_t(0xD2511F53) * ctr[0];
+					uint64_t p1 = uint64_t(0xCD9E8D57) * ctr[2];
+					ctr = counter_type{ { uint32_t(p1 >> 32) ^ ctr[1] ^ key[0], uint32_t(p1),
+										  uint32_t(p0 >> 32) ^ ctr[3] ^ key[1], uint32_t(p0) } };
+				}
+				return ctr;
+			}
+		};
+
+		// 128 random bits for sample 'index' of 'stream' under 'seed'
+		class counter_rng {
+		public:
+			explicit counter_rng(uint64_t seed) : key{ { uint32_t(seed), uint32_t(seed >> 32) } } {}
+
+			std::array<uint64_t, 2> operator()(uint64_t index, uint32_t stream = 0) const {
+				philox4x32::counter_type c = philox4x32::generate({ { uint32_t(index), uint32_t(index >> 32), stream, 0 } }, key);
+				return { { (uint64_t(c[1]) << 32) | c[0], (uint64_t(c[3]) << 32) | c[2] } };
+			}
+
+		private:
+			philox4x32::key_type key;
+		};
+
+		// fresh seed for runs that do not specify one; report it so the run can be replayed
+		inline uint64_t EntropySeed() {
+			std::random_device rd;
+			return (uint64_t(rd()) << 32) | rd();
+		}
+
+	}; // namespace qa
+};  // namespace sw
@@ -0,0 +1,187 @@
+#pragma once
+// coverage_map.hpp: rounding coverage of the results of a QA sweep, to stop a sweep once it saturates
+//
+// Copyright (C) 2017 Stillwater Supercomputing, Inc.
+//
+// This file is part of the universal numbers project, which is released under an MIT Open Source license.
+#include <cstdint>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "stratified_sampler.hpp"
+
+namespace sw {
+	namespace qa {
+
+		// How the correctly rounded result of a case relates to the value it approximates. Down and up are
+		// toward and away from zero; the tie outcomes have the guard bit set and the sticky bit clear, the
+		// sticky outcomes have the sticky bit set, which puts the value below (down) or above (up) the midpoint.
+		constexpr unsigned NR_ROUNDING_OUTCOMES = 6;
+		enum RoundingOutcome { ROUND_EXACT = 0, ROUND_DOWN_STICKY = 1, ROUND_DOWN_TIE = 2, ROUND_UP_TIE = 3, ROUND_UP_STICKY = 4, ROUND_SATURATE = 5 };
+		constexpr const char* ROUNDING_OUTCOME_NAMES[NR_ROUNDING_OUTCOMES] = { "exact", "down", "down tie", "up tie", "up", "saturate" };
+
+		// A bitmap over the regime and exponent of the result and the rounding outcome of the cases of a sweep
+		// of one operation, plus a cell each for zero and NaR results. Workers cover their chunks concurrently;
+		// a cell that is already set costs a relaxed load, so the map stays out of the way once it fills up.
+		// With a saturation window of K chunks, the sweep is saturated once K chunks in a row covered no new cell.
+		class CoverageMap {
+		public:
+			struct CurvePoint {
+				uint64_t cases;      // cases run when the map reached this coverage
+				double seconds;
+				size_t covered;
+			};
+
+			CoverageMap(size_t nbits, size_t es, unsigned saturation_chunks = 0)
+				: nbits(nbits), es(es), saturation_chunks(saturation_chunks),
+				  cells((size_t(NrOfRegimes(nbits)) << es) * NR_ROUNDING_OUTCOMES + 2), words(new std::atomic<uint64_t>[(cells + 63) / 64]),
+				  covered(0), cases(0), stale_chunks(0), start(std::chrono::steady_clock::now()) {
+				for (size_t w = 0; w < (cells + 63) / 64; w++) words[w].store(0, std::memory_order_relaxed);
+			}
+
+			// Cover the cases of a chunk from their correctly rounded results and references; returns the cells they covered first.
+			template<typename Raw, typename Ty>
+			size_t Cover(const Raw* preference, const Ty* reference, size_t n) {
+				size_t fresh = 0;
+				for (size_t k = 0; k < n; k++) {
+					const size_t cell = Cell(uint64_t(preference[k]), reference[k]);
+					const uint64_t bit = uint64_t(1) << (cell % 64);
+					std::atomic<uint64_t>& word = words[cell / 64];
+					if ((word.load(std::memory_order_relaxed) & bit) == 0 && (word.fetch_or(bit, std::memory_order_relaxed) & bit) == 0) fresh++;
+				}
+				return fresh;
+			}
+
+			// Account for a finished chunk of n cases that covered fresh cells first; true when the sweep is saturated.
+			bool Advance(uint64_t n, size_t fresh) {
+				std::lock_guard<std::mutex> lock(mutex);
+				cases += n;
+				if (fresh > 0) {
+					covered += fresh;
+					stale_chunks = 0;
+					curve.push_back({ cases, Seconds(), covered });
+				}
+				else {
+					stale_chunks++;
+				}
+				return SaturatedLocked();
+			}
+
+			bool Saturated() const { std::lock_guard<std::mutex> lock(mutex); return SaturatedLocked(); }
+			size_t Cells() const { return cells; }
+			size_t Covered() const { std::lock_guard<std::mutex> lock(mutex); return covered; }
+			uint64_t Cases() const { std::lock_guard<std::mutex> lock(mutex); return cases; }
+
+			bool Test(size_t cell) const { return (words[cell / 64].load(std::memory_order_relaxed) >> (cell % 64)) & 1; }
+
+			// The cell of a case: the regime and exponent field of the rounded result and its rounding outcome.
+			template<typename Ty>
+			size_t Cell(uint64_t preference, Ty reference) const {
+				const uint64_t mask = LowMask(unsigned(nbits));
+				const uint64_t nar = uint64_t(1) << (nbits - 1);
+				preference &= mask;
+				if (preference == 0) return cells - 2;
+				if (preference == nar) return cells - 1;
+				const uint64_t magnitude = (preference & nar) ? (0 - preference) & mask : preference;
+				const Ty x = std::abs(reference);
+				const Ty value = Magnitude<Ty>(magnitude);
+				unsigned outcome = ROUND_EXACT;
+				if (x > value) {
+					// rounded down: the midpoint lies above the result, maxpos absorbs everything beyond it
+					if (magnitude == nar - 1) outcome = ROUND_SATURATE;
+					else outcome = x < Midpoint<Ty>(magnitude) ? ROUND_DOWN_STICKY : ROUND_DOWN_TIE;
+				}
+				else if (x < value) {
+					// rounded up: the midpoint lies below the result, minpos absorbs everything below it
+					if (magnitude == 1) outcome = ROUND_SATURATE;
+					else outcome = x == Midpoint<Ty>(magnitude - 1) ? ROUND_UP_TIE : ROUND_UP_STICKY;
+				}
+				OperandStratum s = {};
+				StratumOf(nbits, es, magnitude, s);
+				return ((size_t(s.k + int(nbits - 2)) << es) + s.exponent) * NR_ROUNDING_OUTCOMES + outcome;
+			}
+
+			// cells covered per rounding outcome, and the progress of the sweep
+			void Report(std::ostream& ostr, const std::string& label) const {
+				size_t per_outcome[NR_ROUNDING_OUTCOMES] = { 0 };
+				size_t regimes = 0;
+				for (size_t r = 0; r < NrOfRegimes(nbits); r++) {
+					bool regime_covered = false;
+					for (size_t e = 0; e < (size_t(1) << es); e++) {
+						for (unsigned o = 0; o < NR_ROUNDING_OUTCOMES; o++) {
+							if (!Test(((r << es) + e) * NR_ROUNDING_OUTCOMES + o)) continue;
+							per_outcome[o]++;
+							regime_covered = true;
+						}
+					}
+					if (regime_covered) regimes++;
+				}
+				std::lock_guard<std::mutex> lock(mutex);
+				ostr << "coverage of " << label << ": " << covered << " cells by " << cases << " cases in "
+				     << std::fixed << std::setprecision(3) << Seconds() << " s" << (SaturatedLocked() ? ", saturated" : "") << '\n';
+				ostr << "  result regimes    " << regimes << " of " << NrOfRegimes(nbits) << '\n';
+				ostr << "  rounding outcomes ";
+				for (unsigned o = 0; o < NR_ROUNDING_OUTCOMES; o++) ostr << ' ' << ROUNDING_OUTCOME_NAMES[o] << ' ' << per_outcome[o];
+				ostr << "\n  zero " << (Test(cells - 2) ? "covered" : "not covered") << ", NaR " << (Test(cells - 1) ? "covered" : "not covered") << '\n';
+				if (!curve.empty()) {
+					ostr << "  last new cell after " << curve.back().cases << " cases, " << curve.back().seconds << " s\n";
+				}
+			}
+
+			// the coverage curve as csv: one line per chunk that covered new cells
+			void WriteCurve(std::ostream& ostr) const {
+				std::lock_guard<std::mutex> lock(mutex);
+				ostr << "cases,seconds,covered\n";
+				for (auto& point : curve) ostr << point.cases << ',' << std::setprecision(6) << point.seconds << ',' << point.covered << '\n';
+			}
+
+		private:
+			bool SaturatedLocked() const { return saturation_chunks > 0 && stale_chunks >= saturation_chunks; }
+			double Seconds() const { return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count(); }
+
+			// value of a positive encoding
+			template<typename Ty>
+			Ty Magnitude(uint64_t magnitude) const {
+				OperandStratum s = {};
+				StratumOf(nbits, es, magnitude, s);
+				RegimeLayout layout = LayoutOfRegime(nbits, es, s.k);
+				const uint64_t fraction = magnitude & LowMask(layout.fraction_bits);
+				return std::ldexp(Ty((uint64_t(1) << layout.fraction_bits) + fraction), int(ScaleOfStratum(es, s, layout) - layout.fraction_bits));
+			}
+
+			// Value halfway between a positive encoding and the next one up, in the sense of posit rounding: the value of
+			// the encoding extended by a 1 bit. That bit is a fraction bit, worth half an ulp, unless the regime leaves
+			// no room for all exponent bits, in which case it is the next exponent bit.
+			template<typename Ty>
+			Ty Midpoint(uint64_t magnitude) const {
+				OperandStratum s = {};
+				StratumOf(nbits, es, magnitude, s);
+				RegimeLayout layout = LayoutOfRegime(nbits, es, s.k);
+				const int64_t scale = ScaleOfStratum(es, s, layout);
+				if (layout.exponent_bits < es) return std::ldexp(Ty(1), int(scale + (int64_t(1) << (es - layout.exponent_bits - 1))));
+				const uint64_t fraction = magnitude & LowMask(layout.fraction_bits);
+				return std::ldexp(Ty((uint64_t(1) << (layout.fraction_bits + 1)) + 2 * fraction + 1), int(scale - layout.fraction_bits - 1));
+			}
+
+			size_t nbits, es;
+			unsigned saturation_chunks;
+			size_t cells;
+			std::unique_ptr<std::atomic<uint64_t>[]> words;
+			mutable std::mutex mutex;
+			size_t covered;
+			uint64_t cases;
+			unsigned stale_chunks;
+			std::vector<CurvePoint> curve;
+			std::chrono::steady_clock::time_point start;
+		};
+
+	}; // namespace qa
+};  // namespace sw
@@ -0,0 +1,160 @@
+// exhaustive_binops.cpp: exhaustively verify the binary operators of small posit configurations
+//
+// Copyright (C) 2017 Stillwater Supercomputing, Inc.
+//
+// This file is part of the universal numbers project, which is released under an MIT Open Source license.
+
+#include "common.hpp"
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <posit>
+#include "../tests/posit_test_helpers.hpp"
+#include "qa_helpers.hpp"
+#include "../../utilities/dispatch_table.hpp"
+#include "../../utilities/work_stealing.hpp"
+
+using namespace std;
+
+// largest configuration whose 2^(2*nbits) state space we are prepared to enumerate
+constexpr size_t MAX_EXHAUSTIVE_NBITS = 14;
+
+struct VerificationResult {
+	size_t nbits, es;
+	int opcode;
+	uint64_t nrOfCases;
+	uint64_t nrOfFailures;
+	double seconds;
+};
+
+// Enumerate all operand pairs of posit<nbits, es> for add, sub, mul, and div.
+// The rows of the state space (all pairs with the same a) are the work items of the scheduler.
+struct VerifyBinaryOperators {
+	template<size_t nbits, size_t es>
+	void operator()() {
+		const uint64_t NR_POSITS = uint64_t(1) << nbits;
+
+		// decode every encoding once instead of once per pair
+		vector<double> values(NR_POSITS);
+		sw::unum::posit<nbits, es> p;
+		for (uint64_t i = 0; i < NR_POSITS; i++) {
+			p.set_raw_bits(i);
+			values[i] = double(p);
+		}
+
+		// a row pairs one a with every b: a batch over the encodings in order, in buffers that each worker
+		// allocates on its first row and reuses for all later rows and operators
+		using raw_type = posit_storage_t<nbits>;
+		struct Workspace {
+			explicit Workspace(uint64_t n) : ra(n), rb(n), result(n), reference(n), da(n), exact(n) {
+				for (uint64_t b = 0; b < n; b++) rb[b] = raw_type(b);
+			}
+			vector<raw_type> ra, rb, result, reference;
+			vector<double> da, exact;
+		};
+		vector< unique_ptr<Workspace> > workspaces(nrOfThreads > 0 ? nrOfThreads : 1);
+		mutex report_mutex;
+
+		for (int opcode : { sw::qa::OPCODE_ADD, sw::qa::OPCODE_SUB, sw::qa::OPCODE_MUL, sw::qa::OPCODE_DIV }) {
+			atomic<uint64_t> nrOfFailures(0);
+			std::string op = sw::qa::operation_string(opcode);
+			auto start = chrono::steady_clock::now();
+			work_stealing_for(size_t(NR_POSITS), 1, nrOfThreads, [&](unsigned worker, size_t first, size_t last) {
+				if (!workspaces[worker]) workspaces[worker].reset(new Workspace(NR_POSITS));
+				Workspace& ws = *workspaces[worker];
+				sw::unum::posit<nbits, es> pa, pb, presult, pref;
+				uint64_t failures = 0;
+				for (uint64_t a = first; a < last; a++) {
+					fill(ws.ra.begin(), ws.ra.end(), raw_type(a));
+					fill(ws.da.begin(), ws.da.end(), values[a]);
+					sw::qa::ExecuteBatch<nbits, es, double>(opcode, size_t(NR_POSITS), ws.ra.data(), ws.rb.data(), ws.da.data(), values.data(),
+					                                        ws.result.data(), ws.exact.data(), ws.reference.data());
+					for (uint64_t b = 0; b < NR_POSITS; b++) {
+						if (ws.result[b] != ws.reference[b]) {
+							if (bReportIndividualTestCases && failures < 10) {
+								pa.set_raw_bits(a);
+								pb.set_raw_bits(b);
+								presult.set_raw_bits(ws.result[b]);
+								pref.set_raw_bits(ws.reference[b]);
+								lock_guard<mutex> lock(report_mutex);
+								ReportBinaryArithmeticErrorInBinary("FAIL", op, pa, pb, pref, presult);
+							}
+							failures++;
+						}
+					}
+				}
+				nrOfFailures += failures;
+			});
+			double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+			results.push_back(VerificationResult{ nbits, es, opcode, NR_POSITS * NR_POSITS, nrOfFailures, seconds });
+		}
+	}
+
+	unsigned nrOfThreads;
+	bool bReportIndividualTestCases;
+	vector<VerificationResult> results;
+};
+
+// Exhaustively verify add/sub/mul/div for every valid posit<nbits, es> with minNbits <= nbits <= maxNbits
+// Usage: qa_exhaustive_binops [maxNbits [minNbits]] [--threads N]
+//   maxNbits defaults to 8 and is capped at 14; --threads 0 (default) uses all hardware threads
+int main(int argc, char** argv)
+try {
+	size_t minNbits = dispatch_min_nbits, maxNbits = 8;
+	unsigned nrOfThreads = 0;
+
+	vector<string> args;
+	for (int i = 1; i < argc; i++) {
+		string arg = argv[i];
+		if (arg == "--threads" && i + 1 < argc) nrOfThreads = unsigned(std::stoul(argv[++i]));
+		else args.push_back(arg);
+	}
+	if (args.size() > 0) maxNbits = std::stoul(args[0]);
+	if (args.size() > 1) minNbits = std::stoul(args[1]);
+	if (nrOfThreads == 0) nrOfThreads = std::max(1u, std::thread::hardware_concurrency());
+	if (maxNbits > MAX_EXHAUSTIVE_NBITS) {
+		cerr << "Exhaustive verification is limited to nbits <= " << MAX_EXHAUSTIVE_NBITS << ", use qa_smoke_randoms for larger posits" << endl;
+		maxNbits = MAX_EXHAUSTIVE_NBITS;
+	}
+	minNbits = std::max(minNbits, dispatch_min_nbits);
+
+	cerr << "Exhaustive verification of posit<" << minNbits << ".." << maxNbits << ",*> on " << nrOfThreads << " threads" << endl;
+
+	VerifyBinaryOperators verifier{ nrOfThreads, true, {} };
+	auto start = chrono::steady_clock::now();
+	for (size_t nbits = minNbits; nbits <= maxNbits; nbits++) {
+		for (size_t es = 0; es <= dispatch_max_es; es++) {
+			if (!valid_posit_configuration(nbits, es)) continue;
+			table_dispatch(verifier, nbits, es);
+		}
+	}
+	double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+	uint64_t nrOfFailedTestCases = 0, nrOfCases = 0;
+	cout << setw(14) << "config" << setw(4) << "op" << setw(14) << "cases" << setw(10) << "failures" << setw(12) << "seconds" << endl;
+	for (auto& r : verifier.results) {
+		cout << setw(14) << ("posit<" + to_string(r.nbits) + "," + to_string(r.es) + ">") << setw(4) << sw::qa::operation_string(r.opcode)
+			<< setw(14) << r.nrOfCases << setw(10) << r.nrOfFailures << setw(12) << fixed << setprecision(3) << r.seconds << endl;
+		nrOfFailedTestCases += r.nrOfFailures;
+		nrOfCases += r.nrOfCases;
+	}
+	cout << nrOfCases << " cases, " << nrOfFailedTestCases << " failures in " << fixed << setprecision(3) << seconds << " seconds" << endl;
+
+	return (nrOfFailedTestCases > 0 ? EXIT_FAILURE : EXIT_SUCCESS);
+}
+catch (char const* msg) {
+	cerr << msg << endl;
+	return EXIT_FAILURE;
+}
+catch (const std::exception& err) {
+	cerr << err.what() << endl;
+	return EXIT_FAILURE;
+}
+catch (...) {
+	cerr << "Caught unknown exception" << endl;
+	return EXIT_FAILURE;
+}
@@ -0,0 +1,41 @@
+#pragma once
+// opcodes.hpp: operator codes shared by the QA generators, sinks, and test vector files
+//
+// Copyright (C) 2017 Stillwater Supercomputing, Inc.
+//
+// This file is part of the universal numbers project, which is released under an MIT Open Source license.
+#include <string>
+
+namespace sw {
+	namespace qa {
+
+		// operation opcodes
+		const int OPCODE_NOP = 0;
+		const int OPCODE_ADD = 1;
+		const int OPCODE_SUB = 2;
+		const int OPCODE_MUL = 3;
+		const int OPCODE_DIV = 4;
+		const int OPCODE_RAN = 5;
+		const int OPCODE_CVT = 6;	// conversion: operand a is the IEEE-754 double input, b is unused
+
+		inline std::string operation_string(int opcode) {
+			switch (opcode) {
+			default:
+			case OPCODE_NOP:
+				return "nop";
+			case OPCODE_ADD:
+				return "+";
+			case OPCODE_SUB:
+				return "-";
+			case OPCODE_MUL:
+				return "*";
+			case OPCODE_DIV:
+				return "/";
+			case OPCODE_CVT:
+				return "=";
+			}
+		}
+
+
+	}; // namespace qa
+};  // namespace sw
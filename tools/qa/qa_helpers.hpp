@@ -4,8 +4,30 @@
 // Copyright (C) 2017 Stillwater Supercomputing, Inc.
 //
 // This file is part of the universal numbers project, which is released under an MIT Open Source license.
+#include <cstdint>
 #include <random>
 #include <limits>
+#include <algorithm>
+#include <atomic>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "counter_rng.hpp"
+#include "coverage_map.hpp"
+#include "opcodes.hpp"
+#include "test_vector_file.hpp"
+#include "result_sink.hpp"
+#include "shard_report.hpp"
+#include "stratified_sampler.hpp"
+#include "../../utilities/batch_ops.hpp"
+#include "../../utilities/decode_table.hpp"
+#include "../../utilities/event_counters.hpp"
 
 namespace sw {
 	namespace qa {
@@ -34,8 +56,64 @@ namespace sw {
 		struct TestCase {
 			sw::unum::posit<nbits, es> a, b, c;
 		};
+
+		// "a op b = reference HEX" with the encodings as bit strings, one line per record under a two-line header:
+		// the std::cout format of SmokeTestAddition/Subtraction/Multiplication/Division. Conversion records print
+		// the input and the golden reference with their binary components under a one-line header, the std::cout
+		// format of SmokeTestConversion. Hex triples are available through a TextSinkBackend, and csv and binary
+		// files through the other backends.
+		template<size_t nbits, size_t es>
+		class LegacyTextSinkBackend : public SinkBackend {
+		public:
+			explicit LegacyTextSinkBackend(std::ostream& ostr) : ostr(ostr), conversion(false) {}
+			void Begin(size_t, size_t, int opcode) override {
+				op = operation_string(opcode);
+				conversion = opcode == OPCODE_CVT;
+				ostr << "posit<" << nbits << "," << es << ">" << '\n';
+				if (conversion) return;
+				ostr << std::setw(nbits) << "Operand A  " << " " << op << " " << std::setw(nbits) << "Operand B  " << " = " << std::setw(nbits) << "Golden Reference  " << " " << std::setw(nbits / 4) << "HEX " << '\n';
+			}
+			size_t Write(const TestVector* records, size_t n) override {
+				std::ostringstream lines;
+				sw::unum::posit<nbits, es> pa, pb, pref;
+				if (conversion) {
+					lines.precision(std::numeric_limits< double >::max_digits10);
+					for (size_t i = 0; i < n; i++) {
+						double input = DoubleFromBits(records[i].a);
+						pref.set_raw_bits(records[i].reference);
+						double reference = double(pref);
+						sw::unum::value<std::numeric_limits< double >::digits> vi(input), vr(reference);
+						lines << input << ", " << sw::unum::to_binary(input) << ", " << components(vi) << "\n" << reference << ", " << sw::unum::to_binary(reference) << ", " << components(vr) << "," << pref.get() << '\n';
+					}
+					const std::string text = lines.str();
+					ostr.write(text.data(), std::streamsize(text.size()));
+					return text.size();
+				}
+				for (size_t i = 0; i < n; i++) {
+					pa.set_raw_bits(records[i].a);
+					pb.set_raw_bits(records[i].b);
+					pref.set_raw_bits(records[i].reference);
+					lines << pa.get() << " " << op << " " << pb.get() << " = " << pref.get() << " " << sw::unum::to_hex(pref.get()) << '\n';
+				}
+				const std::string text = lines.str();
+				ostr.write(text.data(), std::streamsize(text.size()));
+				return text.size();
+			}
+			void Finish() override { ostr.flush(); }
+		private:
+			std::ostream& ostr;
+			std::string op;
+			bool conversion;
+		};
+
+		// legacy text sink on std::cout, the default destination of the hand-written generators of posit<nbits, es>
 		template<size_t nbits, size_t es>
-		int SmokeTestAddition(std::string tag, bool bReportIndividualTestCases) {
+		ResultSink& LegacyOutputSink() {
+			static ResultSink sink(std::unique_ptr<SinkBackend>(new LegacyTextSinkBackend<nbits, es>(std::cout)));
+			return sink;
+		}
+		template<size_t nbits, size_t es>
+		int SmokeTestAddition(std::string tag, bool bReportIndividualTestCases, ResultSink* sink = &LegacyOutputSink<nbits, es>()) {
 			static_assert(nbits >= 16, "Use exhaustive testing for posits smaller than 16");
 			static_assert(nbits <= 64, "TODO: smoke test algorithm only works for nbits <= 64");
 
@@ -80,8 +158,8 @@ namespace sw {
 			// execute and output the test vector
 			sw::unum::posit<nbits, es> pa, pb, padd, pref;
 			double da, db;
-			std::cout << "posit<" << nbits << "," << es << ">" << std::endl;
-			std::cout << std::setw(nbits) << "Operand A  " << " + " << std::setw(nbits) << "Operand B  " << " = " << std::setw(nbits) << "Golden Reference  " << " " << std::setw(nbits/4) << "HEX " << std::endl;
+			if (sink) sink->Begin(nbits, es, OPCODE_ADD);
+			std::unique_ptr<ResultSink::Producer> vectors(sink ? new ResultSink::Producer(*sink) : nullptr);
 			for (size_t i = 0; i < test_cases.size(); i++) {
 				pa = test_cases[i].a;
 				da = double(pa);
@@ -96,13 +174,15 @@ namespace sw {
 				else {
 					//if (bReportIndividualTestCases) ReportBinaryArithmeticSuccess("PASS", "+", pa, pb, pref, padd);
 				}
-				std::cout << pa.get() << " + " << pb.get() << " = " << pref.get() << " " << sw::unum::to_hex(pref.get()) << std::endl;
+				if (vectors) vectors->Add(pa.get().to_ullong(), pb.get().to_ullong(), pref.get().to_ullong());
 			}
+			vectors.reset();
+			if (sink) sink->Flush();
 			return nrOfFailedTests;
 		}
 
 		template<size_t nbits, size_t es>
-		int SmokeTestSubtraction(std::string tag, bool bReportIndividualTestCases) {
+		int SmokeTestSubtraction(std::string tag, bool bReportIndividualTestCases, ResultSink* sink = &LegacyOutputSink<nbits, es>()) {
 			static_assert(nbits >= 16, "Use exhaustive testing for posits smaller than 16");
 			static_assert(nbits <= 64, "TODO: smoke test algorithm only works for nbits <= 64");
 
@@ -143,9 +223,9 @@ namespace sw {
 				test_cases.push_back(test);
 			}
 
-			// execute and output the test vector
-			std::cout << "posit<" << nbits << "," << es << ">" << std::endl;
-			std::cout << std::setw(nbits) << "Operand A  " << " - " << std::setw(nbits) << "Operand B  " << " = " << std::setw(nbits) << "Golden Reference  " << " " << std::setw(nbits / 4) << "HEX " << std::endl;
+			// execute and hand the test vectors to the sink
+			if (sink) sink->Begin(nbits, es, OPCODE_SUB);
+			std::unique_ptr<ResultSink::Producer> vectors(sink ? new ResultSink::Producer(*sink) : nullptr);
 
 			sw::unum::posit<nbits, es> pa, pb, psub, pref;
 			double da, db;
@@ -163,13 +243,15 @@ namespace sw {
 				else {
 					//if (bReportIndividualTestCases) ReportBinaryArithmeticSuccess("PASS", "+", pa, pb, pref, psub);
 				}
-				std::cout << pa.get() << " - " << pb.get() << " = " << pref.get() << " " << sw::unum::to_hex(pref.get()) << std::endl;
+				if (vectors) vectors->Add(pa.get().to_ullong(), pb.get().to_ullong(), pref.get().to_ullong());
 			}
+			vectors.reset();
+			if (sink) sink->Flush();
 			return nrOfFailedTests;
 		}
 
 		template<size_t nbits, size_t es>
-		int SmokeTestMultiplication(std::string tag, bool bReportIndividualTestCases) {
+		int SmokeTestMultiplication(std::string tag, bool bReportIndividualTestCases, ResultSink* sink = &LegacyOutputSink<nbits, es>()) {
 			static_assert(nbits >= 16, "Use exhaustive testing for posits smaller than 16");
 			static_assert(nbits <= 64, "TODO: smoke test algorithm only works for nbits <= 64");
 
@@ -202,9 +284,9 @@ namespace sw {
 				test_cases.push_back(test);
 			}
 
-			// execute and output the test vector
-			std::cout << "posit<" << nbits << "," << es << ">" << std::endl;
-			std::cout << std::setw(nbits) << "Operand A  " << " * " << std::setw(nbits) << "Operand B  " << " = " << std::setw(nbits) << "Golden Reference  " << " " << std::setw(nbits / 4) << "HEX " << std::endl;
+			// execute and hand the test vectors to the sink
+			if (sink) sink->Begin(nbits, es, OPCODE_MUL);
+			std::unique_ptr<ResultSink::Producer> vectors(sink ? new ResultSink::Producer(*sink) : nullptr);
 
 			sw::unum::posit<nbits, es> pa, pb, pmul, pref;
 			double da, db;
@@ -222,14 +304,16 @@ namespace sw {
 				else {
 					// if (bReportIndividualTestCases) ReportBinaryArithmeticSuccess("PASS", "*", pa, pb, pref, pmul);
 				}
-				std::cout << pa.get() << " * " << pb.get() << " = " << pref.get() << " " << sw::unum::to_hex(pref.get()) << std::endl;
+				if (vectors) vectors->Add(pa.get().to_ullong(), pb.get().to_ullong(), pref.get().to_ullong());
 			}
+			vectors.reset();
+			if (sink) sink->Flush();
 			return nrOfFailedTests;
 		}
 
 
 		template<size_t nbits, size_t es>
-		int SmokeTestDivision(std::string tag, bool bReportIndividualTestCases) {
+		int SmokeTestDivision(std::string tag, bool bReportIndividualTestCases, ResultSink* sink = &LegacyOutputSink<nbits, es>()) {
 			static_assert(nbits >= 16, "Use exhaustive testing for posits smaller than 16");
 			static_assert(nbits <= 64, "TODO: smoke test algorithm only works for nbits <= 64");
 
@@ -263,9 +347,9 @@ namespace sw {
 				test_cases.push_back(test);
 			}
 
-			// execute and output the test vector
-			std::cout << "posit<" << nbits << "," << es << ">" << std::endl;
-			std::cout << std::setw(nbits) << "Operand A  " << " / " << std::setw(nbits) << "Operand B  " << " = " << std::setw(nbits) << "Golden Reference  " << " " << std::setw(nbits / 4) << "HEX " << std::endl;
+			// execute and hand the test vectors to the sink
+			if (sink) sink->Begin(nbits, es, OPCODE_DIV);
+			std::unique_ptr<ResultSink::Producer> vectors(sink ? new ResultSink::Producer(*sink) : nullptr);
 
 			sw::unum::posit<nbits, es> pa, pb, pdiv, pref;
 			double da, db;
@@ -283,15 +367,18 @@ namespace sw {
 				else {
 					//if (bReportIndividualTestCases) ReportBinaryArithmeticSuccess("PASS", "+", pa, pb, pref, pdiv);
 				}
-				std::cout << pa.get() << " / " << pb.get() << " = " << pref.get() << " " << sw::unum::to_hex(pref.get()) << std::endl;
+				if (vectors) vectors->Add(pa.get().to_ullong(), pb.get().to_ullong(), pref.get().to_ullong());
 			}
+			vectors.reset();
+			if (sink) sink->Flush();
 			return nrOfFailedTests;
 		}
 
 
 
+		// check a conversion and hand its test vector, the input and the golden reference, to the producer
 		template<size_t nbits, size_t es>
-		int Compare(double input, const sw::unum::posit<nbits, es>& presult, double reference, bool bReportIndividualTestCases) {
+		int Compare(double input, const sw::unum::posit<nbits, es>& presult, double reference, bool bReportIndividualTestCases, ResultSink::Producer* vectors = nullptr) {
 			int fail = 0;
 			double result = double(presult);
 			if (fabs(result - reference) > 0.000000001) {
@@ -300,17 +387,14 @@ namespace sw {
 			}
 
 			//if (bReportIndividualTestCases) ReportConversionSuccess("PASS", "=", input, reference, presult);
-			// report test cases: input operand -> posit bit pattern
-			sw::unum::value<std::numeric_limits< double >::digits> vi(input), vr(reference);
-			std::cout.precision(std::numeric_limits< double >::max_digits10);
-			std::cout << input << ", " << sw::unum::to_binary(input) << ", " << components(vi) << "\n" << reference << ", " << sw::unum::to_binary(reference) << ", " << components(vr) << "," << presult.get() << std::endl;
+			if (vectors) vectors->Add(DoubleBits(input), 0, sw::unum::posit<nbits, es>(reference).get().to_ullong());
 
 			return fail;
 		}
 
 
 		template<size_t nbits, size_t es>
-		int SmokeTestConversion(std::string tag, bool bReportIndividualTestCases) {
+		int SmokeTestConversion(std::string tag, bool bReportIndividualTestCases, ResultSink* sink = &LegacyOutputSink<nbits, es>()) {
 			//static_assert(nbits >= 16, "Use exhaustive testing for posits smaller than 16");
 			static_assert(nbits < 64, "TODO: smoke test algorithm only works for nbits < 64");
 			// we are going to generate a test set that consists of all edge case posit configs and their midpoints
@@ -347,23 +431,17 @@ namespace sw {
 			sw::unum::posit<nbits + 1, es> p;  // need to generate them in the context of the posit that is nbits+1
 											   // around 1.0
 			p = 1.0; p--; raw_bits = p.get();
-			std::cout << "raw bits for  1.0-eps: " << raw_bits << " ull " << raw_bits.to_ullong() << std::endl;
 			test_patterns[0] = raw_bits.to_ullong();
 			p = 1.0; raw_bits = p.get();
-			std::cout << "raw bits for  1.00000: " << raw_bits << " ull " << raw_bits.to_ullong() << std::endl;
 			test_patterns[1] = raw_bits.to_ullong();
 			p = 1.0; p++; raw_bits = p.get();
-			std::cout << "raw bits for  1.0+eps: " << raw_bits << " ull " << raw_bits.to_ullong() << std::endl;
 			test_patterns[2] = raw_bits.to_ullong();
 			// around -1.0
 			p = -1.0; p--; raw_bits = p.get();
-			std::cout << "raw bits for -1.0-eps: " << raw_bits << " ull " << raw_bits.to_ullong() << " posit : " << p << std::endl;
 			test_patterns[3] = raw_bits.to_ullong();
 			p = -1.0; raw_bits = p.get();
-			std::cout << "raw bits for -1.00000: " << raw_bits << " ull " << raw_bits.to_ullong() << " posit : " << p << std::endl;
 			test_patterns[4] = raw_bits.to_ullong();
 			p = -1.0; p++; raw_bits = p.get();
-			std::cout << "raw bits for -1.0+eps: " << raw_bits << " ull " << raw_bits.to_ullong() << " posit : " << p << std::endl;
 			test_patterns[5] = raw_bits.to_ullong();
 
 			// second are the exponential ranges from/to minpos/maxpos
@@ -389,8 +467,9 @@ namespace sw {
 
 			sw::unum::posit<nbits + 1, es> pref, pprev, pnext;
 
-			// execute and output the test vector
-			std::cout << "posit<" << nbits << "," << es << ">" << std::endl;
+			// execute and hand the test vectors to the sink
+			if (sink) sink->Begin(nbits, es, OPCODE_CVT);
+			std::unique_ptr<ResultSink::Producer> vectors(sink ? new ResultSink::Producer(*sink) : nullptr);
 
 			int nrOfFailedTests = 0;
 			double minpos = sw::unum::minpos_value<nbits + 1, es>();
@@ -400,7 +479,7 @@ namespace sw {
 			for (int64_t index = 0; index < NR_TEST_CASES; index++) {
 				unsigned long long i = test_patterns[index];
 				pref.set_raw_bits(i);
-				std::cout << "Test case [" << index << "] = " << i << " b" << pref.get() << "  >>>>>>>>>>>>>>>  Reference Seed value: " << pref << std::endl;
+				if (bReportIndividualTestCases) std::cerr << "Test case [" << index << "] = " << i << " b" << pref.get() << "  >>>>>>>>>>>>>>>  Reference Seed value: " << pref << '\n';
 
 				da = double(pref);
 				if (i == 0) {
@@ -416,10 +495,10 @@ namespace sw {
 						input = da - eps;
 						pa = input;
 						pnext.set_raw_bits(i + 1);
-						nrOfFailedTests += sw::qa::Compare(input, pa, (double)pnext, bReportIndividualTestCases);
+						nrOfFailedTests += sw::qa::Compare(input, pa, (double)pnext, bReportIndividualTestCases, vectors.get());
 						input = da + eps;
 						pa = input;
-						nrOfFailedTests += sw::qa::Compare(input, pa, (double)pnext, bReportIndividualTestCases);
+						nrOfFailedTests += sw::qa::Compare(input, pa, (double)pnext, bReportIndividualTestCases, vectors.get());
 
 					}
 					else if (i == HALF - 1) {
@@ -427,14 +506,14 @@ namespace sw {
 						input = da - eps;
 						pa = input;
 						pprev.set_raw_bits(HALF - 2);
-						nrOfFailedTests += sw::qa::Compare(input, pa, (double)pprev, bReportIndividualTestCases);
+						nrOfFailedTests += sw::qa::Compare(input, pa, (double)pprev, bReportIndividualTestCases, vectors.get());
 					}
 					else if (i == HALF + 1) {
 						// special case of projecting to -maxpos
 						input = da - eps;
 						pa = input;
 						pprev.set_raw_bits(HALF + 2);
-						nrOfFailedTests += sw::qa::Compare(input, pa, (double)pprev, bReportIndividualTestCases);
+						nrOfFailedTests += sw::qa::Compare(input, pa, (double)pprev, bReportIndividualTestCases, vectors.get());
 					}
 					else if (i == STATE_SPACE - 1) {
 						// special case of projecting to -minpos
@@ -442,10 +521,10 @@ namespace sw {
 						input = da - eps;
 						pa = input;
 						pprev.set_raw_bits(i - 1);
-						nrOfFailedTests += sw::qa::Compare(input, pa, (double)pprev, bReportIndividualTestCases);
+						nrOfFailedTests += sw::qa::Compare(input, pa, (double)pprev, bReportIndividualTestCases, vectors.get());
 						input = da + eps;
 						pa = input;
-						nrOfFailedTests += sw::qa::Compare(input, pa, (double)pprev, bReportIndividualTestCases);
+						nrOfFailedTests += sw::qa::Compare(input, pa, (double)pprev, bReportIndividualTestCases, vectors.get());
 					}
 					else {
 						// for odd values, we are between posit values, so we create the round-up and round-down cases
@@ -453,12 +532,12 @@ namespace sw {
 						input = da - eps;
 						pa = input;
 						pprev.set_raw_bits(i - 1);
-						nrOfFailedTests += sw::qa::Compare(input, pa, (double)pprev, bReportIndividualTestCases);
+						nrOfFailedTests += sw::qa::Compare(input, pa, (double)pprev, bReportIndividualTestCases, vectors.get());
 						// round-up
 						input = da + eps;
 						pa = input;
 						pnext.set_raw_bits(i + 1);
-						nrOfFailedTests += sw::qa::Compare(input, pa, (double)pnext, bReportIndividualTestCases);
+						nrOfFailedTests += sw::qa::Compare(input, pa, (double)pnext, bReportIndividualTestCases, vectors.get());
 					}
 				}
 				else {
@@ -468,27 +547,29 @@ namespace sw {
 						input = da + eps;
 						pa = input;
 						pnext.set_raw_bits(i + 2);
-						nrOfFailedTests += sw::qa::Compare(input, pa, (double)pnext, bReportIndividualTestCases);
+						nrOfFailedTests += sw::qa::Compare(input, pa, (double)pnext, bReportIndividualTestCases, vectors.get());
 					}
 					else if (i == STATE_SPACE - 2) {
 						// special case of projecting to -minpos
 						input = da - eps;
 						pa = input;
 						pprev.set_raw_bits(STATE_SPACE - 2);
-						nrOfFailedTests += sw::qa::Compare(input, pa, (double)pprev, bReportIndividualTestCases);
+						nrOfFailedTests += sw::qa::Compare(input, pa, (double)pprev, bReportIndividualTestCases, vectors.get());
 					}
 					else {
 						// round-up
 						input = da - eps;
 						pa = input;
-						nrOfFailedTests += sw::qa::Compare(input, pa, da, bReportIndividualTestCases);
+						nrOfFailedTests += sw::qa::Compare(input, pa, da, bReportIndividualTestCases, vectors.get());
 						// round-down
 						input = da + eps;
 						pa = input;
-						nrOfFailedTests += sw::qa::Compare(input, pa, da, bReportIndividualTestCases);
+						nrOfFailedTests += sw::qa::Compare(input, pa, da, bReportIndividualTestCases, vectors.get());
 					}
 				}
 			}
+			vectors.reset();
+			if (sink) sink->Flush();
 			return nrOfFailedTests;
 		}
 
@@ -499,14 +580,6 @@ namespace sw {
 		// A more white box approach is to focus on the testcases 
 		// where something special happens in the posit arithmetic, such as rounding.
 
-		// operation opcodes
-		const int OPCODE_NOP = 0;
-		const int OPCODE_ADD = 1;
-		const int OPCODE_SUB = 2;
-		const int OPCODE_MUL = 3;
-		const int OPCODE_DIV = 4;
-		const int OPCODE_RAN = 5;
-
 		template<size_t nbits, size_t es, typename Ty>
 		void execute(int opcode, Ty a, Ty b, sw::unum::posit<nbits, es>& preference, const sw::unum::posit<nbits, es>& pa, const sw::unum::posit<nbits, es>& pb, sw::unum::posit<nbits, es>& presult) {
 			Ty reference;
@@ -534,162 +607,245 @@ namespace sw {
 				break;
 			}
 			preference = reference;
+			if (event_counters_enabled) record_rounding(presult, reference, pa.isNaR() || pb.isNaR());
+		}
+
+		// Batch form of execute over structure-of-arrays operands: the encodings a[], b[] and their values da[], db[].
+		// The opcode is resolved once; result[] receives the encodings computed by the library under test,
+		// reference[] the unrounded results in Ty, and preference[] their rounding to posit<nbits, es>.
+		template<size_t nbits, size_t es, typename Ty>
+		void ExecuteBatch(int opcode, size_t n, const posit_storage_t<nbits>* a, const posit_storage_t<nbits>* b, const Ty* da, const Ty* db,
+		                  posit_storage_t<nbits>* result, Ty* reference, posit_storage_t<nbits>* preference) {
+			binary_op op;
+			switch (opcode) {
+			default:
+			case OPCODE_NOP:
+				std::fill(result, result + n, posit_storage_t<nbits>(0));
+				std::fill(reference, reference + n, Ty(0));
+				std::fill(preference, preference + n, posit_storage_t<nbits>(0));
+				return;
+			case OPCODE_ADD: op = binary_op::add; break;
+			case OPCODE_SUB: op = binary_op::sub; break;
+			case OPCODE_MUL: op = binary_op::mul; break;
+			case OPCODE_DIV: op = binary_op::div; break;
+			}
+			batch_apply(generic_posit_engine<nbits, es>(), op, a, b, result, n);
+			batch_reference(op, da, db, reference, n);
+			sw::unum::posit<nbits, es> p;
+			for (size_t k = 0; k < n; k++) {
+				p = reference[k];
+				preference[k] = posit_storage_t<nbits>(p.get().to_ullong());
+			}
+			if (event_counters_enabled) {
+				sw::unum::posit<nbits, es> pa, pb;
+				for (size_t k = 0; k < n; k++) {
+					pa.set_raw_bits(a[k]);
+					pb.set_raw_bits(b[k]);
+					p.set_raw_bits(result[k]);
+					record_rounding(p, reference[k], pa.isNaR() || pb.isNaR());
+				}
+			}
+		}
+
+		// knobs of the randomized test suite
+		struct RandomTestOptions {
+			unsigned nrOfThreads = 1;           // workers that share the operation count
+			uint64_t seed = 0x5eed;             // the operands of case i are a pure function of (seed, i)
+			uint64_t begin = 0;                 // run the case indices [begin, end) of the sweep,
+			uint64_t end = UINT64_MAX;          // end is clipped to the number of randoms
+			size_t chunk_size = 4096;           // cases that are generated, tested and discarded together
+			std::vector<uint64_t>* failed_cases = nullptr;  // when set, receives the indices of failing cases
+			ResultSink* sink = nullptr;                     // receives the test vectors
+			bool standard_output = true;                    // without a sink, write the test vectors as text to std::cout, else discard them
+			OperandSampler sampler = OperandSampler::Uniform;  // how the operands of the random cases are drawn
+			OperandStrata* strata = nullptr;                // when set, receives the strata of all operands
+			CoverageMap* coverage = nullptr;                // when set, covers the results, and ends the sweep once it saturates
+			std::vector< std::pair<uint64_t, uint64_t> >* ranges = nullptr;  // when set, receives the [begin, end) ranges of the cases run
+		};
+
+		// the sink of the test vectors of a sweep, nullptr when they are discarded
+		inline ResultSink* VectorSink(const RandomTestOptions& options) {
+			if (options.sink) return options.sink;
+			return options.standard_output ? &StandardOutputSink() : nullptr;
+		}
+
+		// run worker(0) .. worker(nrOfWorkers-1) concurrently, worker 0 on the calling thread
+		template<typename Worker>
+		void RunWorkers(unsigned nrOfWorkers, Worker worker) {
+			std::vector<std::thread> threads;
+			for (unsigned w = 1; w < nrOfWorkers; w++) threads.emplace_back(worker, w);
+			worker(0);
+			for (auto& t : threads) t.join();
+		}
+
+		// The operands that are always tested: 1, minpos, maxpos, their neighbours towards the interior
+		// of the posit circle, and the negatives of all of these.
+		constexpr unsigned NR_SPECIAL_OPERANDS = 14;
+		template<size_t nbits, size_t es>
+		sw::unum::posit<nbits, es> SpecialOperand(unsigned k) {
+			sw::unum::posit<nbits, es> p;
+			switch (k % (NR_SPECIAL_OPERANDS / 2)) {
+			default:
+			case 0: p = 1.0; break;
+			case 1: p = 1.0; p--; break;
+			case 2: p = 1.0; p++; break;
+			case 3: p.set_raw_bits(1); break;
+			case 4: p.set_raw_bits(1); p++; break;
+			case 5: p.setToNaR(); p--; break;
+			case 6: p.setToNaR(); p--; p--; break;
+			}
+			return k < NR_SPECIAL_OPERANDS / 2 ? p : -p;
+		}
+
+		// The even cases 0, 2, .. 2*(NR_SPECIAL_OPERANDS^2 - 1) of a sweep pair up the special operands, and
+		// all other cases are random: every sweep starts with the special pairs whatever its length or chunking,
+		// and even a sweep shorter than the special pairs tests random operands in every other case.
+		template<size_t nbits, size_t es>
+		bool SpecialOperands(uint64_t i, sw::unum::posit<nbits, es>& pa, sw::unum::posit<nbits, es>& pb) {
+			if (i % 2 != 0 || i / 2 >= NR_SPECIAL_OPERANDS * NR_SPECIAL_OPERANDS) return false;
+			pa = SpecialOperand<nbits, es>(unsigned(i / 2 / NR_SPECIAL_OPERANDS));
+			pb = SpecialOperand<nbits, es>(unsigned(i / 2 % NR_SPECIAL_OPERANDS));
+			return true;
+		}
+
+		// Operands of case i of a random sweep: a special pair, see SpecialOperands, or else
+		// the bottom nbits of two counter-based random words as posit encodings (works for nbits<=64).
+		template<size_t nbits, size_t es>
+		void RandomOperands(const counter_rng& rng, uint64_t i, sw::unum::posit<nbits, es>& pa, sw::unum::posit<nbits, es>& pb) {
+			if (SpecialOperands(i, pa, pb)) return;
+			std::array<uint64_t, 2> bits = rng(i);
+			pa.set_raw_bits(bits[0]);
+			pb.set_raw_bits(bits[1]);
+		}
+
+		// Operands of case i of a stratified sweep: the special operand pairs, like RandomOperands,
+		// and pairs of the stratified sampler on streams 1 and 2 of the generator in between.
+		template<size_t nbits, size_t es>
+		void StratifiedOperands(const counter_rng& rng, uint64_t i, sw::unum::posit<nbits, es>& pa, sw::unum::posit<nbits, es>& pb) {
+			if (SpecialOperands(i, pa, pb)) return;
+			uint64_t a, b;
+			StratifiedPair(nbits, es, rng(i, 1), rng(i, 2), a, b);
+			pa.set_raw_bits(a);
+			pb.set_raw_bits(b);
+		}
+
+		// Value of an operand for the reference computation. Formats of up to 16 bits take it from the
+		// shared decode table, which turns the conversion in the operand fill into a single load.
+		template<size_t nbits, size_t es, typename Ty>
+		Ty OperandValue(const sw::unum::posit<nbits, es>& p, std::true_type) {
+			return Ty(decode_table_for<nbits, es>()[p.get().to_ullong()]);
+		}
+		template<size_t nbits, size_t es, typename Ty>
+		Ty OperandValue(const sw::unum::posit<nbits, es>& p, std::false_type) {
+			return (Ty)p;
+		}
+		template<size_t nbits, size_t es, typename Ty>
+		Ty OperandValue(const sw::unum::posit<nbits, es>& p) {
+			return OperandValue<nbits, es, Ty>(p, std::integral_constant<bool, (nbits >= dispatch_min_nbits && nbits <= decode_table_max_nbits && es <= dispatch_max_es)>());
 		}
 
 		// generate a random set of operands to test the binary operators for a posit configuration
-		// Basic design is that we generate nrOfRandom posit values and store them in an operand array.
-		// We will then execute the binary operator nrOfRandom combinations.
+		// Case i of the sweep draws its operands from a counter-based generator keyed by options.seed,
+		// so any slice [options.begin, options.end) of the nrOfRandoms cases can be run, or rerun, on its own.
+		// The slice is split across options.nrOfThreads workers, which stream through it in chunks of
+		// options.chunk_size cases: resident memory is independent of nrOfRandoms.
+		// With a coverage map, the workers share the map and a single saturation flag: once any worker's chunk
+		// saturates the map, all workers stop after their current chunk, so each runs a prefix of its slice.
 		template<size_t nbits, size_t es>
-		int SmokeTestRandoms(std::string tag, int opcode, unsigned int nrOfRandoms) {
+		int SmokeTestRandoms(std::string tag, int opcode, uint64_t nrOfRandoms, const RandomTestOptions& options = RandomTestOptions()) {
 			static_assert(nbits <= 64, "SmokeTestRandoms only works for nbits <= 64");
-			int max_digits10 = std::numeric_limits<double>::max_digits10;
-			const size_t SIZE_STATE_SPACE = nrOfRandoms;
-			int nrOfFailedTests = 0;
-			sw::unum::posit<nbits, es> pa, pb, presult, pref;
+			// operands with more fraction bits than a double need a long double reference
+			using Ty = typename std::conditional<(nbits - es - 1 > 52), long double, double>::type;
+			using raw_type = posit_storage_t<nbits>;
+			const unsigned nrOfThreads = options.nrOfThreads > 0 ? options.nrOfThreads : 1;
+			const uint64_t end = std::min(options.end, nrOfRandoms);
+			const uint64_t begin = std::min(options.begin, end);
 
 			if (opcode == OPCODE_RAN) {
 				// TODO: generate a random operator
 			}
-			std::string operation_string;
-			switch (opcode) {
-			default:
-			case OPCODE_NOP:
-				operation_string = "nop";
-				break;
-			case OPCODE_ADD:
-				operation_string = "+";
-				break;
-			case OPCODE_SUB:
-				operation_string = "-";
-				break;
-			case OPCODE_MUL:
-				operation_string = "*";
-				break;
-			case OPCODE_DIV:
-				operation_string = "/";
-				break;
-			}
-			// generate the full state space set of valid posit values
-			std::random_device rd;     //Get a random seed from the OS entropy device, or whatever
-			std::mt19937_64 eng(rd()); //Use the 64-bit Mersenne Twister 19937 generator and seed it with entropy.
-									   //Define the distribution, by default it goes from 0 to MAX(unsigned long long)
-			std::uniform_int_distribution<unsigned long long> uniform;
+			std::string op = operation_string(opcode);
+			const counter_rng rng(options.seed);
 #if VERBOSE
 			std::cout << "Size of float     type is: " << 8*sizeof(float) << "bits" << std::endl;
 			std::cout << "Size of double    type is: " << 8*sizeof(double) << "bits" << std::endl;
 			std::cout << "Size of quadruple type is: " << 8*sizeof(long double) << "bits" << std::endl;
-#endif
-
-			if (nbits - es - 1 > 52) {
-				std::vector<long double> operand_values(SIZE_STATE_SPACE);
-				// inject minpos/maxpos and -minpos/-maxpos in the samples
-				presult = 1.0;
-				operand_values[0] = (long double)presult;
-				presult = -1.0;
-				operand_values[1] = (long double)presult;
-				presult.set_raw_bits(1);
-				operand_values[2] = (long double)presult;
-				presult--; presult--;
-				operand_values[3] = (long double)presult;
-				presult.setToNaR();
-				presult++;
-				operand_values[4] = (long double)presult;
-				presult.setToNaR();
-				presult++;
-				operand_values[5] = (long double)presult;
-				for (uint32_t i = 6; i < SIZE_STATE_SPACE; i++) {
-					presult.set_raw_bits(uniform(eng));  // take the bottom nbits bits as posit encoding: works for nbits<=64
-					operand_values[i] = (long double)presult;
-				}
-
-				/*
-				for (uint32_t i = 0; i < SIZE_STATE_SPACE; i++) {
-					std::cout << std::setprecision(max_digits10) << operand_values[i] << std::endl;
-				}
-				*/
 
-#if VERBOSE
-				// execute and output the test vector
-				std::cout << "posit<" << nbits << "," << es << ">" << std::endl;
-				std::cout << std::setw(nbits) << "Operand A  " << " " << operation_string << " " << std::setw(nbits) << "Operand B  " << " = " << std::setw(nbits) << "Golden Reference  " << " " << std::setw(nbits / 4) << "HEX " << std::endl;
+			// execute and output the test vector
+			std::cout << "posit<" << nbits << "," << es << ">" << std::endl;
+			std::cout << std::setw(nbits) << "Operand A  " << " " << op << " " << std::setw(nbits) << "Operand B  " << " = " << std::setw(nbits) << "Golden Reference  " << " " << std::setw(nbits / 4) << "HEX " << std::endl;
 #endif
 
-				long double qa, qb;
-				unsigned int ia, ib;  // random indices for picking operands to test
-				for (unsigned int i = 1; i < nrOfRandoms; i++) {
-					ia = (unsigned int)(uniform(eng) % SIZE_STATE_SPACE);
-					qa = operand_values[ia];
-					pa = qa;
-					ib = (unsigned int)(uniform(eng) % SIZE_STATE_SPACE);
-					qb = operand_values[ib];
-					pb = qb;
-
-					sw::qa::execute<nbits,es,double>(opcode, qa, qb, pref, pa, pb, presult);
-					if (presult != pref) {
-						nrOfFailedTests++;
-						ReportBinaryArithmeticErrorInBinary("FAIL", operation_string, pa, pb, pref, presult);
+			// workers hand their test vectors to the sink, which formats and writes them in the background
+			ResultSink* const sink = VectorSink(options);
+			if (sink) sink->Begin(nbits, es, opcode);
+			std::mutex output_mutex;
+			std::atomic<int> nrOfFailedTests(0);
+			std::vector< std::vector<uint64_t> > failed_cases(nrOfThreads);
+			std::vector< std::pair<uint64_t, uint64_t> > ranges(nrOfThreads);
+			std::atomic<bool> saturated(false);
+			RunWorkers(nrOfThreads, [&](unsigned w) {
+				std::unique_ptr<ResultSink::Producer> vectors(sink ? new ResultSink::Producer(*sink) : nullptr);
+				const size_t CHUNK = options.chunk_size > 0 ? options.chunk_size : 1;
+				// the chunk is held as arrays of encodings and values, and tested one batch per chunk
+				std::vector<raw_type> chunk_a(CHUNK), chunk_b(CHUNK), chunk_result(CHUNK), chunk_pref(CHUNK);
+				std::vector<Ty> chunk_da(CHUNK), chunk_db(CHUNK), chunk_reference(CHUNK);
+				std::unique_ptr<OperandStrata> strata(options.strata ? new OperandStrata(nbits, es) : nullptr);
+				sw::unum::posit<nbits, es> pa, pb, presult, pref;
+				int failures = 0;
+				uint64_t last = SliceBegin(begin, end, w + 1, nrOfThreads);
+				uint64_t base = SliceBegin(begin, end, w, nrOfThreads);
+				ranges[w].first = base;
+				for (; base < last && !saturated.load(std::memory_order_relaxed); base += CHUNK) {
+					const size_t n = size_t(std::min<uint64_t>(CHUNK, last - base));
+					// generate the operands of the chunk
+					for (size_t k = 0; k < n; k++) {
+						if (options.sampler == OperandSampler::Stratified) StratifiedOperands(rng, base + k, pa, pb);
+						else RandomOperands(rng, base + k, pa, pb);
+						chunk_a[k] = raw_type(pa.get().to_ullong());
+						chunk_b[k] = raw_type(pb.get().to_ullong());
+						if (strata) {
+							strata->Record(chunk_a[k]);
+							strata->Record(chunk_b[k]);
+						}
+						chunk_da[k] = OperandValue<nbits, es, Ty>(pa);
+						chunk_db[k] = OperandValue<nbits, es, Ty>(pb);
 					}
-					else {
-						//if (bReportIndividualTestCases) ReportBinaryArithmeticSuccess("PASS", operation_string, pa, pb, preference, presult);
+					// test the chunk
+					ExecuteBatch<nbits, es, Ty>(opcode, n, chunk_a.data(), chunk_b.data(), chunk_da.data(), chunk_db.data(),
+					                            chunk_result.data(), chunk_reference.data(), chunk_pref.data());
+					for (size_t k = 0; k < n; k++) {
+						if (chunk_result[k] != chunk_pref[k]) {
+							failures++;
+							if (options.failed_cases) failed_cases[w].push_back(base + k);
+							pa.set_raw_bits(chunk_a[k]);
+							pb.set_raw_bits(chunk_b[k]);
+							pref.set_raw_bits(chunk_pref[k]);
+							presult.set_raw_bits(chunk_result[k]);
+							std::lock_guard<std::mutex> lock(output_mutex);
+							std::cerr << "case " << base + k << ": ";
+							ReportBinaryArithmeticErrorInBinary("FAIL", op, pa, pb, pref, presult);
+						}
+						if (vectors) vectors->Add(chunk_a[k], chunk_b[k], chunk_pref[k]);
 					}
-					//std::cout << pa.get() << " " << operation_string << " " << pb.get() << " = " << pref.get() << " " << sw::unum::to_hex(pref.get()) << std::endl;
-					std::cout << hex << setw(8) << pa.get().to_ullong() << " " << setw(8) << pb.get().to_ullong() << " " << setw(8) << pref.get().to_ullong() << std::endl;
-				}
-			}
-			else {
-				std::vector<double> operand_values(SIZE_STATE_SPACE);
-				// inject minpos/maxpos and -minpos/-maxpos in the samples
-				presult = 1.0;
-				operand_values[0] = (long double)presult;
-				presult = -1.0;
-				operand_values[1] = (long double)presult;
-				presult.set_raw_bits(1);
-				operand_values[2] = (long double)presult;
-				presult--; presult--;
-				operand_values[3] = (long double)presult;
-				presult.setToNaR();
-				presult++;
-				operand_values[4] = (long double)presult;
-				presult.setToNaR();
-				presult++;
-				operand_values[5] = (long double)presult;
-				for (uint32_t i = 6; i < SIZE_STATE_SPACE; i++) {
-					presult.set_raw_bits(uniform(eng));  // take the bottom nbits bits as posit encoding: works for nbits<=64
-					operand_values[i] = (long double)presult;
-				}
-
-				/*
-				for (uint32_t i = 0; i < SIZE_STATE_SPACE; i++) {
-				std::cout << std::setprecision(max_digits10) << operand_values[i] << std::endl;
-				}
-				*/
-
-#if VERBOSE
-				// execute and output the test vector
-				std::cout << "posit<" << nbits << "," << es << ">" << std::endl;
-				std::cout << std::setw(nbits) << "Operand A  " << " " << operation_string <<  " " << std::setw(nbits) << "Operand B  " << " = " << std::setw(nbits) << "Golden Reference  " << " " << std::setw(nbits / 4) << "HEX " << std::endl;
-#endif
-
-				double da, db;
-				unsigned int ia, ib;  // random indices for picking operands to test
-				for (unsigned int i = 1; i < nrOfRandoms; i++) {
-					ia = (unsigned int)(uniform(eng) % SIZE_STATE_SPACE);
-					da = operand_values[ia];
-					pa = da;
-					ib = (unsigned int)(uniform(eng) % SIZE_STATE_SPACE);
-					db = operand_values[ib];
-					pb = db;
-					sw::qa::execute<nbits,es,double>(opcode, da, db, pref, pa, pb, presult);
-					if (presult != pref) {
-						nrOfFailedTests++;
-						ReportBinaryArithmeticErrorInBinary("FAIL", operation_string, pa, pb, pref, presult);
-					}
-					else {
-						//if (bReportIndividualTestCases) ReportBinaryArithmeticSuccess("PASS", operation_string, pa, pb, preference, presult);
+					if (options.coverage && options.coverage->Advance(n, options.coverage->Cover(chunk_pref.data(), chunk_reference.data(), n))) {
+						saturated.store(true, std::memory_order_relaxed);
 					}
-					//std::cout << pa.get() << " " << operation_string << " " << pb.get() << " = " << pref.get() << " " << sw::unum::to_hex(pref.get()) << std::endl;
-					std::cout << hex << setw(8) << pa.get().to_ullong() << " " << setw(8) << pb.get().to_ullong() << " " << setw(8) << pref.get().to_ullong() << std::endl;
 				}
+				ranges[w].second = std::min(base, last);
+				nrOfFailedTests.fetch_add(failures);
+				if (strata) {
+					std::lock_guard<std::mutex> lock(output_mutex);
+					options.strata->Merge(*strata);
+				}
+			});
+			if (sink) sink->Flush();
+			if (options.failed_cases) {
+				// slices are contiguous and in worker order, so the indices come out sorted
+				for (auto& cases : failed_cases) options.failed_cases->insert(options.failed_cases->end(), cases.begin(), cases.end());
+			}
+			if (options.ranges) {
+				for (auto& r : ranges) if (r.second > r.first) options.ranges->push_back(r);
 			}
 			return nrOfFailedTests;
 		}
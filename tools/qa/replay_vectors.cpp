@@ -0,0 +1,139 @@
+// replay_vectors.cpp: replay binary test vector files against the posit library
+//
+// Copyright (C) 2017 Stillwater Supercomputing, Inc.
+//
+// This file is part of the universal numbers project, which is released under an MIT Open Source license.
+
+#include "common.hpp"
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include <posit>
+#include "../tests/posit_test_helpers.hpp"
+#include "qa_helpers.hpp"
+#include "test_vector_file.hpp"
+#include "../../utilities/dispatch_table.hpp"
+#include "../../utilities/posit_engine.hpp"
+#include "../../utilities/work_stealing.hpp"
+
+using namespace std;
+
+// Recompute every record of the file and compare with the golden reference: with the posit library, through
+// library_posit_engine<nbits, es>, or with bNative, through the fastest engine posit_engine<nbits, es>, which
+// checks the native engines of the standard formats against vectors the library produced.
+struct ReplayVectors {
+	template<size_t nbits, size_t es>
+	void operator()() {
+		if (bNative) Replay<posit_engine<nbits, es>, nbits, es>();
+		else Replay<library_posit_engine<nbits, es>, nbits, es>();
+	}
+
+	template<typename engine_type, size_t nbits, size_t es>
+	void Replay() {
+		using raw_type = typename engine_type::raw_type;
+		const int opcode = file.opcode();
+		const std::string op = sw::qa::operation_string(opcode);
+		const size_t GRAIN = 64 * 1024;
+		atomic<uint64_t> failures(0);
+		mutex report_mutex;
+		work_stealing_for(size_t(file.size()), GRAIN, nrOfThreads, [&](unsigned, size_t first, size_t last) {
+			engine_type engine;
+			uint64_t local_failures = 0;
+			for (size_t i = first; i < last; i++) {
+				sw::qa::TestVector v = file[i];
+				raw_type a = raw_type(v.a), b = raw_type(v.b), c;
+				switch (opcode) {
+				case sw::qa::OPCODE_ADD: c = engine.add(a, b); break;
+				case sw::qa::OPCODE_SUB: c = engine.sub(a, b); break;
+				case sw::qa::OPCODE_MUL: c = engine.mul(a, b); break;
+				case sw::qa::OPCODE_DIV: c = engine.div(a, b); break;
+				// the engines take encodings only, so conversions always replay through the library
+				case sw::qa::OPCODE_CVT: c = raw_type(sw::unum::posit<nbits, es>(sw::qa::DoubleFromBits(v.a)).get().to_ullong()); break;
+				default: c = 0; break;
+				}
+				if (c != raw_type(v.reference)) {
+					if (bReportIndividualTestCases && local_failures < 10) {
+						sw::unum::posit<nbits, es> pa, pb, pref, presult;
+						pa.set_raw_bits(v.a); pb.set_raw_bits(v.b); pref.set_raw_bits(v.reference); presult.set_raw_bits(c);
+						lock_guard<mutex> lock(report_mutex);
+						cerr << "record " << i << ": ";
+						if (opcode == sw::qa::OPCODE_CVT) ReportConversionError("FAIL", op, sw::qa::DoubleFromBits(v.a), double(pref), presult);
+						else ReportBinaryArithmeticErrorInBinary("FAIL", op, pa, pb, pref, presult);
+					}
+					local_failures++;
+				}
+			}
+			failures += local_failures;
+		});
+		nrOfFailures = failures;
+	}
+
+	const sw::qa::TestVectorFile& file;
+	unsigned nrOfThreads;
+	bool bReportIndividualTestCases;
+	bool bNative;
+	uint64_t nrOfFailures;
+};
+
+// the configurations qa_smoke_randoms generates beyond the range of the dispatch table
+bool ReplayLargeConfiguration(ReplayVectors& replay, size_t nbits, size_t es) {
+	if (nbits == 24 && es == 1) { replay.operator()<24, 1>(); return true; }
+	if (nbits == 32 && es == 2) { replay.operator()<32, 2>(); return true; }
+	if (nbits == 48 && es == 2) { replay.operator()<48, 2>(); return true; }
+	if (nbits == 64 && es == 3) { replay.operator()<64, 3>(); return true; }
+	return false;
+}
+
+// Replay test vector files written by the QA generators
+// Usage: qa_replay_vectors [--threads N] [--native] file ..
+//   --native   replay with the native-integer engines of posit<16,1>, <32,2> and <64,3> instead of the library
+int main(int argc, char** argv)
+try {
+	unsigned nrOfThreads = 0;
+	bool bNative = false;
+	vector<string> files;
+	for (int i = 1; i < argc; i++) {
+		string arg = argv[i];
+		if (arg == "--threads" && i + 1 < argc) nrOfThreads = unsigned(std::stoul(argv[++i]));
+		else if (arg == "--native") bNative = true;
+		else files.push_back(arg);
+	}
+	if (nrOfThreads == 0) nrOfThreads = std::max(1u, std::thread::hardware_concurrency());
+	if (files.empty()) {
+		cerr << "Usage: qa_replay_vectors [--threads N] [--native] file .." << endl;
+		return EXIT_SUCCESS;
+	}
+
+	uint64_t nrOfFailedTestCases = 0;
+	for (auto& path : files) {
+		sw::qa::TestVectorFile file(path);
+		ReplayVectors replay{ file, nrOfThreads, true, bNative, 0 };
+		auto start = chrono::steady_clock::now();
+		if (table_dispatch(replay, file.nbits(), file.es()) != dispatch_status::ok && !ReplayLargeConfiguration(replay, file.nbits(), file.es())) {
+			cerr << path << ": posit<" << file.nbits() << "," << file.es() << "> is not supported" << endl;
+			nrOfFailedTestCases++;
+			continue;
+		}
+		double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+		cout << path << ": posit<" << file.nbits() << "," << file.es() << "> " << sw::qa::operation_string(file.opcode()) << " "
+			<< file.size() << " records, " << replay.nrOfFailures << " failures, "
+			<< scientific << setprecision(3) << file.size() / seconds << " records/sec" << endl;
+		nrOfFailedTestCases += replay.nrOfFailures;
+	}
+
+	return (nrOfFailedTestCases > 0 ? EXIT_FAILURE : EXIT_SUCCESS);
+}
+catch (char const* msg) {
+	cerr << msg << endl;
+	return EXIT_FAILURE;
+}
+catch (const std::exception& err) {
+	cerr << err.what() << endl;
+	return EXIT_FAILURE;
+}
+catch (...) {
+	cerr << "Caught unknown exception" << endl;
+	return EXIT_FAILURE;
+}
@@ -0,0 +1,292 @@
+#pragma once
+// result_sink.hpp: asynchronous, buffered output of test vectors for the QA generators
+//
+// Copyright (C) 2017 Stillwater Supercomputing, Inc.
+//
+// This file is part of the universal numbers project, which is released under an MIT Open Source license.
+#include <cstdint>
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <iostream>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "opcodes.hpp"
+#include "test_vector_file.hpp"
+
+namespace sw {
+	namespace qa {
+
+		// Formats and writes blocks of test vectors; only ever called from the sink's writer thread.
+		class SinkBackend {
+		public:
+			virtual ~SinkBackend() {}
+			virtual void Begin(size_t nbits, size_t es, int opcode) = 0;
+			// write n records and return the number of bytes produced
+			virtual size_t Write(const TestVector* records, size_t n) = 0;
+			virtual void Finish() {}
+		};
+
+		inline char* FormatHex(char* dst, uint64_t value, int width) {
+			static const char digits[] = "0123456789abcdef";
+			char tmp[16];
+			int n = 0;
+			do { tmp[n++] = digits[value & 0xF]; value >>= 4; } while (value);
+			for (int i = n; i < width; i++) *dst++ = ' ';
+			while (n > 0) *dst++ = tmp[--n];
+			return dst;
+		}
+
+		// "a b reference" as hex encodings, one line per record: the qa_smoke_randoms format.
+		// Like the original setw(8), the encodings are padded to 8 digits; wider ones simply run longer.
+		class TextSinkBackend : public SinkBackend {
+		public:
+			explicit TextSinkBackend(std::ostream& ostr) : ostr(ostr) {}
+			void Begin(size_t, size_t, int) override {}
+			size_t Write(const TestVector* records, size_t n) override {
+				buffer.resize(n * 3 * (16 + 1));
+				char* p = &buffer[0];
+				for (size_t i = 0; i < n; i++) {
+					p = FormatHex(p, records[i].a, width); *p++ = ' ';
+					p = FormatHex(p, records[i].b, width); *p++ = ' ';
+					p = FormatHex(p, records[i].reference, width); *p++ = '\n';
+				}
+				size_t bytes = size_t(p - &buffer[0]);
+				ostr.write(buffer.data(), bytes);
+				return bytes;
+			}
+			void Finish() override { ostr.flush(); }
+		private:
+			static const int width = 8;
+			std::ostream& ostr;
+			std::string buffer;
+		};
+
+		// nbits,es,op,a,b,reference with hex encodings, so runs of several configurations can share a file
+		class CsvSinkBackend : public SinkBackend {
+		public:
+			explicit CsvSinkBackend(const std::string& path) : ostr(path, std::ios::trunc) {
+				if (!ostr) throw std::runtime_error("unable to create csv file " + path);
+				ostr << "nbits,es,op,a,b,reference\n";
+			}
+			void Begin(size_t nbits, size_t es, int opcode) override {
+				prefix = std::to_string(nbits) + "," + std::to_string(es) + "," + operation_string(opcode) + ",";
+			}
+			size_t Write(const TestVector* records, size_t n) override {
+				buffer.resize(n * (prefix.size() + 3 * 19 + 3));
+				char* p = &buffer[0];
+				for (size_t i = 0; i < n; i++) {
+					p = std::copy(prefix.begin(), prefix.end(), p);
+					*p++ = '0'; *p++ = 'x'; p = FormatHex(p, records[i].a, 0); *p++ = ',';
+					*p++ = '0'; *p++ = 'x'; p = FormatHex(p, records[i].b, 0); *p++ = ',';
+					*p++ = '0'; *p++ = 'x'; p = FormatHex(p, records[i].reference, 0); *p++ = '\n';
+				}
+				size_t bytes = size_t(p - &buffer[0]);
+				ostr.write(buffer.data(), bytes);
+				return bytes;
+			}
+			void Finish() override {
+				ostr.flush();
+				if (!ostr) throw std::runtime_error("unable to write csv file");
+			}
+		private:
+			std::ofstream ostr;
+			std::string prefix, buffer;
+		};
+
+		// binary test vector file, see test_vector_file.hpp; holds a single configuration and operator
+		class BinarySinkBackend : public SinkBackend {
+		public:
+			explicit BinarySinkBackend(const std::string& path) : path(path) {}
+			void Begin(size_t nbits, size_t es, int opcode) override {
+				if (writer) throw std::runtime_error("a binary test vector file holds a single configuration and operator");
+				writer.reset(new TestVectorWriter(path, nbits, es, opcode));
+			}
+			size_t Write(const TestVector* records, size_t n) override {
+				block.clear();
+				for (size_t i = 0; i < n; i++) writer->Pack(block, records[i].a, records[i].b, records[i].reference);
+				writer->Append(block);
+				return block.size();
+			}
+			void Finish() override {
+				if (writer) writer->Close();
+			}
+		private:
+			std::string path;
+			std::unique_ptr<TestVectorWriter> writer;
+			std::vector<uint8_t> block;
+		};
+
+		// Decouples the arithmetic hot loop from I/O: producers fill private blocks of records,
+		// and a background thread formats and writes full blocks through the backend.
+		// The thread starts with the first block, so a sink that receives no records costs no thread.
+		// When the writer falls behind by max_pending_blocks, producers wait; those stalls are counted.
+		class ResultSink {
+		public:
+			struct Statistics {
+				uint64_t records = 0;
+				uint64_t bytes = 0;
+				double seconds = 0.0;            // lifetime of the sink
+				double write_seconds = 0.0;      // time the writer thread spent formatting and writing
+				uint64_t stalls = 0;
+				double stall_seconds = 0.0;
+				double BytesPerSecond() const { return seconds > 0.0 ? bytes / seconds : 0.0; }
+				double WriteBytesPerSecond() const { return write_seconds > 0.0 ? bytes / write_seconds : 0.0; }
+			};
+
+			// per-thread buffer; hands its block to the sink when full and on destruction
+			class Producer {
+			public:
+				explicit Producer(ResultSink& sink) : sink(sink) { block.reserve(sink.block_records); }
+				~Producer() { Flush(); }
+				Producer(const Producer&) = delete;
+				Producer& operator=(const Producer&) = delete;
+
+				void Add(uint64_t a, uint64_t b, uint64_t reference) {
+					block.push_back(TestVector{ a, b, reference });
+					if (block.size() >= sink.block_records) sink.Submit(block);
+				}
+				void Flush() {
+					if (!block.empty()) sink.Submit(block);
+				}
+			private:
+				ResultSink& sink;
+				std::vector<TestVector> block;
+			};
+
+			explicit ResultSink(std::unique_ptr<SinkBackend> backend, size_t block_records = 16 * 1024, size_t max_pending_blocks = 64)
+				: backend(std::move(backend)), block_records(block_records > 0 ? block_records : 1), max_pending_blocks(max_pending_blocks > 0 ? max_pending_blocks : 1),
+				  closing(false), writing(false), start(std::chrono::steady_clock::now()) {
+			}
+			~ResultSink() {
+				try { Close(); } catch (...) {}
+			}
+			ResultSink(const ResultSink&) = delete;
+			ResultSink& operator=(const ResultSink&) = delete;
+
+			// start a new configuration/operator; producers of the previous one must have flushed
+			void Begin(size_t nbits, size_t es, int opcode) {
+				Flush();
+				std::lock_guard<std::mutex> lock(mutex);
+				backend->Begin(nbits, es, opcode);
+			}
+
+			// wait until everything submitted so far has been written
+			void Flush() {
+				std::unique_lock<std::mutex> lock(mutex);
+				idle.wait(lock, [this]() { return queue.empty() && !writing; });
+				if (error) std::rethrow_exception(error);
+			}
+
+			void Close() {
+				{
+					std::lock_guard<std::mutex> lock(mutex);
+					if (closing) return;
+					closing = true;
+				}
+				not_empty.notify_all();
+				if (writer.joinable()) writer.join();
+				backend->Finish();
+				stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+				if (error) std::rethrow_exception(error);
+			}
+
+			Statistics statistics() const {
+				std::lock_guard<std::mutex> lock(mutex);
+				Statistics s = stats;
+				if (!closing) s.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+				return s;
+			}
+
+		private:
+			// enqueue a full block and hand the producer an empty one to continue with
+			void Submit(std::vector<TestVector>& block) {
+				std::unique_lock<std::mutex> lock(mutex);
+				if (!writer.joinable() && !closing) writer = std::thread([this]() { WriterLoop(); });
+				if (queue.size() >= max_pending_blocks) {
+					auto stall_start = std::chrono::steady_clock::now();
+					not_full.wait(lock, [this]() { return queue.size() < max_pending_blocks || closing; });
+					stats.stalls++;
+					stats.stall_seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - stall_start).count();
+				}
+				queue.push_back(std::move(block));
+				if (!spare_blocks.empty()) {
+					block = std::move(spare_blocks.back());
+					spare_blocks.pop_back();
+				}
+				else {
+					block = std::vector<TestVector>();
+					block.reserve(block_records);
+				}
+				not_empty.notify_one();
+			}
+
+			void WriterLoop() {
+				std::unique_lock<std::mutex> lock(mutex);
+				for (;;) {
+					not_empty.wait(lock, [this]() { return !queue.empty() || closing; });
+					if (queue.empty()) return;
+					std::vector<TestVector> block = std::move(queue.front());
+					queue.pop_front();
+					writing = true;
+					lock.unlock();
+					not_full.notify_one();
+					size_t bytes = 0;
+					auto write_start = std::chrono::steady_clock::now();
+					try {
+						if (!error) bytes = backend->Write(block.data(), block.size());
+					}
+					catch (...) {
+						lock.lock();
+						error = std::current_exception();
+						lock.unlock();
+					}
+					double write_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - write_start).count();
+					lock.lock();
+					stats.write_seconds += write_seconds;
+					stats.records += block.size();
+					stats.bytes += bytes;
+					block.clear();
+					spare_blocks.push_back(std::move(block));
+					writing = false;
+					idle.notify_all();
+				}
+			}
+
+			std::unique_ptr<SinkBackend> backend;
+			const size_t block_records;
+			const size_t max_pending_blocks;
+			mutable std::mutex mutex;
+			std::condition_variable not_empty, not_full, idle;
+			std::deque< std::vector<TestVector> > queue;
+			std::vector< std::vector<TestVector> > spare_blocks;
+			bool closing, writing;
+			std::exception_ptr error;
+			Statistics stats;
+			std::chrono::steady_clock::time_point start;
+			std::thread writer;
+		};
+
+		// text sink on std::cout, the default destination of the generators
+		inline ResultSink& StandardOutputSink() {
+			static ResultSink sink(std::unique_ptr<SinkBackend>(new TextSinkBackend(std::cout)));
+			return sink;
+		}
+
+		inline void ReportSinkStatistics(std::ostream& ostr, const ResultSink::Statistics& stats) {
+			ostr << "sink: " << stats.records << " records, " << stats.bytes << " bytes, "
+				<< stats.BytesPerSecond() / 1.0e6 << " MB/s over " << stats.seconds << " s, "
+				<< stats.WriteBytesPerSecond() / 1.0e6 << " MB/s while writing, "
+				<< stats.stalls << " backpressure stalls (" << stats.stall_seconds << " s)" << std::endl;
+		}
+
+	}; // namespace qa
+};  // namespace sw
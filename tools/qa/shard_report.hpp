@@ -0,0 +1,138 @@
+#pragma once
+// shard_report.hpp: summaries of (partial) random test sweeps that can be merged into one report
+//
+// Copyright (C) 2017 Stillwater Supercomputing, Inc.
+//
+// This file is part of the universal numbers project, which is released under an MIT Open Source license.
+#include <cstdint>
+#include <algorithm>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace sw {
+	namespace qa {
+
+		// first element of slice k when [begin, end) is split into nrOfSlices contiguous slices
+		inline uint64_t SliceBegin(uint64_t begin, uint64_t end, unsigned k, unsigned nrOfSlices) {
+			return begin + (end - begin) / nrOfSlices * k + std::min<uint64_t>(k, (end - begin) % nrOfSlices);
+		}
+
+		// The cases [begin, end) that shard k of nrOfShards runs of a sweep of total cases, narrowed down to
+		// at most count cases from start on; a start past the shard gives the empty range [end, end).
+		inline std::pair<uint64_t, uint64_t> ShardRange(uint64_t total, unsigned shard, unsigned nrOfShards, uint64_t start = 0, uint64_t count = UINT64_MAX) {
+			uint64_t end = SliceBegin(0, total, shard + 1, nrOfShards);
+			uint64_t begin = std::min(std::max(SliceBegin(0, total, shard, nrOfShards), start), end);
+			if (count < end - begin) end = begin + count;
+			return std::make_pair(begin, end);
+		}
+
+		// A sweep is identified by (nbits, es, op, seed, sampler, total); a shard covers the case indices in [begin, end).
+		struct ShardReport {
+			size_t nbits = 0, es = 0;
+			std::string op;
+			uint64_t seed = 0;
+			std::string sampler = "uniform";                        // operand sampler, see OperandSampler
+			uint64_t total = 0;
+			std::vector< std::pair<uint64_t, uint64_t> > ranges;   // covered [begin, end) ranges
+			std::vector<uint64_t> failed_cases;                     // case indices that failed
+
+			bool SameSweep(const ShardReport& rhs) const {
+				return nbits == rhs.nbits && es == rhs.es && op == rhs.op && seed == rhs.seed && sampler == rhs.sampler && total == rhs.total;
+			}
+
+			uint64_t CoveredCases() const {
+				uint64_t covered = 0;
+				for (auto& r : ranges) covered += r.second - r.first;
+				return covered;
+			}
+
+			// true when the ranges tile [0, total) without gaps or overlaps
+			bool Complete() const {
+				auto sorted = ranges;
+				std::sort(sorted.begin(), sorted.end());
+				uint64_t next = 0;
+				for (auto& r : sorted) {
+					if (r.first != next) return false;
+					next = r.second;
+				}
+				return next == total;
+			}
+		};
+
+		inline void WriteShardReport(std::ostream& ostr, const ShardReport& report) {
+			ostr << "smoke_randoms_report 1\n";
+			ostr << "posit " << report.nbits << " " << report.es << "\n";
+			ostr << "op " << report.op << "\n";
+			ostr << "seed " << report.seed << "\n";
+			ostr << "sampler " << report.sampler << "\n";
+			ostr << "total " << report.total << "\n";
+			for (auto& r : report.ranges) ostr << "range " << r.first << " " << r.second << "\n";
+			ostr << "failures " << report.failed_cases.size() << "\n";
+			for (auto i : report.failed_cases) ostr << "case " << i << "\n";
+		}
+
+		inline ShardReport ReadShardReport(std::istream& istr) {
+			ShardReport report;
+			std::string line, key;
+			if (!std::getline(istr, line) || line != "smoke_randoms_report 1") throw std::runtime_error("not a smoke_randoms report");
+			while (std::getline(istr, line)) {
+				std::istringstream fields(line);
+				fields >> key;
+				if (key == "posit") fields >> report.nbits >> report.es;
+				else if (key == "op") fields >> report.op;
+				else if (key == "seed") fields >> report.seed;
+				else if (key == "sampler") fields >> report.sampler;
+				else if (key == "total") fields >> report.total;
+				else if (key == "range") {
+					uint64_t begin, end;
+					fields >> begin >> end;
+					if (!fields.fail() && begin > end) throw std::runtime_error("reversed range in report line: " + line);
+					report.ranges.emplace_back(begin, end);
+				}
+				else if (key == "case") {
+					uint64_t i;
+					fields >> i;
+					report.failed_cases.push_back(i);
+				}
+				if (fields.fail()) throw std::runtime_error("malformed report line: " + line);
+			}
+			return report;
+		}
+
+		// combine the shards of one sweep; throws when they belong to different sweeps or overlap
+		inline ShardReport MergeShardReports(const std::vector<ShardReport>& shards) {
+			if (shards.empty()) throw std::runtime_error("no shard reports to merge");
+			ShardReport merged = shards.front();
+			merged.ranges.clear();
+			merged.failed_cases.clear();
+			for (auto& shard : shards) {
+				if (!shard.SameSweep(merged)) throw std::runtime_error("shard reports belong to different sweeps");
+				for (auto& r : shard.ranges) {
+					if (r.first > r.second) throw std::runtime_error("shard report has a reversed range");
+					if (r.second > shard.total) throw std::runtime_error("shard report has a range past the end of the sweep");
+				}
+				merged.ranges.insert(merged.ranges.end(), shard.ranges.begin(), shard.ranges.end());
+				merged.failed_cases.insert(merged.failed_cases.end(), shard.failed_cases.begin(), shard.failed_cases.end());
+			}
+			std::sort(merged.ranges.begin(), merged.ranges.end());
+			for (size_t i = 1; i < merged.ranges.size(); i++) {
+				if (merged.ranges[i].first < merged.ranges[i - 1].second) throw std::runtime_error("shard reports overlap");
+			}
+			// coalesce adjacent ranges
+			std::vector< std::pair<uint64_t, uint64_t> > coalesced;
+			for (auto& r : merged.ranges) {
+				if (!coalesced.empty() && coalesced.back().second == r.first) coalesced.back().second = r.second;
+				else coalesced.push_back(r);
+			}
+			merged.ranges = coalesced;
+			std::sort(merged.failed_cases.begin(), merged.failed_cases.end());
+			return merged;
+		}
+
+	}; // namespace qa
+};  // namespace sw
@@ -1,4 +1,4 @@
-// smoke_sub.cpp: generate smoke tests for subtraction
+// smoke_randoms.cpp: generate random smoke tests for the binary operators
 //
 // Copyright (C) 2017 Stillwater Supercomputing, Inc.
 //
@@ -7,56 +7,252 @@
 #include "common.hpp"
 #include <chrono>
 #include <ctime>
+#include <memory>
+#include <thread>
+#include <tuple>
+#include <vector>
 
 #include <posit>
 #include "../tests/posit_test_helpers.hpp"
 #include "qa_helpers.hpp"
+#include "shard_report.hpp"
 
 using namespace std;
 
 template<size_t nbits, size_t es>
-int GenerateSmokeTests(bool bReportIndividualTestCases, std::string& cmd, unsigned nrOfRandoms = 10) {
+int GenerateSmokeTests(bool bReportIndividualTestCases, std::string& cmd, uint64_t nrOfRandoms = 10, const sw::qa::RandomTestOptions& options = sw::qa::RandomTestOptions()) {
 	int nrOfFailedTestCases = 0;
 	if (cmd == "add") {
-		nrOfFailedTestCases = sw::qa::SmokeTestRandoms<nbits, es>("random smoke testing", sw::qa::OPCODE_ADD, nrOfRandoms);
+		nrOfFailedTestCases = sw::qa::SmokeTestRandoms<nbits, es>("random smoke testing", sw::qa::OPCODE_ADD, nrOfRandoms, options);
 	}
 	else if (cmd == "sub") {
-		nrOfFailedTestCases = sw::qa::SmokeTestRandoms<nbits, es>("random smoke testing", sw::qa::OPCODE_SUB, nrOfRandoms);
+		nrOfFailedTestCases = sw::qa::SmokeTestRandoms<nbits, es>("random smoke testing", sw::qa::OPCODE_SUB, nrOfRandoms, options);
 	}
 	else if (cmd == "mul") {
-		nrOfFailedTestCases = sw::qa::SmokeTestRandoms<nbits, es>("random smoke testing", sw::qa::OPCODE_MUL, nrOfRandoms);
+		nrOfFailedTestCases = sw::qa::SmokeTestRandoms<nbits, es>("random smoke testing", sw::qa::OPCODE_MUL, nrOfRandoms, options);
 	}
 	else if (cmd == "div") {
-		nrOfFailedTestCases = sw::qa::SmokeTestRandoms<nbits, es>("random smoke testing", sw::qa::OPCODE_DIV, nrOfRandoms);
+		nrOfFailedTestCases = sw::qa::SmokeTestRandoms<nbits, es>("random smoke testing", sw::qa::OPCODE_DIV, nrOfRandoms, options);
 	}
 	
 	return nrOfFailedTestCases;
 }
 
+// Run the same sweep with 1, 2, 4, .. maxThreads workers and report the speedup
+template<size_t nbits, size_t es>
+int ReportScaling(std::string& cmd, uint64_t nrOfRandoms, sw::qa::RandomTestOptions options) {
+	const unsigned maxThreads = options.nrOfThreads;
+	options.sink = nullptr;
+	options.standard_output = false;
+	vector<unsigned> thread_counts;
+	for (unsigned t = 1; t < maxThreads; t *= 2) thread_counts.push_back(t);
+	thread_counts.push_back(maxThreads);
+
+	int nrOfFailedTestCases = 0;
+	double serial = 0.0;
+	options.failed_cases = nullptr;
+	const uint64_t nrOfCases = std::min(options.end, nrOfRandoms) - std::min(options.begin, std::min(options.end, nrOfRandoms));
+	cout << "posit<" << nbits << "," << es << "> " << cmd << " scaling over " << nrOfCases << " randoms" << endl;
+	cout << setw(8) << "threads" << setw(14) << "seconds" << setw(16) << "ops/sec" << setw(10) << "speedup" << setw(12) << "efficiency" << endl;
+	for (unsigned t : thread_counts) {
+		options.nrOfThreads = t;
+		auto start = chrono::steady_clock::now();
+		nrOfFailedTestCases += GenerateSmokeTests<nbits, es>(false, cmd, nrOfRandoms, options);
+		double elapsed = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+		if (t == 1) serial = elapsed;
+		cout << dec << setw(8) << t << fixed << setprecision(3) << setw(14) << elapsed
+			<< scientific << setprecision(3) << setw(16) << nrOfCases / elapsed
+			<< fixed << setprecision(2) << setw(10) << serial / elapsed << setw(12) << serial / elapsed / t << endl;
+	}
+	return nrOfFailedTestCases;
+}
+
+template<size_t nbits, size_t es>
+int Run(bool bReportIndividualTestCases, std::string& cmd, uint64_t nrOfRandoms, sw::qa::RandomTestOptions options, bool bScaling, const std::string& reportFile, bool bStrata,
+        unsigned saturationChunks, const std::string& coverageFile) {
+	if (bScaling) return ReportScaling<nbits, es>(cmd, nrOfRandoms, options);
+
+	sw::qa::OperandStrata strata(nbits, es);
+	if (bStrata) options.strata = &strata;
+	std::unique_ptr<sw::qa::CoverageMap> coverage;
+	if (saturationChunks > 0 || !coverageFile.empty()) {
+		coverage.reset(new sw::qa::CoverageMap(nbits, es, saturationChunks));
+		options.coverage = coverage.get();
+	}
+
+	sw::qa::ShardReport report;
+	report.nbits = nbits;
+	report.es = es;
+	report.op = cmd;
+	report.seed = options.seed;
+	report.sampler = sw::qa::sampler_string(options.sampler);
+	report.total = nrOfRandoms;
+	// a sweep that stops at saturation reports the prefixes of the worker slices that it ran
+	if (coverage) options.ranges = &report.ranges;
+	else report.ranges.emplace_back(std::min(options.begin, std::min(options.end, nrOfRandoms)), std::min(options.end, nrOfRandoms));
+	options.failed_cases = &report.failed_cases;
+	int nrOfFailedTestCases = GenerateSmokeTests<nbits, es>(bReportIndividualTestCases, cmd, nrOfRandoms, options);
+	if (bStrata) strata.Report(cerr);
+	if (coverage) {
+		coverage->Report(cerr, "posit<" + std::to_string(nbits) + "," + std::to_string(es) + "> " + cmd);
+		if (!coverageFile.empty()) {
+			ofstream ostr(coverageFile);
+			coverage->WriteCurve(ostr);
+			if (!ostr) throw std::runtime_error("unable to write coverage " + coverageFile);
+		}
+	}
+	if (!reportFile.empty()) {
+		ofstream ostr(reportFile);
+		sw::qa::WriteShardReport(ostr, report);
+		if (!ostr) throw std::runtime_error("unable to write report " + reportFile);
+	}
+	return nrOfFailedTestCases;
+}
+
+// Merge the reports of the shards of a sweep into one; fails when a shard failed or is missing
+int MergeReports(const vector<string>& files, const std::string& reportFile) {
+	vector<sw::qa::ShardReport> shards;
+	for (auto& file : files) {
+		ifstream istr(file);
+		if (!istr) throw std::runtime_error("unable to open report " + file);
+		shards.push_back(sw::qa::ReadShardReport(istr));
+	}
+	sw::qa::ShardReport merged = sw::qa::MergeShardReports(shards);
+	if (reportFile.empty()) {
+		sw::qa::WriteShardReport(cout, merged);
+	}
+	else {
+		ofstream ostr(reportFile);
+		sw::qa::WriteShardReport(ostr, merged);
+	}
+	cerr << "Merged " << shards.size() << " shards: " << merged.CoveredCases() << " of " << merged.total << " cases, "
+		<< merged.failed_cases.size() << " failures" << (merged.Complete() ? "" : ", sweep INCOMPLETE") << endl;
+	return (merged.failed_cases.empty() && merged.Complete()) ? 0 : 1;
+}
+
 // Generate smoke tests for different posit configurations
-// Usage: qa_smoke_randoms 16/24/32/48/64
+// Usage: qa_smoke_randoms [16/24/32/48/64 [add/sub/mul/div [nrOfRandoms]]] [--threads N] [--scaling]
+//                         [--seed S] [--shard k/N] [--start i] [--count n] [--report file] [--vectors file | --csv file] [--chunk n]
+//                         [--events file] [--sampler uniform|stratified] [--strata] [--until-saturated K] [--coverage file]
+//        qa_smoke_randoms --merge report1 report2 .. [--report file]
+//   --threads N   split the work across N workers, 0 selects the number of hardware threads
+//   --scaling     time the sweep with 1, 2, 4, .. N workers instead of emitting test vectors
+//   --seed S      seed of the counter-based generator; a random seed is drawn and printed otherwise
+//   --shard k/N   run the k-th of N equal slices of the sweep (0 <= k < N)
+//   --start i     run the sweep from case i on, e.g. to reproduce a reported failure with --count 1
+//   --count n     run at most n cases
+//   --report file write a mergeable summary of the cases run and the failing case indices
+//   --vectors file write the test vectors to a binary test vector file instead of std::cout
+//   --csv file    write the test vectors as csv instead of std::cout
+//   --chunk n     cases per chunk that a worker generates, tests and discards at once (default 4096)
+//   --events file write the arithmetic event counts of the sweep as JSON (needs EF_TENSORS_EVENT_COUNTERS)
+//   --sampler s   draw the operands as uniform random encodings (default), or stratified by regime, exponent
+//                 and fraction class, which reaches long regimes and rounding boundaries with far fewer cases
+//   --strata      report the strata of regime, exponent and fraction class that the operands hit
+//   --until-saturated K  stop the sweep once K chunks in a row covered no new cell of the rounding coverage map:
+//                 regime and exponent of the result by rounding outcome; the report lists the cases actually run
+//   --coverage file      write the coverage curve, cases and seconds at which new cells were covered, as csv
+//   --merge       combine shard reports into one report of the whole sweep
 int main(int argc, char** argv)
 try {
 	typedef std::numeric_limits< double > dbl;
 	//cerr << "double max digits " << dbl::max_digits10 << endl;
 
-	unsigned nrOfRandoms = 10;
+	uint64_t nrOfRandoms = 10;
+	sw::qa::RandomTestOptions options;
+	bool bScaling = false, bMerge = false, bStrata = false, bSeed = false;
+	unsigned shard = 0, nrOfShards = 1;
+	uint64_t start = 0, count = UINT64_MAX;
+	string reportFile, eventsFile, coverageFile;
+	unsigned saturationChunks = 0;
+	std::unique_ptr<sw::qa::ResultSink> fileSink;
+
+	vector<string> args;
+	for (int i = 1; i < argc; i++) {
+		string arg = argv[i];
+		if (arg == "--threads" && i + 1 < argc) {
+			options.nrOfThreads = unsigned(std::stoul(argv[++i]));
+			if (options.nrOfThreads == 0) options.nrOfThreads = std::max(1u, std::thread::hardware_concurrency());
+		}
+		else if (arg == "--scaling") {
+			bScaling = true;
+		}
+		else if (arg == "--seed" && i + 1 < argc) {
+			options.seed = std::stoull(argv[++i], nullptr, 0);
+			bSeed = true;
+		}
+		else if (arg == "--shard" && i + 1 < argc) {
+			string spec = argv[++i];
+			size_t slash = spec.find('/');
+			if (slash == string::npos) throw "--shard expects k/N";
+			shard = unsigned(std::stoul(spec.substr(0, slash)));
+			nrOfShards = unsigned(std::stoul(spec.substr(slash + 1)));
+			if (nrOfShards == 0 || shard >= nrOfShards) throw "--shard expects 0 <= k < N";
+		}
+		else if (arg == "--start" && i + 1 < argc) {
+			start = std::stoull(argv[++i]);
+		}
+		else if (arg == "--count" && i + 1 < argc) {
+			count = std::stoull(argv[++i]);
+		}
+		else if (arg == "--report" && i + 1 < argc) {
+			reportFile = argv[++i];
+		}
+		else if (arg == "--vectors" && i + 1 < argc) {
+			fileSink.reset(new sw::qa::ResultSink(std::unique_ptr<sw::qa::SinkBackend>(new sw::qa::BinarySinkBackend(argv[++i]))));
+		}
+		else if (arg == "--csv" && i + 1 < argc) {
+			fileSink.reset(new sw::qa::ResultSink(std::unique_ptr<sw::qa::SinkBackend>(new sw::qa::CsvSinkBackend(argv[++i]))));
+		}
+		else if (arg == "--chunk" && i + 1 < argc) {
+			options.chunk_size = size_t(std::stoull(argv[++i]));
+		}
+		else if (arg == "--events" && i + 1 < argc) {
+			eventsFile = argv[++i];
+		}
+		else if (arg == "--sampler" && i + 1 < argc) {
+			string sampler = argv[++i];
+			if (sampler == "uniform") options.sampler = sw::qa::OperandSampler::Uniform;
+			else if (sampler == "stratified") options.sampler = sw::qa::OperandSampler::Stratified;
+			else throw "--sampler expects uniform or stratified";
+		}
+		else if (arg == "--strata") {
+			bStrata = true;
+		}
+		else if (arg == "--until-saturated" && i + 1 < argc) {
+			saturationChunks = unsigned(std::stoul(argv[++i]));
+			if (saturationChunks == 0) throw "--until-saturated expects a positive number of chunks";
+		}
+		else if (arg == "--coverage" && i + 1 < argc) {
+			coverageFile = argv[++i];
+		}
+		else if (arg == "--merge") {
+			bMerge = true;
+		}
+		else {
+			args.push_back(arg);
+		}
+	}
+	if (bMerge) return MergeReports(args, reportFile);
+	// the entropy is read once here, and the seed is printed below so that the run can be reproduced
+	if (!bSeed) options.seed = sw::qa::EntropySeed();
+	if (fileSink) options.sink = fileSink.get();
 
 	int posit_size = 32;  // default
 	std::string cmd = "add";
-	if (argc == 2) {
-		posit_size = std::stoi(argv[1]);
+	if (args.size() > 0) {
+		posit_size = std::stoi(args[0]);
 	}
-	else if (argc == 3) {
-		posit_size = std::stoi(argv[1]);
-		cmd = argv[2];
+	if (args.size() > 1) {
+		cmd = args[1];
 	}
-	else if (argc == 4) {
-		posit_size = std::stoi(argv[1]);
-		cmd = argv[2];
-		nrOfRandoms = std::stoi(argv[3]);
+	if (args.size() > 2) {
+		nrOfRandoms = std::stoull(args[2]);
 	}
-	cerr << "Generating random smoke tests for posits of size " << posit_size << " and command " << cmd << endl;
+	// the shard selects a slice of the sweep, start/count narrow it down further
+	std::tie(options.begin, options.end) = sw::qa::ShardRange(nrOfRandoms, shard, nrOfShards, start, count);
+	cerr << "Generating random smoke tests for posits of size " << posit_size << " and command " << cmd << " on " << options.nrOfThreads << " threads" << endl;
+	cerr << "seed " << options.seed << " cases [" << std::min(options.begin, options.end) << ", " << options.end << ") of " << nrOfRandoms << ", " << sw::qa::sampler_string(options.sampler) << " operands" << endl;
 
 	bool bReportIndividualTestCases = true;
 	int nrOfFailedTestCases = 0;
@@ -64,23 +260,31 @@ try {
 
 	switch (posit_size) {
 	case 16:
-		nrOfFailedTestCases = GenerateSmokeTests<16, 1>(bReportIndividualTestCases, cmd, nrOfRandoms);
+		nrOfFailedTestCases = Run<16, 1>(bReportIndividualTestCases, cmd, nrOfRandoms, options, bScaling, reportFile, bStrata, saturationChunks, coverageFile);
 		break;
 	case 24:
-		nrOfFailedTestCases = GenerateSmokeTests<24, 1>(bReportIndividualTestCases, cmd, nrOfRandoms);
+		nrOfFailedTestCases = Run<24, 1>(bReportIndividualTestCases, cmd, nrOfRandoms, options, bScaling, reportFile, bStrata, saturationChunks, coverageFile);
 		break;
 	case 32:
-		nrOfFailedTestCases = GenerateSmokeTests<32, 2>(bReportIndividualTestCases, cmd, nrOfRandoms);
+		nrOfFailedTestCases = Run<32, 2>(bReportIndividualTestCases, cmd, nrOfRandoms, options, bScaling, reportFile, bStrata, saturationChunks, coverageFile);
 		break;
 	case 48:
-		nrOfFailedTestCases = GenerateSmokeTests<48, 2>(bReportIndividualTestCases, cmd, nrOfRandoms);
+		nrOfFailedTestCases = Run<48, 2>(bReportIndividualTestCases, cmd, nrOfRandoms, options, bScaling, reportFile, bStrata, saturationChunks, coverageFile);
 		break;
 	case 64:
-		nrOfFailedTestCases = GenerateSmokeTests<64, 3>(bReportIndividualTestCases, cmd, nrOfRandoms);
+		nrOfFailedTestCases = Run<64, 3>(bReportIndividualTestCases, cmd, nrOfRandoms, options, bScaling, reportFile, bStrata, saturationChunks, coverageFile);
 		break;
 	default:
 		nrOfFailedTestCases = 1;
 	}
+	if (fileSink) fileSink->Close();
+	if (!bScaling) sw::qa::ReportSinkStatistics(cerr, sw::qa::VectorSink(options)->statistics());
+	if (!eventsFile.empty()) {
+		if (!event_counters_enabled) cerr << "event counters are compiled out, rebuild with EF_TENSORS_EVENT_COUNTERS to count events" << endl;
+		ofstream ostr(eventsFile);
+		write_event_counts_json(ostr, collect_event_counts());
+		if (!ostr) throw std::runtime_error("unable to write events " + eventsFile);
+	}
 
 	return (nrOfFailedTestCases > 0 ? EXIT_FAILURE : EXIT_SUCCESS);
 }
@@ -88,6 +292,10 @@ catch (char const* msg) {
 	cerr << msg << endl;
 	return EXIT_FAILURE;
 }
+catch (const std::exception& err) {
+	cerr << err.what() << endl;
+	return EXIT_FAILURE;
+}
 catch (...) {
 	cerr << "Caught unknown exception" << endl;
 	return EXIT_FAILURE;
@@ -0,0 +1,241 @@
+#pragma once
+// stratified_sampler.hpp: regime-aware stratified operands for random posit testing, and the strata they hit
+//
+// Copyright (C) 2017 Stillwater Supercomputing, Inc.
+//
+// This file is part of the universal numbers project, which is released under an MIT Open Source license.
+#include <cstdint>
+#include <algorithm>
+#include <array>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace sw {
+	namespace qa {
+
+		// A uniformly drawn encoding has a regime run of length m with probability 2^-m, so nearly all random
+		// operands lie within a few binades of +-1, and long regimes, truncated exponents and fractions that sit
+		// on a rounding boundary are almost never drawn. The stratified sampler picks the stratum of an operand
+		// first and the remaining bits second. A stratum is
+		//   the regime k in [-(nbits-2), nbits-2]      which fixes the length of the regime run
+		//   the exponent field                         of the es bits, or the fewer that the regime leaves
+		//   the fraction class                         zero, all ones, last bit only, or any other pattern
+		// and all three are drawn uniformly among the choices that the format can encode.
+
+		enum class OperandSampler { Uniform, Stratified };
+
+		inline const char* sampler_string(OperandSampler sampler) {
+			return sampler == OperandSampler::Stratified ? "stratified" : "uniform";
+		}
+
+		// fraction patterns: the exact binade boundaries, the patterns next to a carry into the exponent,
+		// the patterns one ulp off a boundary, and the rest
+		constexpr unsigned NR_FRACTION_CLASSES = 4;
+		enum FractionClass { FRACTION_ZERO = 0, FRACTION_ONES = 1, FRACTION_LSB = 2, FRACTION_OTHER = 3 };
+		constexpr const char* FRACTION_CLASS_NAMES[NR_FRACTION_CLASSES] = { "zero", "ones", "lsb", "other" };
+
+		// field widths of the encodings of regime k
+		struct RegimeLayout {
+			unsigned regime_bits;     // the run and its terminating bit, when there is room for it
+			unsigned exponent_bits;   // the exponent bits that fit after the regime
+			unsigned fraction_bits;
+		};
+		inline RegimeLayout LayoutOfRegime(size_t nbits, size_t es, int k) {
+			unsigned run = k >= 0 ? unsigned(k) + 1 : unsigned(-k);
+			unsigned regime_bits = std::min<unsigned>(run + 1, unsigned(nbits - 1));
+			unsigned exponent_bits = std::min<unsigned>(unsigned(es), unsigned(nbits - 1) - regime_bits);
+			return { regime_bits, exponent_bits, unsigned(nbits - 1) - regime_bits - exponent_bits };
+		}
+
+		inline unsigned NrOfRegimes(size_t nbits) { return unsigned(2 * nbits - 3); }
+		inline unsigned NrOfFractionClasses(unsigned fraction_bits) { return fraction_bits == 0 ? 1 : (fraction_bits == 1 ? 2 : NR_FRACTION_CLASSES); }
+		inline uint64_t LowMask(unsigned bits) { return bits >= 64 ? ~uint64_t(0) : (uint64_t(1) << bits) - 1; }
+
+		struct OperandStratum {
+			int k;                     // regime
+			unsigned exponent;         // exponent field, exponent_bits wide
+			unsigned fraction_class;
+		};
+
+		// Draw a stratum uniformly from the bits of a random word.
+		inline OperandStratum DrawStratum(size_t nbits, size_t es, uint64_t bits) {
+			OperandStratum s;
+			s.k = int(bits % NrOfRegimes(nbits)) - int(nbits - 2);
+			bits /= NrOfRegimes(nbits);
+			RegimeLayout layout = LayoutOfRegime(nbits, es, s.k);
+			s.exponent = unsigned(bits & LowMask(layout.exponent_bits));
+			bits >>= es;
+			s.fraction_class = unsigned(bits % NrOfFractionClasses(layout.fraction_bits));
+			return s;
+		}
+
+		// The stratum of regime k and exponent field of the given scale, clamped to the dynamic range,
+		// with the exponent bits the regime truncates dropped.
+		inline OperandStratum StratumOfScale(size_t nbits, size_t es, int64_t scale, unsigned fraction_class) {
+			const int64_t useed_scale = int64_t(1) << es;
+			int64_t k = (scale >= 0 ? scale : scale - (useed_scale - 1)) / useed_scale;     // floor
+			int64_t exponent = scale - k * useed_scale;
+			k = std::max<int64_t>(-int64_t(nbits - 2), std::min<int64_t>(int64_t(nbits - 2), k));
+			RegimeLayout layout = LayoutOfRegime(nbits, es, int(k));
+			OperandStratum s;
+			s.k = int(k);
+			s.exponent = unsigned(exponent) >> (es - layout.exponent_bits);
+			s.fraction_class = std::min(fraction_class, NrOfFractionClasses(layout.fraction_bits) - 1);
+			return s;
+		}
+
+		// scale of the encodings of a stratum, as the power of 2 of their leading bit
+		inline int64_t ScaleOfStratum(size_t es, const OperandStratum& s, const RegimeLayout& layout) {
+			return int64_t(s.k) * (int64_t(1) << es) + (int64_t(s.exponent) << (es - layout.exponent_bits));
+		}
+
+		// The nbits encoding of a stratum with the given sign; the fraction of class FRACTION_OTHER comes from random_fraction.
+		inline uint64_t EncodeStratum(size_t nbits, size_t es, const OperandStratum& s, bool negative, uint64_t random_fraction) {
+			RegimeLayout layout = LayoutOfRegime(nbits, es, s.k);
+			const uint64_t fraction_mask = LowMask(layout.fraction_bits);
+			uint64_t fraction = 0;
+			switch (s.fraction_class) {
+			case FRACTION_ZERO: fraction = 0; break;
+			case FRACTION_ONES: fraction = fraction_mask; break;
+			case FRACTION_LSB:  fraction = 1; break;
+			default:
+				fraction = random_fraction & fraction_mask;
+				if (fraction == 0 || fraction == fraction_mask || fraction == 1) fraction = 2;
+				break;
+			}
+			unsigned run = s.k >= 0 ? unsigned(s.k) + 1 : unsigned(-s.k);
+			uint64_t regime = s.k >= 0 ? LowMask(run) << (layout.regime_bits - run) : 1;
+			uint64_t bits = (((regime << layout.exponent_bits) | s.exponent) << layout.fraction_bits) | fraction;
+			return (negative ? 0 - bits : bits) & LowMask(unsigned(nbits));
+		}
+
+		// The stratum of an nbits encoding, false for 0 and NaR.
+		inline bool StratumOf(size_t nbits, size_t es, uint64_t raw, OperandStratum& s) {
+			const uint64_t sign_bit = uint64_t(1) << (nbits - 1);
+			raw &= LowMask(unsigned(nbits));
+			if (raw == 0 || raw == sign_bit) return false;
+			if (raw & sign_bit) raw = (0 - raw) & LowMask(unsigned(nbits));
+			const bool r0 = (raw >> (nbits - 2)) & 1;
+			unsigned run = 0;
+			while (run < nbits - 1 && bool((raw >> (nbits - 2 - run)) & 1) == r0) run++;
+			s.k = r0 ? int(run) - 1 : -int(run);
+			RegimeLayout layout = LayoutOfRegime(nbits, es, s.k);
+			s.exponent = unsigned((raw >> layout.fraction_bits) & LowMask(layout.exponent_bits));
+			const uint64_t fraction = raw & LowMask(layout.fraction_bits);
+			if (fraction == 0) s.fraction_class = FRACTION_ZERO;
+			else if (fraction == LowMask(layout.fraction_bits)) s.fraction_class = FRACTION_ONES;
+			else if (fraction == 1) s.fraction_class = FRACTION_LSB;
+			else s.fraction_class = FRACTION_OTHER;
+			return true;
+		}
+
+		// Operand pair of the stratified sampler from the random words of a case. Half of the second operands
+		// are drawn like the first, a quarter share the regime and exponent of the first, which aligns the
+		// fractions and drives cancellation in add/sub and carries in mul, and a quarter have their leading bit
+		// one position around the last fraction bit of the first, where the guard and sticky bits of add/sub decide.
+		inline void StratifiedPair(size_t nbits, size_t es, const std::array<uint64_t, 2>& bits_a, const std::array<uint64_t, 2>& bits_b,
+		                           uint64_t& a, uint64_t& b) {
+			OperandStratum sa = DrawStratum(nbits, es, bits_a[0] >> 1);
+			a = EncodeStratum(nbits, es, sa, bits_a[0] & 1, bits_a[1]);
+
+			const unsigned relation = unsigned(bits_b[0] & 3);
+			uint64_t decisions = bits_b[0] >> 2;
+			const bool negative = decisions & 1;
+			decisions >>= 1;
+			OperandStratum sb = DrawStratum(nbits, es, decisions);
+			if (relation == 2) {
+				sb = StratumOfScale(nbits, es, ScaleOfStratum(es, sa, LayoutOfRegime(nbits, es, sa.k)), sb.fraction_class);
+			}
+			else if (relation == 3) {
+				RegimeLayout layout = LayoutOfRegime(nbits, es, sa.k);
+				int64_t offset = int64_t((decisions >> 32) % 3) - 1;
+				int64_t scale = ScaleOfStratum(es, sa, layout) - int64_t(layout.fraction_bits) - 1 + offset;
+				sb = StratumOfScale(nbits, es, scale, sb.fraction_class);
+			}
+			b = EncodeStratum(nbits, es, sb, negative, bits_b[1]);
+		}
+
+		// Histogram of the strata that the operands of a sweep fall into.
+		class OperandStrata {
+		public:
+			OperandStrata(size_t nbits, size_t es) : nbits(nbits), es(es), hits(size_t(NrOfRegimes(nbits)) * NR_FRACTION_CLASSES << es, 0), specials(0) {}
+
+			void Record(uint64_t raw) {
+				OperandStratum s = {};
+				if (StratumOf(nbits, es, raw, s)) ++hits[Index(s)];
+				else ++specials;
+			}
+
+			void Merge(const OperandStrata& rhs) {
+				for (size_t i = 0; i < hits.size(); i++) hits[i] += rhs.hits[i];
+				specials += rhs.specials;
+			}
+
+			// strata the format can encode, and those of them that the sweep hit
+			size_t Reachable() const {
+				size_t reachable = 0;
+				for (int k = -int(nbits - 2); k <= int(nbits - 2); k++) {
+					RegimeLayout layout = LayoutOfRegime(nbits, es, k);
+					reachable += (size_t(1) << layout.exponent_bits) * NrOfFractionClasses(layout.fraction_bits);
+				}
+				return reachable;
+			}
+			size_t Hit() const { return size_t(std::count_if(hits.begin(), hits.end(), [](uint64_t h) { return h > 0; })); }
+
+			uint64_t Operands() const {
+				uint64_t operands = specials;
+				for (auto h : hits) operands += h;
+				return operands;
+			}
+
+			void Report(std::ostream& ostr) const {
+				size_t reachable_binades = 0, binades = 0, regimes = 0;
+				uint64_t classes[NR_FRACTION_CLASSES] = { 0 };
+				std::vector<uint64_t> hit;
+				for (int k = -int(nbits - 2); k <= int(nbits - 2); k++) {
+					RegimeLayout layout = LayoutOfRegime(nbits, es, k);
+					bool regime_hit = false;
+					for (unsigned e = 0; e < (1u << layout.exponent_bits); e++) {
+						bool binade_hit = false;
+						for (unsigned c = 0; c < NR_FRACTION_CLASSES; c++) {
+							uint64_t h = hits[Index({ k, e, c })];
+							classes[c] += h;
+							if (h > 0) hit.push_back(h);
+							binade_hit = binade_hit || h > 0;
+						}
+						reachable_binades++;
+						if (binade_hit) binades++;
+						regime_hit = regime_hit || binade_hit;
+					}
+					if (regime_hit) regimes++;
+				}
+				std::sort(hit.begin(), hit.end());
+				const uint64_t operands = Operands();
+				const size_t reachable = Reachable();
+				ostr << "operand strata of posit<" << nbits << "," << es << ">: " << hit.size() << " of " << reachable << " hit ("
+				     << std::fixed << std::setprecision(1) << 100.0 * double(hit.size()) / double(reachable) << "%) by " << operands << " operands, "
+				     << specials << " zero or NaR\n";
+				ostr << "  regimes hit         " << regimes << " of " << NrOfRegimes(nbits) << '\n';
+				ostr << "  regime x exponent   " << binades << " of " << reachable_binades << '\n';
+				ostr << "  fraction classes   ";
+				for (unsigned c = 0; c < NR_FRACTION_CLASSES; c++) ostr << ' ' << FRACTION_CLASS_NAMES[c] << ' ' << classes[c];
+				ostr << '\n';
+				if (!hit.empty()) {
+					ostr << "  operands per hit stratum: min " << hit.front() << " median " << hit[hit.size() / 2] << " max " << hit.back() << '\n';
+				}
+			}
+
+		private:
+			size_t Index(const OperandStratum& s) const {
+				return ((size_t(s.k + int(nbits - 2)) << es) + s.exponent) * NR_FRACTION_CLASSES + s.fraction_class;
+			}
+
+			size_t nbits, es;
+			std::vector<uint64_t> hits;
+			uint64_t specials;
+		};
+
+	}; // namespace qa
+};  // namespace sw
@@ -0,0 +1,208 @@
+#pragma once
+// test_vector_file.hpp: compact binary test vector files and a memory-mapped reader to replay them
+//
+// Copyright (C) 2017 Stillwater Supercomputing, Inc.
+//
+// This file is part of the universal numbers project, which is released under an MIT Open Source license.
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#include <iterator>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "opcodes.hpp"
+
+namespace sw {
+	namespace qa {
+
+		// File layout, all integers little-endian:
+		//   offset  0  char[8]   magic "POSITVEC"
+		//   offset  8  uint32    format version
+		//   offset 12  uint16    nbits
+		//   offset 14  uint16    es
+		//   offset 16  uint32    opcode (OPCODE_ADD, ..)
+		//   offset 20  uint32    bytes per record
+		//   offset 24  uint64    number of records
+		//   offset 32  records: operand a, operand b, golden reference, each as a raw encoding in (nbits+7)/8 bytes;
+		//              OPCODE_CVT records hold the double input of operand a in 8 bytes instead
+		constexpr char     TEST_VECTOR_MAGIC[8] = { 'P', 'O', 'S', 'I', 'T', 'V', 'E', 'C' };
+		constexpr uint32_t TEST_VECTOR_VERSION = 1;
+		constexpr size_t   TEST_VECTOR_HEADER_SIZE = 32;
+
+		inline size_t EncodingBytes(size_t nbits) { return (nbits + 7) / 8; }
+		inline size_t OperandBytes(size_t nbits, int opcode) { return opcode == OPCODE_CVT ? sizeof(double) : EncodingBytes(nbits); }
+		inline size_t RecordBytes(size_t nbits, int opcode) { return OperandBytes(nbits, opcode) + 2 * EncodingBytes(nbits); }
+
+		// the IEEE-754 encoding of the double input of a conversion record
+		inline uint64_t DoubleBits(double d) {
+			uint64_t bits;
+			std::memcpy(&bits, &d, sizeof(bits));
+			return bits;
+		}
+		inline double DoubleFromBits(uint64_t bits) {
+			double d;
+			std::memcpy(&d, &bits, sizeof(d));
+			return d;
+		}
+
+		inline void StoreLittleEndian(uint8_t* dst, uint64_t value, size_t bytes) {
+			for (size_t i = 0; i < bytes; i++) dst[i] = uint8_t(value >> (8 * i));
+		}
+
+		inline uint64_t LoadLittleEndian(const uint8_t* src, size_t bytes) {
+			uint64_t value = 0;
+			for (size_t i = bytes; i-- > 0; ) value = (value << 8) | src[i];
+			return value;
+		}
+
+		// Appends (a, b, reference) records; the record count in the header is patched on Close().
+		// Not thread-safe: concurrent producers pack records with Pack() and hand over whole blocks.
+		class TestVectorWriter {
+		public:
+			TestVectorWriter(const std::string& path, size_t nbits, size_t es, int opcode)
+				: ostr(path, std::ios::binary | std::ios::trunc), nbits(nbits), opcode(opcode), count(0) {
+				if (!ostr) throw std::runtime_error("unable to create test vector file " + path);
+				uint8_t header[TEST_VECTOR_HEADER_SIZE] = {};
+				std::memcpy(header, TEST_VECTOR_MAGIC, sizeof(TEST_VECTOR_MAGIC));
+				StoreLittleEndian(header + 8, TEST_VECTOR_VERSION, 4);
+				StoreLittleEndian(header + 12, nbits, 2);
+				StoreLittleEndian(header + 14, es, 2);
+				StoreLittleEndian(header + 16, uint32_t(opcode), 4);
+				StoreLittleEndian(header + 20, RecordBytes(), 4);
+				ostr.write(reinterpret_cast<const char*>(header), sizeof(header));
+			}
+			~TestVectorWriter() {
+				try { Close(); } catch (...) {}
+			}
+			TestVectorWriter(const TestVectorWriter&) = delete;
+			TestVectorWriter& operator=(const TestVectorWriter&) = delete;
+
+			size_t RecordBytes() const { return sw::qa::RecordBytes(nbits, opcode); }
+
+			// append one packed record to a block of records
+			void Pack(std::vector<uint8_t>& block, uint64_t a, uint64_t b, uint64_t reference) const {
+				size_t bytes = EncodingBytes(nbits), operand = OperandBytes(nbits, opcode);
+				size_t offset = block.size();
+				block.resize(offset + operand + 2 * bytes);
+				StoreLittleEndian(&block[offset], a, operand);
+				StoreLittleEndian(&block[offset + operand], b, bytes);
+				StoreLittleEndian(&block[offset + operand + bytes], reference, bytes);
+			}
+
+			void Append(uint64_t a, uint64_t b, uint64_t reference) {
+				block.clear();
+				Pack(block, a, b, reference);
+				Append(block);
+			}
+
+			// append a block of packed records
+			void Append(const std::vector<uint8_t>& records) {
+				ostr.write(reinterpret_cast<const char*>(records.data()), records.size());
+				count += records.size() / RecordBytes();
+			}
+
+			uint64_t size() const { return count; }
+
+			void Close() {
+				if (!ostr.is_open()) return;
+				uint8_t field[8];
+				StoreLittleEndian(field, count, 8);
+				ostr.seekp(24);
+				ostr.write(reinterpret_cast<const char*>(field), sizeof(field));
+				ostr.close();
+				if (ostr.fail()) throw std::runtime_error("unable to finish test vector file");
+			}
+
+		private:
+			std::ofstream ostr;
+			size_t nbits;
+			int opcode;
+			uint64_t count;
+			std::vector<uint8_t> block;
+		};
+
+		struct TestVector {
+			uint64_t a, b, reference;
+		};
+
+		// Read-only view of a test vector file; the records are memory-mapped where the OS supports it.
+		class TestVectorFile {
+		public:
+			explicit TestVectorFile(const std::string& path) : base(nullptr), length(0) {
+#ifdef _WIN32
+				std::ifstream istr(path, std::ios::binary);
+				if (!istr) throw std::runtime_error("unable to open test vector file " + path);
+				contents.assign(std::istreambuf_iterator<char>(istr), std::istreambuf_iterator<char>());
+				base = reinterpret_cast<const uint8_t*>(contents.data());
+				length = contents.size();
+#else
+				int fd = ::open(path.c_str(), O_RDONLY);
+				if (fd < 0) throw std::runtime_error("unable to open test vector file " + path);
+				struct stat st;
+				if (::fstat(fd, &st) != 0) { ::close(fd); throw std::runtime_error("unable to stat test vector file " + path); }
+				length = size_t(st.st_size);
+				if (length > 0) {
+					void* mapped = ::mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+					if (mapped == MAP_FAILED) { ::close(fd); throw std::runtime_error("unable to map test vector file " + path); }
+					::madvise(mapped, length, MADV_SEQUENTIAL);
+					base = static_cast<const uint8_t*>(mapped);
+				}
+				::close(fd);
+#endif
+				if (length < TEST_VECTOR_HEADER_SIZE || std::memcmp(base, TEST_VECTOR_MAGIC, sizeof(TEST_VECTOR_MAGIC)) != 0) {
+					Unmap();
+					throw std::runtime_error(path + " is not a test vector file");
+				}
+				if (LoadLittleEndian(base + 8, 4) != TEST_VECTOR_VERSION) {
+					Unmap();
+					throw std::runtime_error(path + " has an unsupported test vector format version");
+				}
+				// the header is in bounds here; divide rather than multiply, so a corrupt record count cannot wrap around
+				if (RecordBytes() == 0 || RecordBytes() != sw::qa::RecordBytes(nbits(), opcode()) || size() > (length - TEST_VECTOR_HEADER_SIZE) / RecordBytes()) {
+					Unmap();
+					throw std::runtime_error(path + " is truncated or corrupt");
+				}
+			}
+			~TestVectorFile() { Unmap(); }
+			TestVectorFile(const TestVectorFile&) = delete;
+			TestVectorFile& operator=(const TestVectorFile&) = delete;
+
+			size_t   nbits() const { return size_t(LoadLittleEndian(base + 12, 2)); }
+			size_t   es() const { return size_t(LoadLittleEndian(base + 14, 2)); }
+			int      opcode() const { return int(LoadLittleEndian(base + 16, 4)); }
+			size_t   RecordBytes() const { return size_t(LoadLittleEndian(base + 20, 4)); }
+			uint64_t size() const { return LoadLittleEndian(base + 24, 8); }
+
+			TestVector operator[](uint64_t i) const {
+				size_t bytes = EncodingBytes(nbits()), operand = OperandBytes(nbits(), opcode());
+				const uint8_t* record = base + TEST_VECTOR_HEADER_SIZE + i * RecordBytes();
+				return TestVector{ LoadLittleEndian(record, operand), LoadLittleEndian(record + operand, bytes), LoadLittleEndian(record + operand + bytes, bytes) };
+			}
+
+		private:
+			void Unmap() {
+#ifndef _WIN32
+				if (base) ::munmap(const_cast<uint8_t*>(base), length);
+#endif
+				base = nullptr;
+			}
+
+			const uint8_t* base;
+			size_t length;
+#ifdef _WIN32
+			std::string contents;
+#endif
+		};
+
+	}; // namespace qa
+};  // namespace sw
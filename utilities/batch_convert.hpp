@@ -0,0 +1,111 @@
+// batch_convert.hpp: convert whole arrays between double and a run-time selected posit format
+//
+// Copyright (C) 2017 Stillwater Supercomputing, Inc.
+//
+// This file is part of the universal numbers project, which is released under an MIT Open Source license.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+#include <posit>
+
+#include "es_select.hpp"
+#include "nbits_select.hpp"
+#include "dispatch_table.hpp"
+#include "decode_table.hpp"
+
+/// Smallest native unsigned integer that holds an nbits encoding.
+template <std::size_t Nbits>
+using posit_storage_t = typename std::conditional<(Nbits <= 8), std::uint8_t,
+                        typename std::conditional<(Nbits <= 16), std::uint16_t,
+                        typename std::conditional<(Nbits <= 32), std::uint32_t, std::uint64_t>::type>::type>::type;
+
+/// Bytes per element in a packed posit buffer.
+constexpr std::size_t posit_storage_bytes(std::size_t nbits)
+{
+    return nbits <= 8 ? 1 : (nbits <= 16 ? 2 : (nbits <= 32 ? 4 : 8));
+}
+
+/// Encode n doubles into posit<Nbits, ES> bit patterns.
+template <std::size_t Nbits, std::size_t ES>
+void convert_to_posit(const double* in, std::size_t n, posit_storage_t<Nbits>* out)
+{
+    sw::unum::posit<Nbits, ES> p;
+    for (std::size_t i = 0; i < n; ++i) {
+        p = in[i];
+        out[i] = posit_storage_t<Nbits>(p.get().to_ullong());
+    }
+}
+
+namespace detail {
+
+    // formats of up to 16 bits decode with one load from the shared table
+    template <std::size_t Nbits, std::size_t ES>
+    void convert_from_posit(const posit_storage_t<Nbits>* in, std::size_t n, double* out, std::true_type)
+    {
+        const double* values = decode_table_for<Nbits, ES>().data();
+        const std::size_t mask = (std::size_t(1) << Nbits) - 1;
+        for (std::size_t i = 0; i < n; ++i)
+            out[i] = values[in[i] & mask];
+    }
+
+    template <std::size_t Nbits, std::size_t ES>
+    void convert_from_posit(const posit_storage_t<Nbits>* in, std::size_t n, double* out, std::false_type)
+    {
+        sw::unum::posit<Nbits, ES> p;
+        for (std::size_t i = 0; i < n; ++i) {
+            p.set_raw_bits(in[i]);
+            out[i] = double(p);
+        }
+    }
+
+} // namespace detail
+
+/// Decode n posit<Nbits, ES> bit patterns into doubles.
+template <std::size_t Nbits, std::size_t ES>
+void convert_from_posit(const posit_storage_t<Nbits>* in, std::size_t n, double* out)
+{
+    detail::convert_from_posit<Nbits, ES>(in, n, out, std::integral_constant<bool, (Nbits <= decode_table_max_nbits)>());
+}
+
+struct batch_encoder
+{
+    template <std::size_t Nbits, std::size_t ES>
+    void operator()() const
+    {
+        convert_to_posit<Nbits, ES>(in_, n_, static_cast<posit_storage_t<Nbits>*>(out_));
+    }
+
+    const double* in_;
+    std::size_t n_;
+    void* out_;
+};
+
+struct batch_decoder
+{
+    template <std::size_t Nbits, std::size_t ES>
+    void operator()() const
+    {
+        convert_from_posit<Nbits, ES>(static_cast<const posit_storage_t<Nbits>*>(in_), n_, out_);
+    }
+
+    const void* in_;
+    std::size_t n_;
+    double* out_;
+};
+
+/// Convert n doubles to the selected format with a single dispatch.
+//  out must hold n * posit_storage_bytes(nbits) bytes.
+inline dispatch_status convert_to_posit(const double* in, std::size_t n, void* out, const nbits_variant& nbitsv, const es_variant& esv)
+{
+    return table_dispatch(batch_encoder{ in, n, out }, nbitsv, esv);
+}
+
+/// Convert n packed encodings of the selected format to doubles with a single dispatch.
+inline dispatch_status convert_from_posit(const void* in, std::size_t n, double* out, const nbits_variant& nbitsv, const es_variant& esv)
+{
+    return table_dispatch(batch_decoder{ in, n, out }, nbitsv, esv);
+}
@@ -0,0 +1,52 @@
+// batch_ops.hpp: element-wise binary posit operations on arrays of raw encodings, one operation per batch
+//
+// Copyright (C) 2017 Stillwater Supercomputing, Inc.
+//
+// This file is part of the universal numbers project, which is released under an MIT Open Source license.
+
+#pragma once
+
+#include <cstddef>
+
+#include "posit_engine.hpp"
+
+/// Element-wise operations of batch_apply.
+enum class binary_op { add, sub, mul, div };
+
+/// c[i] = a[i] op b[i] for i in [0, n) with the given engine; c may alias a or b.
+//  The operation is resolved once per batch: every case is a monomorphic loop over plain arrays, without
+//  a branch or an object copy per element, which the compiler unrolls, and vectorizes where the engine allows.
+template <typename Engine>
+void batch_apply(const Engine& engine, binary_op op, const typename Engine::raw_type* a, const typename Engine::raw_type* b,
+                 typename Engine::raw_type* c, std::size_t n)
+{
+    switch (op) {
+        case binary_op::add: for (std::size_t i = 0; i < n; ++i) c[i] = engine.add(a[i], b[i]); break;
+        case binary_op::sub: for (std::size_t i = 0; i < n; ++i) c[i] = engine.sub(a[i], b[i]); break;
+        case binary_op::mul: for (std::size_t i = 0; i < n; ++i) c[i] = engine.mul(a[i], b[i]); break;
+        case binary_op::div: for (std::size_t i = 0; i < n; ++i) c[i] = engine.div(a[i], b[i]); break;
+    }
+}
+
+/// batch_apply with the fastest engine of posit<Nbits, ES>.
+template <std::size_t Nbits, std::size_t ES>
+void batch_apply(binary_op op, const posit_storage_t<Nbits>* a, const posit_storage_t<Nbits>* b, posit_storage_t<Nbits>* c, std::size_t n)
+{
+    batch_apply(posit_engine<Nbits, ES>(), op, a, b, c, n);
+}
+
+/// c[i] = a[i] op b[i], the reference of a batch computed in Real (rounded to Real).
+/// Rounded once more to posit<Nbits, ES>, it is the correctly rounded posit result when Real carries at least
+/// 2 * (Nbits - ES) - 2 significand bits, twice the widest posit significand plus two, and its normal range holds
+/// maxpos^2 and minpos^2: double for posit<16,1> and posit<24,1>, the x87 long double for posit<32,2>.
+/// For wider formats such as posit<48,2> and posit<64,3> the double rounding can differ from it.
+template <typename Real>
+void batch_reference(binary_op op, const Real* a, const Real* b, Real* c, std::size_t n)
+{
+    switch (op) {
+        case binary_op::add: for (std::size_t i = 0; i < n; ++i) c[i] = a[i] + b[i]; break;
+        case binary_op::sub: for (std::size_t i = 0; i < n; ++i) c[i] = a[i] - b[i]; break;
+        case binary_op::mul: for (std::size_t i = 0; i < n; ++i) c[i] = a[i] * b[i]; break;
+        case binary_op::div: for (std::size_t i = 0; i < n; ++i) c[i] = a[i] / b[i]; break;
+    }
+}
@@ -0,0 +1,127 @@
+// decode_table.hpp: shared, lazily built posit-to-double lookup tables for formats of up to 16 bits
+//
+// Copyright (C) 2017 Stillwater Supercomputing, Inc.
+//
+// This file is part of the universal numbers project, which is released under an MIT Open Source license.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <array>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include <posit>
+
+#include "dispatch_table.hpp"
+
+/// Widest format that gets a decode table: 2^16 doubles, 512 KB.
+constexpr std::size_t decode_table_max_nbits = 16;
+
+/// The double of every encoding of one posit<nbits, es> format, indexed by the raw bits.
+//  NaR decodes to whatever the library converts it to, a quiet NaN.
+class decode_table
+{
+  public:
+    decode_table(std::size_t nbits, std::size_t es)
+        : nbits_(nbits), es_(es), mask_((std::uint64_t(1) << nbits) - 1), values_(std::size_t(1) << nbits) {}
+
+    std::size_t nbits() const { return nbits_; }
+    std::size_t es() const { return es_; }
+    std::size_t size() const { return values_.size(); }
+    const double* data() const { return values_.data(); }
+    double* data() { return values_.data(); }
+
+    /// Decode an encoding; bits above nbits are ignored.
+    double operator[](std::uint64_t raw) const { return values_[std::size_t(raw & mask_)]; }
+
+    /// Posit order of two encodings, NaR below everything else.
+    //  Posits sort like two's complement integers, so this is an integer compare of the encodings
+    //  moved to the top of a word, which needs neither the table nor a special case for NaR.
+    bool less(std::uint64_t a, std::uint64_t b) const
+    {
+        return std::int64_t(a << (64 - nbits_)) < std::int64_t(b << (64 - nbits_));
+    }
+
+  private:
+    std::size_t nbits_, es_;
+    std::uint64_t mask_;
+    std::vector<double> values_;
+};
+
+namespace detail {
+
+    struct decode_table_builder
+    {
+        template <std::size_t Nbits, std::size_t ES>
+        void operator()() const
+        {
+            fill<Nbits, ES>(std::integral_constant<bool, (Nbits <= decode_table_max_nbits)>());
+        }
+
+        template <std::size_t Nbits, std::size_t ES>
+        void fill(std::true_type) const
+        {
+            sw::unum::posit<Nbits, ES> p;
+            double* values = table_.data();
+            for (std::uint64_t raw = 0; raw < table_.size(); ++raw) {
+                p.set_raw_bits(raw);
+                values[raw] = double(p);
+            }
+        }
+
+        // wider formats are rejected before the dispatch, so the posit conversions are not instantiated for them
+        template <std::size_t Nbits, std::size_t ES>
+        void fill(std::false_type) const {}
+
+        decode_table& table_;
+    };
+
+    // One slot per (nbits, es) pair of the dispatch range up to decode_table_max_nbits.
+    // A slot is built by the first thread that asks for it; the others wait on its once_flag.
+    struct decode_table_cache
+    {
+        static constexpr std::size_t slots = (decode_table_max_nbits - dispatch_min_nbits + 1) * dispatch_es_count;
+
+        std::array<std::once_flag, slots> built;
+        std::array<std::unique_ptr<decode_table>, slots> tables;
+
+        static decode_table_cache& instance()
+        {
+            static decode_table_cache cache;
+            return cache;
+        }
+    };
+
+} // namespace detail
+
+/// Decode table of posit<nbits, es>, built on first use and shared by all threads for the rest of the run.
+//  Throws std::invalid_argument for formats wider than decode_table_max_nbits and invalid configurations.
+inline const decode_table& decode_table_for(std::size_t nbits, std::size_t es)
+{
+    if (nbits < dispatch_min_nbits || nbits > decode_table_max_nbits || es > dispatch_max_es || !valid_posit_configuration(nbits, es))
+        throw std::invalid_argument("decode_table_for: no decode table for posit<" + std::to_string(nbits) + "," + std::to_string(es) + ">");
+
+    detail::decode_table_cache& cache = detail::decode_table_cache::instance();
+    const std::size_t slot = (nbits - dispatch_min_nbits) * dispatch_es_count + es;
+    std::call_once(cache.built[slot], [&]() {
+        std::unique_ptr<decode_table> table(new decode_table(nbits, es));
+        table_dispatch(detail::decode_table_builder{ *table }, nbits, es);
+        cache.tables[slot] = std::move(table);
+    });
+    return *cache.tables[slot];
+}
+
+/// Decode table of posit<Nbits, ES>; the lookup in the shared cache happens once per instantiation.
+template <std::size_t Nbits, std::size_t ES>
+const decode_table& decode_table_for()
+{
+    static_assert(Nbits <= decode_table_max_nbits, "decode tables cover formats of up to 16 bits");
+    static const decode_table& table = decode_table_for(Nbits, ES);
+    return table;
+}
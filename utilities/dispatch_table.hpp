@@ -0,0 +1,133 @@
+// dispatch_table.hpp: flat jump table for run-time selection of (nbits, es) kernels
+//
+// Copyright (C) 2017 Stillwater Supercomputing, Inc.
+//
+// This file is part of the universal numbers project, which is released under an MIT Open Source license.
+
+#pragma once
+
+#include <cstddef>
+#include <utility>
+#include <type_traits>
+
+#include <boost/variant.hpp>
+#include <boost/mpl/size.hpp>
+
+#include "es_select.hpp"
+#include "nbits_select.hpp"
+
+/// Range of the posit design space spanned by nbits_variant and es_variant.
+constexpr std::size_t dispatch_min_nbits = 3;
+constexpr std::size_t dispatch_max_nbits = 22;
+constexpr std::size_t dispatch_max_es = 5;
+constexpr std::size_t dispatch_nbits_count = dispatch_max_nbits - dispatch_min_nbits + 1;
+constexpr std::size_t dispatch_es_count = dispatch_max_es + 1;
+
+static_assert(boost::mpl::size<nbits_variant::types>::value == dispatch_nbits_count, "dispatch table out of sync with nbits_variant");
+static_assert(boost::mpl::size<es_variant::types>::value == dispatch_es_count, "dispatch table out of sync with es_variant");
+
+/// A posit<nbits, es> needs a sign bit and at least one regime bit besides the es exponent bits.
+constexpr bool valid_posit_configuration(std::size_t nbits, std::size_t es)
+{
+    return es + 2 <= nbits;
+}
+
+/// Outcome of a table dispatch; the table never throws.
+enum class dispatch_status { ok, unsupported_nbits, unsupported_es, invalid_configuration };
+
+inline const char* to_string(dispatch_status status)
+{
+    switch (status) {
+        case dispatch_status::ok:                    return "ok";
+        case dispatch_status::unsupported_nbits:     return "nbits not supported";
+        case dispatch_status::unsupported_es:        return "es not supported";
+        case dispatch_status::invalid_configuration: return "nbits must be at least es+2";
+    }
+    return "unknown dispatch status";
+}
+
+namespace detail {
+
+    template <typename Visitor, std::size_t Nbits, std::size_t ES, bool Valid = valid_posit_configuration(Nbits, ES)>
+    struct dispatch_entry
+    {
+        static void call(Visitor& vis) { vis.template operator()<Nbits, ES>(); }
+        static constexpr void (*value)(Visitor&) = &call;
+    };
+
+    // Invalid configurations get an empty slot and are never instantiated.
+    template <typename Visitor, std::size_t Nbits, std::size_t ES>
+    struct dispatch_entry<Visitor, Nbits, ES, false>
+    {
+        static constexpr void (*value)(Visitor&) = nullptr;
+    };
+
+    template <typename Visitor, typename Indices>
+    struct dispatch_table_builder;
+
+    // Row-major: slot (nbits - dispatch_min_nbits) * dispatch_es_count + es
+    template <typename Visitor, std::size_t... I>
+    struct dispatch_table_builder<Visitor, std::index_sequence<I...>>
+    {
+        static constexpr void (*entries[sizeof...(I)])(Visitor&) = {
+            dispatch_entry<Visitor, dispatch_min_nbits + I / dispatch_es_count, I % dispatch_es_count>::value...
+        };
+    };
+
+    template <typename Visitor, std::size_t... I>
+    constexpr void (*dispatch_table_builder<Visitor, std::index_sequence<I...>>::entries[sizeof...(I)])(Visitor&);
+
+} // namespace detail
+
+/// Compile-time generated table of kernels for all valid (nbits, es) pairs of a visitor.
+//  The visitor provides the same interface as for nested_apply_visitor: template <size_t Nbits, size_t ES> void operator()().
+template <typename Visitor>
+struct dispatch_table
+{
+    using entry = void (*)(Visitor&);
+    using builder = detail::dispatch_table_builder<Visitor, std::make_index_sequence<dispatch_nbits_count * dispatch_es_count>>;
+
+    /// Kernel for (nbits, es) or nullptr if there is none; arguments must be within the table range.
+    static entry lookup(std::size_t nbits, std::size_t es)
+    {
+        return builder::entries[(nbits - dispatch_min_nbits) * dispatch_es_count + es];
+    }
+
+    /// Number of kernels that are actually instantiated.
+    static constexpr std::size_t size()
+    {
+        return count(0);
+    }
+
+  private:
+    static constexpr std::size_t count(std::size_t i)
+    {
+        return i == dispatch_nbits_count * dispatch_es_count ? 0
+            : (builder::entries[i] != nullptr ? 1 : 0) + count(i + 1);
+    }
+};
+
+/// Run the visitor for posit<nbits, es> with a single indirect call.
+template <typename Visitor>
+dispatch_status table_dispatch(Visitor&& vis, std::size_t nbits, std::size_t es)
+{
+    using visitor_type = typename std::remove_reference<Visitor>::type;
+
+    if (nbits < dispatch_min_nbits || nbits > dispatch_max_nbits)
+        return dispatch_status::unsupported_nbits;
+    if (es > dispatch_max_es)
+        return dispatch_status::unsupported_es;
+
+    auto kernel = dispatch_table<visitor_type>::lookup(nbits, es);
+    if (kernel == nullptr)
+        return dispatch_status::invalid_configuration;
+    kernel(vis);
+    return dispatch_status::ok;
+}
+
+/// Drop-in replacement for nested_apply_visitor on the (nbits_variant, es_variant) pair.
+template <typename Visitor>
+dispatch_status table_dispatch(Visitor&& vis, const nbits_variant& nbitsv, const es_variant& esv)
+{
+    return table_dispatch(std::forward<Visitor>(vis), std::size_t(nbitsv.which()) + dispatch_min_nbits, std::size_t(esv.which()));
+}
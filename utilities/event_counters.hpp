@@ -0,0 +1,206 @@
+// event_counters.hpp: opt-in per-thread counters of rounding, saturation, NaR, and quire overflow events
+//
+// Copyright (C) 2017 Stillwater Supercomputing, Inc.
+//
+// This file is part of the universal numbers project, which is released under an MIT Open Source license.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <mutex>
+#include <ostream>
+#include <vector>
+
+#include <posit>
+
+// Build with -DEF_TENSORS_EVENT_COUNTERS=1 (CMake option EF_TENSORS_EVENT_COUNTERS) to count events.
+// Call sites test event_counters_enabled, so without it the checks compile to nothing.
+#ifndef EF_TENSORS_EVENT_COUNTERS
+#define EF_TENSORS_EVENT_COUNTERS 0
+#endif
+
+constexpr bool event_counters_enabled = EF_TENSORS_EVENT_COUNTERS != 0;
+
+/// What happened to a result on its way into a posit.
+enum class arithmetic_event {
+    inexact,            // the result was rounded
+    saturate_maxpos,    // a magnitude above maxpos was clamped to maxpos
+    saturate_minpos,    // a nonzero magnitude below minpos was clamped to minpos
+    nar_result,         // NaR out of operands that were not NaR, e.g. division by zero
+    quire_overflow      // a quire accumulated more terms than its capacity guarantees
+};
+
+constexpr std::size_t arithmetic_event_count = 5;
+
+inline const char* to_string(arithmetic_event e)
+{
+    switch (e) {
+        case arithmetic_event::inexact:         return "inexact";
+        case arithmetic_event::saturate_maxpos: return "saturate_maxpos";
+        case arithmetic_event::saturate_minpos: return "saturate_minpos";
+        case arithmetic_event::nar_result:      return "nar_result";
+        case arithmetic_event::quire_overflow:  return "quire_overflow";
+    }
+    return "unknown";
+}
+
+/// Snapshot of the counts of all threads.
+struct event_counts
+{
+    std::array<std::uint64_t, arithmetic_event_count> counts = {};
+
+    std::uint64_t operator[](arithmetic_event e) const { return counts[std::size_t(e)]; }
+};
+
+namespace detail {
+
+    struct event_counter_block;
+
+    // Blocks of running threads, and the totals of threads that have finished.
+    struct event_registry
+    {
+        std::mutex mutex;
+        std::vector<event_counter_block*> live;
+        event_counts retired;
+
+        static event_registry& instance()
+        {
+            static event_registry registry;
+            return registry;
+        }
+    };
+
+    // Only the owning thread writes its block, so increments are plain relaxed load/store pairs
+    // without a locked instruction; the atomics only make the concurrent reads of collect well defined.
+    struct event_counter_block
+    {
+        std::array<std::atomic<std::uint64_t>, arithmetic_event_count> counts;
+
+        event_counter_block()
+        {
+            for (auto& c : counts)
+                c.store(0, std::memory_order_relaxed);
+            event_registry& registry = event_registry::instance();
+            std::lock_guard<std::mutex> lock(registry.mutex);
+            registry.live.push_back(this);
+        }
+
+        ~event_counter_block()
+        {
+            event_registry& registry = event_registry::instance();
+            std::lock_guard<std::mutex> lock(registry.mutex);
+            for (std::size_t e = 0; e < arithmetic_event_count; ++e)
+                registry.retired.counts[e] += counts[e].load(std::memory_order_relaxed);
+            registry.live.erase(std::find(registry.live.begin(), registry.live.end(), this));
+        }
+    };
+
+    inline event_counter_block& thread_event_counters()
+    {
+        thread_local event_counter_block block;
+        return block;
+    }
+
+} // namespace detail
+
+/// Add n occurrences of e to the counters of the calling thread.
+inline void count_event(arithmetic_event e, std::uint64_t n = 1)
+{
+    std::atomic<std::uint64_t>& c = detail::thread_event_counters().counts[std::size_t(e)];
+    c.store(c.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+}
+
+/// Sum of the counters of all threads, running and finished.
+inline event_counts collect_event_counts()
+{
+    detail::event_registry& registry = detail::event_registry::instance();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    event_counts total = registry.retired;
+    for (const detail::event_counter_block* block : registry.live)
+        for (std::size_t e = 0; e < arithmetic_event_count; ++e)
+            total.counts[e] += block->counts[e].load(std::memory_order_relaxed);
+    return total;
+}
+
+/// Zero all counters; events counted concurrently with the reset may be lost.
+inline void reset_event_counts()
+{
+    detail::event_registry& registry = detail::event_registry::instance();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    registry.retired = event_counts();
+    for (detail::event_counter_block* block : registry.live)
+        for (auto& c : block->counts)
+            c.store(0, std::memory_order_relaxed);
+}
+
+/// {"enabled": true, "events": {"inexact": 12, ...}}
+inline void write_event_counts_json(std::ostream& ostr, const event_counts& counts)
+{
+    ostr << "{\n  \"enabled\": " << (event_counters_enabled ? "true" : "false") << ",\n  \"events\": {";
+    for (std::size_t e = 0; e < arithmetic_event_count; ++e)
+        ostr << (e ? "," : "") << "\n    \"" << to_string(arithmetic_event(e)) << "\": " << counts.counts[e];
+    ostr << "\n  }\n}\n";
+}
+
+namespace detail {
+
+    // Count an inexact result; above tells whether the magnitude it approximates exceeds its own.
+    template <std::size_t Nbits, std::size_t ES>
+    void record_inexact(const sw::unum::posit<Nbits, ES>& result, bool above)
+    {
+        count_event(arithmetic_event::inexact);
+
+        // magnitude of the encoding: maxpos is 0111..1, minpos is 00..01
+        const std::uint64_t mask = Nbits == 64 ? ~std::uint64_t(0) : (std::uint64_t(1) << Nbits) - 1;
+        std::uint64_t raw = result.get().to_ullong() & mask;
+        if (raw >> (Nbits - 1))
+            raw = (0 - raw) & mask;
+        if (raw == (mask >> 1) && above)
+            count_event(arithmetic_event::saturate_maxpos);
+        else if (raw == 1 && !above)
+            count_event(arithmetic_event::saturate_minpos);
+    }
+
+} // namespace detail
+
+/// Classify a result against the value it approximates, exact or computed at higher precision.
+//  operands_nar tells whether a NaR result merely propagates a NaR operand.
+template <std::size_t Nbits, std::size_t ES, typename Real>
+void record_rounding(const sw::unum::posit<Nbits, ES>& result, Real exact, bool operands_nar = false)
+{
+    if (result.isNaR()) {
+        if (!operands_nar)
+            count_event(arithmetic_event::nar_result);
+        return;
+    }
+    if (Real(result) == exact)
+        return;
+    detail::record_inexact(result, std::abs(exact) > std::abs(Real(result)));
+}
+
+/// Classify the rounding of a quire of the given capacity that accumulated terms products.
+//  The result is subtracted from a copy of the quire, so the comparison is exact at any width of the sum.
+template <std::size_t Nbits, std::size_t ES, typename Quire>
+void record_quire_result(const sw::unum::posit<Nbits, ES>& result, const Quire& q, std::uint64_t terms, std::size_t capacity, bool operands_nar)
+{
+    if (capacity < 64 && terms > (std::uint64_t(1) << capacity))
+        count_event(arithmetic_event::quire_overflow);
+    if (operands_nar)
+        return;
+    if (result.isNaR()) {
+        count_event(arithmetic_event::nar_result);
+        return;
+    }
+    Quire residue(q);
+    residue -= sw::unum::quire_mul(result, sw::unum::posit<Nbits, ES>(1));
+    const auto difference = residue.to_value();
+    if (difference.iszero())
+        return;
+    // the sum lies beyond the result when the residue points away from zero, i.e. has the sign of the result
+    detail::record_inexact(result, difference.sign() == result.isNegative());
+}
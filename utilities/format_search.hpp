@@ -0,0 +1,134 @@
+// format_search.hpp: find the narrowest posit format whose error on a workload stays within a bound
+//
+// Copyright (C) 2017 Stillwater Supercomputing, Inc.
+//
+// This file is part of the universal numbers project, which is released under an MIT Open Source license.
+
+#pragma once
+
+#include <cstddef>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <limits>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "dispatch_table.hpp"
+#include "work_stealing.hpp"
+
+/// One run of the workload kernel in one format.
+struct format_measurement
+{
+    std::size_t nbits, es;
+    double error;           // as reported by the kernel, e.g. relative error against a quire or long double reference
+    double seconds;         // wall time of the kernel call
+    bool feasible;          // error <= error_bound
+};
+
+struct format_search_options
+{
+    double error_bound = 1.0e-3;
+    std::size_t min_nbits = dispatch_min_nbits;
+    std::size_t max_nbits = dispatch_max_nbits;
+    std::size_t max_es = dispatch_max_es;
+    unsigned nrOfThreads = 0;           // 0 selects the hardware threads
+};
+
+struct format_search_result
+{
+    bool found = false;
+    format_measurement smallest = {};   // fewest bits within the bound, the faster one of equally wide formats
+    format_measurement fastest = {};    // fastest of the feasible formats that were measured
+    std::vector<format_measurement> evaluated;  // every measurement, in the order they completed
+};
+
+namespace detail {
+
+    template <typename Kernel>
+    struct format_evaluator
+    {
+        template <std::size_t Nbits, std::size_t ES>
+        void operator()()
+        {
+            auto start = std::chrono::steady_clock::now();
+            error_ = kernel_.template operator()<Nbits, ES>();
+            seconds_ = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        }
+
+        const Kernel& kernel_;
+        double& error_;
+        double& seconds_;
+    };
+
+} // namespace detail
+
+/// Search the (nbits, es) grid for the narrowest format that keeps kernel's error within options.error_bound.
+//  The kernel provides template <size_t Nbits, size_t ES> double operator()() const, which runs the workload
+//  in posit<Nbits, ES> and returns its error; it is called concurrently from several threads.
+//  Each es is searched by bisection over nbits, which relies on the error not growing with nbits at fixed es.
+//  The es searches run in parallel and share the narrowest feasible width found so far as their upper bound,
+//  so the search measures a few dozen of the 110 valid formats of the dispatch range, and fewer the earlier a narrow format turns up.
+template <typename Kernel>
+format_search_result minimum_precision_search(const Kernel& kernel, const format_search_options& options = format_search_options())
+{
+    const std::size_t max_nbits = std::min(options.max_nbits, dispatch_max_nbits);
+    const std::size_t min_nbits = std::max(options.min_nbits, dispatch_min_nbits);
+    const std::size_t max_es = std::min(options.max_es, dispatch_max_es);
+
+    format_search_result result;
+    std::mutex result_mutex;
+    std::atomic<std::size_t> best_nbits(max_nbits);
+
+    auto measure = [&](std::size_t nbits, std::size_t es) {
+        format_measurement m{ nbits, es, std::numeric_limits<double>::infinity(), 0.0, false };
+        table_dispatch(detail::format_evaluator<Kernel>{ kernel, m.error, m.seconds }, nbits, es);
+        m.feasible = m.error <= options.error_bound;
+        if (m.feasible) {
+            std::size_t best = best_nbits.load();
+            while (nbits < best && !best_nbits.compare_exchange_weak(best, nbits)) {}
+        }
+        std::lock_guard<std::mutex> lock(result_mutex);
+        result.evaluated.push_back(m);
+        return m.feasible;
+    };
+
+    unsigned nrOfThreads = options.nrOfThreads > 0 ? options.nrOfThreads : std::max(1u, std::thread::hardware_concurrency());
+    nrOfThreads = unsigned(std::min<std::size_t>(nrOfThreads, max_es + 1));
+    work_stealing_for(max_es + 1, 1, nrOfThreads, [&](unsigned, std::size_t first, std::size_t last) {
+        for (std::size_t es = first; es < last; ++es) {
+            std::size_t lo = std::max(min_nbits, es + 2);
+            // a width above the best one found by any es cannot win; an equal one may still be faster
+            std::size_t hi = best_nbits.load();
+            if (lo > hi || !measure(hi, es))
+                continue;
+            while (lo < hi) {
+                // another es found a narrower format: this es only matters if it is feasible at that width too
+                const std::size_t best = best_nbits.load();
+                if (best < hi) {
+                    if (best < lo || !measure(best, es))
+                        break;
+                    hi = best;
+                    continue;
+                }
+                const std::size_t mid = lo + (hi - lo) / 2;
+                if (measure(mid, es))
+                    hi = mid;
+                else
+                    lo = mid + 1;
+            }
+        }
+    });
+
+    for (const format_measurement& m : result.evaluated) {
+        if (!m.feasible)
+            continue;
+        if (!result.found || m.nbits < result.smallest.nbits || (m.nbits == result.smallest.nbits && m.seconds < result.smallest.seconds))
+            result.smallest = m;
+        if (!result.found || m.seconds < result.fastest.seconds)
+            result.fastest = m;
+        result.found = true;
+    }
+    return result;
+}
@@ -0,0 +1,111 @@
+// posit_codec.hpp: bit-level conversion between IEEE double and posit<nbits, es> encodings for nbits <= 32
+//
+// Copyright (C) 2017 Stillwater Supercomputing, Inc.
+//
+// This file is part of the universal numbers project, which is released under an MIT Open Source license.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include "batch_convert.hpp"
+
+/// Number of leading zero bits of a nonzero 64-bit word.
+inline int count_leading_zeros(std::uint64_t x)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_clzll(x);
+#else
+    int n = 0;
+    for (std::uint64_t bit = std::uint64_t(1) << 63; (x & bit) == 0; bit >>= 1)
+        ++n;
+    return n;
+#endif
+}
+
+/// Encode and decode posit<Nbits, ES> straight from the IEEE double bit fields, without sw::unum::value.
+//  Rounding is to nearest, ties to even; finite values never round to zero or NaR but saturate at
+//  minpos and maxpos, and NaN and infinities map to NaR. For Nbits <= 32 every posit is a double,
+//  so decode is exact. The steps are the ones the SIMD kernels perform per lane.
+template <std::size_t Nbits, std::size_t ES>
+struct posit_codec
+{
+    static_assert(Nbits <= 32 && ES + 2 <= Nbits, "posit_codec supports valid formats up to 32 bits");
+
+    using raw_type = posit_storage_t<Nbits>;
+
+    static constexpr std::uint64_t mask = (std::uint64_t(1) << Nbits) - 1;
+    static constexpr std::uint64_t nar = std::uint64_t(1) << (Nbits - 1);
+    static constexpr std::uint64_t maxpos = nar - 1;
+    static constexpr std::int64_t max_k = std::int64_t(Nbits) - 2;     // regime of maxpos, -max_k is the regime of minpos
+
+    static raw_type encode(double x)
+    {
+        std::uint64_t u;
+        std::memcpy(&u, &x, sizeof(u));
+        const std::uint64_t sign = u >> 63, a = u & 0x7FFFFFFFFFFFFFFFull;
+        const std::uint64_t E = a >> 52, f = a & 0x000FFFFFFFFFFFFFull;
+        if (a == 0)
+            return 0;
+        if (E == 2047)
+            return raw_type(nar);
+
+        // scale = E - 1023 = k * 2^ES + ex; 1024 is a multiple of 2^ES, so the shift floors without signed arithmetic
+        const std::int64_t k = std::int64_t((E + 1) >> ES) - std::int64_t(1024 >> ES);
+        const std::uint64_t ex = (E + 1) & ((std::uint64_t(1) << ES) - 1);
+
+        std::uint64_t p;
+        if (k >= max_k) {
+            p = maxpos;
+        }
+        else if (k < -max_k) {
+            p = 1;                  // includes the subnormals
+        }
+        else {
+            // regime, exponent, and fraction left-aligned in a 64-bit word after the sign
+            const int rlen = int(k >= 0 ? k + 2 : 1 - k);
+            const std::uint64_t regime = k >= 0 ? ~(~std::uint64_t(0) >> (k + 1)) : (std::uint64_t(1) << 63) >> -k;
+            const int s = 64 - rlen - int(ES);          // bits below the exponent field
+            const std::uint64_t fraction = s >= 52 ? f << (s - 52) : f >> (52 - s);
+            const std::uint64_t lost = s >= 52 ? 0 : f & ((std::uint64_t(1) << (52 - s)) - 1);
+            const std::uint64_t body = regime | (ex << s) | fraction;
+
+            p = body >> (65 - Nbits);
+            const std::uint64_t guard = (body >> (64 - Nbits)) & 1;
+            const std::uint64_t sticky = ((body & ((std::uint64_t(1) << (64 - Nbits)) - 1)) | lost) != 0;
+            p += guard & (sticky | (p & 1));
+            p -= p >> (Nbits - 1);  // rounding past maxpos
+        }
+        return raw_type(sign ? (0 - p) & mask : p);
+    }
+
+    static double decode(raw_type raw)
+    {
+        std::uint64_t p = raw & mask;
+        if (p == 0)
+            return 0.0;
+        std::uint64_t u;
+        if (p == nar) {
+            u = 0x7FF8000000000000ull;
+        }
+        else {
+            const std::uint64_t sign = p >> (Nbits - 1);
+            if (sign)
+                p = (0 - p) & mask;
+            std::uint64_t b = p << (65 - Nbits);        // the Nbits - 1 bits after the sign, left-aligned
+            const std::uint64_t r0 = b >> 63;
+            const int m = count_leading_zeros(r0 ? ~b : b);
+            const std::int64_t k = r0 ? m - 1 : -m;
+            b <<= m + 1;
+            const std::uint64_t ex = (b >> 1) >> (63 - ES);
+            b <<= ES;
+            const std::int64_t scale = k * (std::int64_t(1) << ES) + std::int64_t(ex);
+            u = (sign << 63) | (std::uint64_t(scale + 1023) << 52) | (b >> 12);
+        }
+        double d;
+        std::memcpy(&d, &u, sizeof(d));
+        return d;
+    }
+};
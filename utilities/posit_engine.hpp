@@ -0,0 +1,117 @@
+// posit_engine.hpp: raw-bit arithmetic engines for posit<nbits, es>
+//
+// Copyright (C) 2017 Stillwater Supercomputing, Inc.
+//
+// This file is part of the universal numbers project, which is released under an MIT Open Source license.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+#include <posit>
+
+#include "batch_convert.hpp"
+#include "posit_native.hpp"
+
+/// Arithmetic on encodings through the generic sw::unum::posit implementation.
+//  All engines share this interface, so kernels can be written once against posit_engine<Nbits, ES>.
+template <std::size_t Nbits, std::size_t ES>
+struct generic_posit_engine
+{
+    using raw_type = posit_storage_t<Nbits>;
+    using posit_type = sw::unum::posit<Nbits, ES>;
+
+    raw_type add(raw_type a, raw_type b) const { return raw(decode(a) + decode(b)); }
+    raw_type sub(raw_type a, raw_type b) const { return raw(decode(a) - decode(b)); }
+    raw_type mul(raw_type a, raw_type b) const { return raw(decode(a) * decode(b)); }
+    raw_type div(raw_type a, raw_type b) const { return raw(decode(a) / decode(b)); }
+
+    static posit_type decode(raw_type a)
+    {
+        posit_type p;
+        p.set_raw_bits(a);
+        return p;
+    }
+
+    static raw_type raw(const posit_type& p)
+    {
+        return raw_type(p.get().to_ullong());
+    }
+};
+
+/// Largest nbits for which the full 2^nbits x 2^nbits result tables are built.
+constexpr std::size_t lut_max_nbits = 10;
+
+/// Arithmetic through result tables of all operand pairs.
+//  The tables are built from the generic engine on first use and shared by all instances;
+//  an engine object holds a reference, so the hot loop pays no initialization check.
+template <std::size_t Nbits, std::size_t ES>
+class lut_posit_engine
+{
+    static_assert(Nbits <= lut_max_nbits, "result tables are limited to nbits <= lut_max_nbits");
+
+  public:
+    using raw_type = posit_storage_t<Nbits>;
+
+    lut_posit_engine() : tables_(tables()) {}
+
+    raw_type add(raw_type a, raw_type b) const { return tables_.add[index(a, b)]; }
+    raw_type sub(raw_type a, raw_type b) const { return tables_.sub[index(a, b)]; }
+    raw_type mul(raw_type a, raw_type b) const { return tables_.mul[index(a, b)]; }
+    raw_type div(raw_type a, raw_type b) const { return tables_.div[index(a, b)]; }
+
+    /// Bytes of table memory behind this configuration.
+    static constexpr std::size_t footprint() { return 4 * (std::size_t(1) << (2 * Nbits)) * sizeof(raw_type); }
+
+  private:
+    static constexpr std::size_t mask = (std::size_t(1) << Nbits) - 1;
+
+    static std::size_t index(raw_type a, raw_type b)
+    {
+        return ((std::size_t(a) & mask) << Nbits) | (std::size_t(b) & mask);
+    }
+
+    struct op_tables
+    {
+        std::vector<raw_type> add, sub, mul, div;
+
+        op_tables()
+        {
+            const std::size_t size = std::size_t(1) << (2 * Nbits);
+            add.resize(size); sub.resize(size); mul.resize(size); div.resize(size);
+            generic_posit_engine<Nbits, ES> generic;
+            for (std::size_t a = 0; a <= mask; ++a) {
+                for (std::size_t b = 0; b <= mask; ++b) {
+                    std::size_t i = index(raw_type(a), raw_type(b));
+                    add[i] = generic.add(raw_type(a), raw_type(b));
+                    sub[i] = generic.sub(raw_type(a), raw_type(b));
+                    mul[i] = generic.mul(raw_type(a), raw_type(b));
+                    div[i] = generic.div(raw_type(a), raw_type(b));
+                }
+            }
+        }
+    };
+
+    // function-local static: built once, thread-safe
+    static const op_tables& tables()
+    {
+        static const op_tables t;
+        return t;
+    }
+
+    const op_tables& tables_;
+};
+
+/// The fastest available engine for posit<Nbits, ES>: result tables up to lut_max_nbits, which also beat the
+//  native posit<8,0> engine by an order of magnitude, then native integers for <16,1>, <32,2>, and <64,3>.
+template <std::size_t Nbits, std::size_t ES>
+using posit_engine = typename std::conditional<(Nbits <= lut_max_nbits), lut_posit_engine<Nbits, ES>,
+                     typename std::conditional<native_posit_format(Nbits, ES), native_posit_engine<Nbits, ES>, generic_posit_engine<Nbits, ES>>::type>::type;
+
+/// The fastest engine that computes with the posit library itself: result tables, which are built by the
+//  generic engine, up to lut_max_nbits, then the generic engine. Checks of the library use this one.
+template <std::size_t Nbits, std::size_t ES>
+using library_posit_engine = typename std::conditional<(Nbits <= lut_max_nbits), lut_posit_engine<Nbits, ES>, generic_posit_engine<Nbits, ES>>::type;
@@ -0,0 +1,192 @@
+// posit_native.hpp: integer arithmetic on the encodings of the standard posits <8,0>, <16,1>, <32,2>, and <64,3>
+//
+// Copyright (C) 2017 Stillwater Supercomputing, Inc.
+//
+// This file is part of the universal numbers project, which is released under an MIT Open Source license.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+#include "batch_convert.hpp"
+#include "posit_codec.hpp"
+
+#if defined(__SIZEOF_INT128__)
+#define EF_TENSORS_HAS_INT128 1
+#else
+#define EF_TENSORS_HAS_INT128 0
+#endif
+
+/// Whether native_posit_engine implements posit<Nbits, ES>: the standard formats, <64,3> only with a 128-bit integer type.
+constexpr bool native_posit_format(std::size_t nbits, std::size_t es)
+{
+    return (nbits == 8 && es == 0) || (nbits == 16 && es == 1) || (nbits == 32 && es == 2) || (nbits == 64 && es == 3 && EF_TENSORS_HAS_INT128);
+}
+
+namespace detail {
+
+    // Working word of the unpacked significands: twice the significand width, so products and
+    // quotients of two significands are exact. 64 bits hold the 29-bit significands up to posit<32,2>.
+#if EF_TENSORS_HAS_INT128
+    template <std::size_t Nbits>
+    using native_word_t = typename std::conditional<(Nbits <= 32), std::uint64_t, unsigned __int128>::type;
+#else
+    template <std::size_t Nbits>
+    using native_word_t = std::uint64_t;
+#endif
+
+    inline int native_clz(std::uint64_t x) { return count_leading_zeros(x); }
+#if EF_TENSORS_HAS_INT128
+    inline int native_clz(unsigned __int128 x)
+    {
+        const std::uint64_t hi = std::uint64_t(x >> 64);
+        return hi ? count_leading_zeros(hi) : 64 + count_leading_zeros(std::uint64_t(x));
+    }
+#endif
+
+} // namespace detail
+
+/// Arithmetic on posit<Nbits, ES> encodings in native integers, the interface of generic_posit_engine.
+//  Operands are unpacked to a scale and a significand left-aligned in a word of twice the significand width,
+//  with count-leading-zeros decoding of the regime. The exact sum, product, or quotient (with a sticky bit
+//  for a nonzero remainder) is packed back with round to nearest, ties to even, on the encoding: results
+//  saturate at maxpos and minpos and never round to zero or NaR, and NaR operands or a zero divisor give NaR.
+template <std::size_t Nbits, std::size_t ES>
+class native_posit_engine
+{
+    static_assert(native_posit_format(Nbits, ES), "native_posit_engine implements the standard posit formats");
+
+  public:
+    using raw_type = posit_storage_t<Nbits>;
+
+    raw_type add(raw_type a, raw_type b) const { return sum(a, b); }
+    raw_type sub(raw_type a, raw_type b) const { return sum(a, raw_type(0 - b)); }     // NaR and zero are their own negation
+
+    raw_type mul(raw_type a, raw_type b) const
+    {
+        if (a == nar || b == nar)
+            return nar;
+        if (a == 0 || b == 0)
+            return 0;
+        const unpacked x = unpack(a), y = unpack(b);
+        // exact product of the significands in the upper halves, in [2^(WB-2), 2^WB)
+        word_type product = (x.significand >> half) * (y.significand >> half);
+        const int carry = int(product >> (word_bits - 1));
+        product <<= 1 - carry;
+        return pack(x.negative != y.negative, x.scale + y.scale + carry, product, false);
+    }
+
+    raw_type div(raw_type a, raw_type b) const
+    {
+        if (a == nar || b == nar || b == 0)
+            return nar;
+        if (a == 0)
+            return 0;
+        const unpacked x = unpack(a), y = unpack(b);
+        // half-word significands: the quotient has at least half + 1 bits, more than the fraction needs
+        const word_type dividend = (x.significand >> half) << half, divisor = y.significand >> half;
+        const word_type quotient = dividend / divisor;
+        const bool sticky = quotient * divisor != dividend;
+        const int lz = detail::native_clz(quotient);
+        return pack(x.negative != y.negative, x.scale - y.scale + (int(half) - 1 - lz), quotient << lz, sticky);
+    }
+
+  private:
+    using word_type = detail::native_word_t<Nbits>;
+    static constexpr int word_bits = int(sizeof(word_type) * 8);
+    static constexpr int half = word_bits / 2;
+
+    static constexpr std::uint64_t mask = Nbits == 64 ? ~std::uint64_t(0) : (std::uint64_t(1) << Nbits) - 1;
+    static constexpr raw_type nar = raw_type(std::uint64_t(1) << (Nbits - 1));
+    static constexpr std::uint64_t maxpos = (std::uint64_t(1) << (Nbits - 1)) - 1;
+    static constexpr int max_k = int(Nbits) - 2;
+
+    struct unpacked
+    {
+        bool negative;
+        int scale;
+        word_type significand;      // hidden bit in the top bit of the word
+    };
+
+    // nonzero, non-NaR encoding into sign, scale, and significand
+    static unpacked unpack(raw_type raw)
+    {
+        const bool negative = (raw >> (Nbits - 1)) != 0;
+        const std::uint64_t p = negative ? (0 - std::uint64_t(raw)) & mask : std::uint64_t(raw);
+        std::uint64_t b = p << (65 - Nbits);                // the bits after the sign, left-aligned
+        const std::uint64_t r0 = b >> 63;
+        const int m = count_leading_zeros(r0 ? ~b : b);     // regime run length
+        const int k = r0 ? m - 1 : -m;
+        b = m + 1 < 64 ? b << (m + 1) : 0;                  // only maxpos of posit<64,3> has a 63-bit regime
+        const int e = ES ? int(b >> (64 - ES)) : 0;
+        b <<= ES;
+        const std::uint64_t significand = (std::uint64_t(1) << 63) | (b >> 1);
+        return unpacked{ negative, k * (1 << ES) + e, word_type(significand) << (word_bits - 64) };
+    }
+
+    // Round sign * significand / 2^(WB-1) * 2^scale, plus the sticky bit below it, to the nearest encoding.
+    static raw_type pack(bool negative, int scale, word_type significand, bool sticky)
+    {
+        const int k = scale >= 0 ? scale >> ES : -((-scale + (1 << ES) - 1) >> ES);       // floor(scale / 2^ES)
+        const word_type e = word_type(scale - k * (1 << ES));
+        std::uint64_t p;
+        if (k >= max_k) {
+            p = maxpos;
+        }
+        else if (k < -max_k) {
+            p = 1;
+        }
+        else {
+            // regime, exponent, and fraction left-aligned in the word after the sign
+            const int rlen = k >= 0 ? k + 2 : 1 - k;
+            const word_type regime = k >= 0 ? ~(~word_type(0) >> (k + 1)) : (word_type(1) << (word_bits - 1)) >> -k;
+            const int s = word_bits - rlen - int(ES);           // bits below the exponent field
+            const word_type fraction = significand << 1;        // drop the hidden bit
+            const word_type body = regime | (e << s) | (fraction >> (word_bits - s));
+            const word_type below = (body & ((word_type(1) << (word_bits - Nbits)) - 1)) | (fraction << s);
+
+            p = std::uint64_t(body >> (word_bits + 1 - Nbits));
+            const std::uint64_t guard = std::uint64_t(body >> (word_bits - Nbits)) & 1;
+            p += guard & std::uint64_t((below != 0) | sticky | (p & 1));
+            p -= p >> (Nbits - 1);                              // rounding past maxpos
+        }
+        return raw_type(negative ? (0 - p) & mask : p);
+    }
+
+    static raw_type sum(raw_type a, raw_type b)
+    {
+        if (a == nar || b == nar)
+            return nar;
+        if (a == 0)
+            return b;
+        if (b == 0)
+            return a;
+        unpacked x = unpack(a), y = unpack(b);
+        // magnitudes order like the encodings of their absolute values
+        const std::uint64_t ua = x.negative ? (0 - std::uint64_t(a)) & mask : a, ub = y.negative ? (0 - std::uint64_t(b)) & mask : b;
+        if (ua < ub) {
+            const unpacked t = x;
+            x = y;
+            y = t;
+        }
+        // one bit of headroom for the carry; the shifted-out bits of the smaller operand are jammed into
+        // the lowest bit, which lies far below the guard bit of the result
+        const word_type big = x.significand >> 1;
+        const int shift = x.scale - y.scale;
+        word_type small = y.significand >> 1;
+        if (shift >= word_bits - 1) {
+            small = 1;
+        }
+        else if (shift > 0) {
+            const bool lost = (small << (word_bits - shift)) != 0;
+            small = (small >> shift) | word_type(lost);
+        }
+        const word_type r = x.negative == y.negative ? big + small : big - small;
+        if (r == 0)
+            return 0;
+        const int lz = detail::native_clz(r);
+        return pack(x.negative, x.scale + 1 - lz, r << lz, false);
+    }
+};
@@ -0,0 +1,297 @@
+// posit_tensor.hpp: tensor of run-time selected posit format with elements packed at nbits each
+//
+// Copyright (C) 2017 Stillwater Supercomputing, Inc.
+//
+// This file is part of the universal numbers project, which is released under an MIT Open Source license.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <array>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <posit>
+
+#include "es_select.hpp"
+#include "nbits_select.hpp"
+#include "dispatch_table.hpp"
+#include "batch_convert.hpp"
+#include "decode_table.hpp"
+
+namespace detail {
+
+    // Element i occupies bits [i * nbits, (i + 1) * nbits) of the little-endian word array. For nbits 8 and 16
+    // this is byte for byte the layout of a uint8_t or uint16_t array. The array carries one spare word,
+    // so an element straddling a word boundary never reads past the end.
+    inline std::uint64_t packed_get(const std::uint64_t* words, std::size_t nbits, std::size_t i)
+    {
+        const std::size_t bit = i * nbits, w = bit >> 6, offset = bit & 63;
+        std::uint64_t v = words[w] >> offset;
+        if (offset + nbits > 64)
+            v |= words[w + 1] << (64 - offset);
+        return v & ((std::uint64_t(1) << nbits) - 1);
+    }
+
+    inline void packed_set(std::uint64_t* words, std::size_t nbits, std::size_t i, std::uint64_t v)
+    {
+        const std::size_t bit = i * nbits, w = bit >> 6, offset = bit & 63;
+        const std::uint64_t mask = (std::uint64_t(1) << nbits) - 1;
+        v &= mask;
+        words[w] = (words[w] & ~(mask << offset)) | (v << offset);
+        if (offset + nbits > 64) {
+            const std::size_t spill = 64 - offset;
+            words[w + 1] = (words[w + 1] & ~(mask >> spill)) | (v >> spill);
+        }
+    }
+
+    // Compile-time width, so the kernels get constant shifts and masks.
+    template <std::size_t Nbits>
+    inline posit_storage_t<Nbits> packed_get(const std::uint64_t* words, std::size_t i)
+    {
+        return posit_storage_t<Nbits>(packed_get(words, Nbits, i));
+    }
+
+    template <std::size_t Nbits>
+    inline void packed_set(std::uint64_t* words, std::size_t i, posit_storage_t<Nbits> v)
+    {
+        packed_set(words, Nbits, i, std::uint64_t(v));
+    }
+
+} // namespace detail
+
+class posit_tensor;
+
+/// Strided window into a posit_tensor; slicing and transposing never copy elements.
+class posit_tensor_view
+{
+  public:
+    posit_tensor_view(posit_tensor& t, std::size_t offset, std::vector<std::size_t> shape, std::vector<std::size_t> strides)
+        : tensor_(&t), offset_(offset), shape_(std::move(shape)), strides_(std::move(strides)) {}
+
+    posit_tensor& tensor() const { return *tensor_; }
+    const std::vector<std::size_t>& shape() const { return shape_; }
+    const std::vector<std::size_t>& strides() const { return strides_; }
+    std::size_t rank() const { return shape_.size(); }
+
+    std::size_t size() const
+    {
+        return std::accumulate(shape_.begin(), shape_.end(), std::size_t(1), [](std::size_t a, std::size_t b) { return a * b; });
+    }
+
+    /// Elements [first, last) with the given step along axis.
+    posit_tensor_view slice(std::size_t axis, std::size_t first, std::size_t last, std::size_t step = 1) const
+    {
+        if (axis >= rank() || first > last || last > shape_[axis] || step == 0)
+            throw std::out_of_range("posit_tensor_view::slice: invalid range");
+        posit_tensor_view v(*this);
+        v.offset_ += first * strides_[axis];
+        v.shape_[axis] = (last - first + step - 1) / step;
+        v.strides_[axis] *= step;
+        return v;
+    }
+
+    posit_tensor_view transpose(std::size_t axis0, std::size_t axis1) const
+    {
+        if (axis0 >= rank() || axis1 >= rank())
+            throw std::out_of_range("posit_tensor_view::transpose: invalid axis");
+        posit_tensor_view v(*this);
+        std::swap(v.shape_[axis0], v.shape_[axis1]);
+        std::swap(v.strides_[axis0], v.strides_[axis1]);
+        return v;
+    }
+
+    /// Storage index of the k-th element in row-major order of the view.
+    std::size_t element(std::size_t k) const
+    {
+        std::size_t e = offset_;
+        for (std::size_t d = rank(); d-- > 0;) {
+            e += (k % shape_[d]) * strides_[d];
+            k /= shape_[d];
+        }
+        return e;
+    }
+
+    /// Call f(k, storage index) for every element in row-major order, without divisions in the loop.
+    template <typename Function>
+    void for_each(Function f) const
+    {
+        const std::size_t n = size();
+        if (n == 0)
+            return;
+        std::vector<std::size_t> index(rank(), 0);
+        std::size_t e = offset_;
+        for (std::size_t k = 0; k < n; ++k) {
+            f(k, e);
+            for (std::size_t d = rank(); d-- > 0;) {
+                e += strides_[d];
+                if (++index[d] < shape_[d])
+                    break;
+                e -= index[d] * strides_[d];
+                index[d] = 0;
+            }
+        }
+    }
+
+    inline std::uint64_t get_raw(std::size_t k) const;
+    inline void set_raw(std::size_t k, std::uint64_t bits) const;
+
+  private:
+    posit_tensor* tensor_;
+    std::size_t offset_;
+    std::vector<std::size_t> shape_, strides_;
+};
+
+/// Dense row-major tensor whose posit format is a run-time (nbits, es) pair.
+//  Elements are packed at exactly nbits each, so 10^9 posit<12,1> take 1.5 GB; formats of 8 and 16 bits
+//  coincide with native uint8_t/uint16_t arrays. Formats are those of nbits_select and es_select.
+//  Neighbouring elements share words, so concurrent writers must own disjoint word ranges.
+class posit_tensor
+{
+  public:
+    posit_tensor(std::size_t nbits, std::size_t es, std::vector<std::size_t> shape)
+        : nbitsv_(nbits_select(nbits)), esv_(es_select(es)), nbits_(nbits), es_(es), shape_(std::move(shape))
+    {
+        if (!valid_posit_configuration(nbits, es))
+            throw std::invalid_argument("posit_tensor: posit<" + std::to_string(nbits) + "," + std::to_string(es) + "> is not a valid format");
+        size_ = std::accumulate(shape_.begin(), shape_.end(), std::size_t(1), [](std::size_t a, std::size_t b) { return a * b; });
+        words_.assign((size_ * nbits_ + 63) / 64 + 1, 0);
+    }
+
+    std::size_t nbits() const { return nbits_; }
+    std::size_t es() const { return es_; }
+    const nbits_variant& nbits_v() const { return nbitsv_; }
+    const es_variant& es_v() const { return esv_; }
+    const std::vector<std::size_t>& shape() const { return shape_; }
+    std::size_t size() const { return size_; }
+
+    /// Bytes of element storage.
+    std::size_t footprint() const { return words_.size() * sizeof(std::uint64_t); }
+
+    std::uint64_t get_raw(std::size_t i) const { return detail::packed_get(words_.data(), nbits_, i); }
+    void set_raw(std::size_t i, std::uint64_t bits) { detail::packed_set(words_.data(), nbits_, i, bits); }
+
+    const std::uint64_t* words() const { return words_.data(); }
+    std::uint64_t* words() { return words_.data(); }
+
+    /// View of the whole tensor.
+    posit_tensor_view view()
+    {
+        std::vector<std::size_t> strides(shape_.size(), 1);
+        for (std::size_t d = shape_.size(); d-- > 1;)
+            strides[d - 1] = strides[d] * shape_[d];
+        return posit_tensor_view(*this, 0, shape_, strides);
+    }
+
+  private:
+    nbits_variant nbitsv_;
+    es_variant esv_;
+    std::size_t nbits_, es_;
+    std::vector<std::size_t> shape_;
+    std::size_t size_;
+    std::vector<std::uint64_t> words_;
+};
+
+/// Call f(e) with the storage indices e[0..M) of the same element of M views of equal shape, in row-major order.
+template <std::size_t M, typename Function>
+void for_each_element(const std::array<const posit_tensor_view*, M>& views, Function f)
+{
+    const std::vector<std::size_t>& shape = views[0]->shape();
+    for (std::size_t m = 1; m < M; ++m)
+        if (views[m]->shape() != shape)
+            throw std::invalid_argument("for_each_element: views differ in shape");
+    const std::size_t n = views[0]->size(), rank = shape.size();
+    if (n == 0)
+        return;
+
+    std::array<std::size_t, M> e;
+    for (std::size_t m = 0; m < M; ++m)
+        e[m] = views[m]->element(0);
+    std::vector<std::size_t> index(rank, 0);
+    for (std::size_t k = 0; k < n; ++k) {
+        f(e.data());
+        for (std::size_t d = rank; d-- > 0;) {
+            for (std::size_t m = 0; m < M; ++m)
+                e[m] += views[m]->strides()[d];
+            if (++index[d] < shape[d])
+                break;
+            for (std::size_t m = 0; m < M; ++m)
+                e[m] -= index[d] * views[m]->strides()[d];
+            index[d] = 0;
+        }
+    }
+}
+
+inline std::uint64_t posit_tensor_view::get_raw(std::size_t k) const { return tensor_->get_raw(element(k)); }
+inline void posit_tensor_view::set_raw(std::size_t k, std::uint64_t bits) const { tensor_->set_raw(element(k), bits); }
+
+namespace detail {
+
+    struct tensor_packer
+    {
+        template <std::size_t Nbits, std::size_t ES>
+        void operator()() const
+        {
+            std::uint64_t* words = view_.tensor().words();
+            sw::unum::posit<Nbits, ES> p;
+            view_.for_each([&](std::size_t k, std::size_t e) {
+                p = in_[k];
+                packed_set<Nbits>(words, e, posit_storage_t<Nbits>(p.get().to_ullong()));
+            });
+        }
+
+        const posit_tensor_view& view_;
+        const double* in_;
+    };
+
+    struct tensor_unpacker
+    {
+        template <std::size_t Nbits, std::size_t ES>
+        void operator()() const
+        {
+            decode<Nbits, ES>(std::integral_constant<bool, (Nbits <= decode_table_max_nbits)>());
+        }
+
+        template <std::size_t Nbits, std::size_t ES>
+        void decode(std::true_type) const
+        {
+            const std::uint64_t* words = view_.tensor().words();
+            const double* values = decode_table_for<Nbits, ES>().data();
+            view_.for_each([&](std::size_t k, std::size_t e) {
+                out_[k] = values[packed_get<Nbits>(words, e)];
+            });
+        }
+
+        template <std::size_t Nbits, std::size_t ES>
+        void decode(std::false_type) const
+        {
+            const std::uint64_t* words = view_.tensor().words();
+            sw::unum::posit<Nbits, ES> p;
+            view_.for_each([&](std::size_t k, std::size_t e) {
+                p.set_raw_bits(packed_get<Nbits>(words, e));
+                out_[k] = double(p);
+            });
+        }
+
+        const posit_tensor_view& view_;
+        double* out_;
+    };
+
+} // namespace detail
+
+/// Round view.size() doubles, in row-major order of the view, into its elements with a single dispatch.
+inline dispatch_status pack(const double* in, const posit_tensor_view& view)
+{
+    return table_dispatch(detail::tensor_packer{ view, in }, view.tensor().nbits_v(), view.tensor().es_v());
+}
+
+/// Decode the elements of the view, in row-major order, into view.size() doubles with a single dispatch.
+inline dispatch_status unpack(const posit_tensor_view& view, double* out)
+{
+    return table_dispatch(detail::tensor_unpacker{ view, out }, view.tensor().nbits_v(), view.tensor().es_v());
+}
@@ -0,0 +1,486 @@
+// simd_convert.hpp: AVX2 and AVX-512 bulk conversion between IEEE double/float and posit<nbits, es> for nbits <= 32
+//
+// Copyright (C) 2017 Stillwater Supercomputing, Inc.
+//
+// This file is part of the universal numbers project, which is released under an MIT Open Source license.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <type_traits>
+#include <vector>
+
+#include <boost/variant.hpp>
+#include <posit>
+
+#include "nbits_select.hpp"
+#include "batch_convert.hpp"
+#include "posit_codec.hpp"
+
+// The vector kernels are compiled for their instruction sets through function target attributes and
+// selected at run time, so the library needs no special compiler flags. Other compilers and
+// architectures use the scalar codec.
+#if (defined(__GNUC__) || defined(__clang__)) && defined(__x86_64__)
+#define EF_TENSORS_SIMD_X86 1
+#include <immintrin.h>
+#define EF_TENSORS_TARGET_AVX2 __attribute__((target("avx2")))
+#define EF_TENSORS_TARGET_AVX512 __attribute__((target("avx2,avx512f,avx512cd")))
+#endif
+
+/// Instruction sets of the conversion kernels, in increasing order.
+enum class simd_level { scalar, avx2, avx512 };
+
+inline const char* to_string(simd_level level)
+{
+    switch (level) {
+        case simd_level::scalar: return "scalar";
+        case simd_level::avx2:   return "avx2";
+        case simd_level::avx512: return "avx512";
+    }
+    return "unknown simd level";
+}
+
+/// Best instruction set supported by the processor and operating system, determined once.
+inline simd_level detect_simd_level()
+{
+#ifdef EF_TENSORS_SIMD_X86
+    static const simd_level level = [] {
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512cd"))
+            return simd_level::avx512;
+        if (__builtin_cpu_supports("avx2"))
+            return simd_level::avx2;
+        return simd_level::scalar;
+    }();
+    return level;
+#else
+    return simd_level::scalar;
+#endif
+}
+
+namespace detail {
+
+    // Requests beyond the processor fall back to the best supported level.
+    inline simd_level usable_level(simd_level requested)
+    {
+        simd_level best = detect_simd_level();
+        return requested < best ? requested : best;
+    }
+
+#ifdef EF_TENSORS_SIMD_X86
+
+    // The lane algorithms mirror posit_codec::encode and posit_codec::decode step by step; shifts by
+    // variable counts of 64 or more, including negative counts, yield zero and replace the branches.
+    template <std::size_t Nbits, std::size_t ES>
+    struct avx2_posit_codec
+    {
+        using codec = posit_codec<Nbits, ES>;
+        using raw_type = posit_storage_t<Nbits>;
+
+        EF_TENSORS_TARGET_AVX2 static __m256i set(std::int64_t v) { return _mm256_set1_epi64x(v); }
+
+        EF_TENSORS_TARGET_AVX2 static __m256i encode(__m256i u)
+        {
+            const __m256i zero = _mm256_setzero_si256(), one = set(1), ones = set(-1);
+            const __m256i sign = _mm256_srli_epi64(u, 63);
+            const __m256i a = _mm256_and_si256(u, set(0x7FFFFFFFFFFFFFFFll));
+            const __m256i E = _mm256_srli_epi64(a, 52);
+            const __m256i f = _mm256_and_si256(a, set(0x000FFFFFFFFFFFFFll));
+            const __m256i E1 = _mm256_add_epi64(E, one);
+            const __m256i k = _mm256_sub_epi64(_mm256_srli_epi64(E1, ES), set(1024 >> ES));
+            const __m256i ex = _mm256_and_si256(E1, set((1 << ES) - 1));
+
+            const __m256i kpos = _mm256_cmpgt_epi64(k, ones);
+            const __m256i regime = _mm256_blendv_epi8(_mm256_srlv_epi64(set(std::int64_t(1) << 63), _mm256_sub_epi64(zero, k)),
+                                                      _mm256_xor_si256(_mm256_srlv_epi64(ones, _mm256_add_epi64(k, one)), ones), kpos);
+            const __m256i rlen = _mm256_blendv_epi8(_mm256_sub_epi64(one, k), _mm256_add_epi64(k, set(2)), kpos);
+            const __m256i s = _mm256_sub_epi64(set(64 - std::int64_t(ES)), rlen);
+            const __m256i d = _mm256_sub_epi64(set(52), s);
+            const __m256i fraction = _mm256_or_si256(_mm256_sllv_epi64(f, _mm256_sub_epi64(zero, d)), _mm256_srlv_epi64(f, d));
+            const __m256i lost = _mm256_and_si256(f, _mm256_srlv_epi64(ones, _mm256_sub_epi64(set(64), d)));
+            const __m256i body = _mm256_or_si256(_mm256_or_si256(regime, _mm256_sllv_epi64(ex, s)), fraction);
+
+            __m256i p = _mm256_srli_epi64(body, 65 - Nbits);
+            const __m256i guard = _mm256_and_si256(_mm256_srli_epi64(body, 64 - Nbits), one);
+            const __m256i rest = _mm256_or_si256(_mm256_and_si256(body, set((std::int64_t(1) << (64 - Nbits)) - 1)), lost);
+            const __m256i sticky = _mm256_andnot_si256(_mm256_cmpeq_epi64(rest, zero), one);
+            p = _mm256_add_epi64(p, _mm256_and_si256(guard, _mm256_or_si256(sticky, _mm256_and_si256(p, one))));
+            p = _mm256_sub_epi64(p, _mm256_srli_epi64(p, Nbits - 1));
+
+            p = _mm256_blendv_epi8(p, set(codec::maxpos), _mm256_cmpgt_epi64(k, set(codec::max_k - 1)));
+            p = _mm256_blendv_epi8(p, one, _mm256_cmpgt_epi64(set(-codec::max_k), k));
+            p = _mm256_blendv_epi8(p, _mm256_and_si256(_mm256_sub_epi64(zero, p), set(codec::mask)), _mm256_cmpeq_epi64(sign, one));
+            p = _mm256_blendv_epi8(p, set(codec::nar), _mm256_cmpeq_epi64(E, set(2047)));
+            return _mm256_andnot_si256(_mm256_cmpeq_epi64(a, zero), p);
+        }
+
+        EF_TENSORS_TARGET_AVX2 static __m256i decode(__m256i p)
+        {
+            const __m256i zero = _mm256_setzero_si256(), one = set(1);
+            p = _mm256_and_si256(p, set(codec::mask));
+            const __m256i sign = _mm256_srli_epi64(p, Nbits - 1);
+            const __m256i magnitude = _mm256_blendv_epi8(p, _mm256_and_si256(_mm256_sub_epi64(zero, p), set(codec::mask)), _mm256_cmpeq_epi64(sign, one));
+            __m256i b = _mm256_slli_epi64(magnitude, 65 - Nbits);
+            const __m256i r0 = _mm256_srli_epi64(b, 63);
+            const __m256i x = _mm256_xor_si256(b, _mm256_sub_epi64(zero, r0));
+
+            // leading zeros from the exponent of the exactly converted upper half; the regime lies within it
+            const __m256d top = _mm256_sub_pd(_mm256_castsi256_pd(_mm256_or_si256(_mm256_srli_epi64(x, 32), set(0x4330000000000000ll))),
+                                              _mm256_set1_pd(4503599627370496.0));
+            const __m256i m = _mm256_sub_epi64(set(1054), _mm256_srli_epi64(_mm256_castpd_si256(top), 52));
+
+            const __m256i k = _mm256_blendv_epi8(_mm256_sub_epi64(zero, m), _mm256_sub_epi64(m, one), _mm256_cmpeq_epi64(r0, one));
+            b = _mm256_sllv_epi64(b, _mm256_add_epi64(m, one));
+            const __m256i ex = _mm256_srli_epi64(_mm256_srli_epi64(b, 1), 63 - ES);
+            b = _mm256_slli_epi64(b, ES);
+            const __m256i scale = _mm256_add_epi64(_mm256_slli_epi64(k, ES), ex);
+            __m256i bits = _mm256_or_si256(_mm256_or_si256(_mm256_slli_epi64(_mm256_add_epi64(scale, set(1023)), 52), _mm256_srli_epi64(b, 12)),
+                                           _mm256_slli_epi64(sign, 63));
+            bits = _mm256_blendv_epi8(bits, set(0x7FF8000000000000ll), _mm256_cmpeq_epi64(p, set(codec::nar)));
+            return _mm256_andnot_si256(_mm256_cmpeq_epi64(p, zero), bits);
+        }
+
+        // four encodings, zero-extended to 64-bit lanes
+        EF_TENSORS_TARGET_AVX2 static __m256i load(const raw_type* in)
+        {
+            if (sizeof(raw_type) == 1) {
+                std::int32_t v;
+                std::memcpy(&v, in, 4);
+                return _mm256_cvtepu8_epi64(_mm_cvtsi32_si128(v));
+            }
+            if (sizeof(raw_type) == 2)
+                return _mm256_cvtepu16_epi64(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(in)));
+            return _mm256_cvtepu32_epi64(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in)));
+        }
+
+        EF_TENSORS_TARGET_AVX2 static void store(raw_type* out, __m256i p)
+        {
+            const __m128i dwords = _mm256_castsi256_si128(_mm256_permutevar8x32_epi32(p, _mm256_setr_epi32(0, 2, 4, 6, 0, 2, 4, 6)));
+            if (sizeof(raw_type) == 1) {
+                std::int32_t v = _mm_cvtsi128_si32(_mm_shuffle_epi8(dwords, _mm_setr_epi8(0, 4, 8, 12, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1)));
+                std::memcpy(out, &v, 4);
+            }
+            else if (sizeof(raw_type) == 2) {
+                _mm_storel_epi64(reinterpret_cast<__m128i*>(out), _mm_shuffle_epi8(dwords, _mm_setr_epi8(0, 1, 4, 5, 8, 9, 12, 13, -1, -1, -1, -1, -1, -1, -1, -1)));
+            }
+            else {
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(out), dwords);
+            }
+        }
+
+        EF_TENSORS_TARGET_AVX2 static std::size_t encode(const double* in, std::size_t n, raw_type* out)
+        {
+            std::size_t i = 0;
+            for (; i + 4 <= n; i += 4)
+                store(out + i, encode(_mm256_castpd_si256(_mm256_loadu_pd(in + i))));
+            return i;
+        }
+
+        EF_TENSORS_TARGET_AVX2 static std::size_t decode(const raw_type* in, std::size_t n, double* out)
+        {
+            std::size_t i = 0;
+            for (; i + 4 <= n; i += 4)
+                _mm256_storeu_pd(out + i, _mm256_castsi256_pd(decode(load(in + i))));
+            return i;
+        }
+    };
+
+// GCC 12 reports its own _mm512_undefined_epi32 placeholders as maybe uninitialized
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+
+    template <std::size_t Nbits, std::size_t ES>
+    struct avx512_posit_codec
+    {
+        using codec = posit_codec<Nbits, ES>;
+        using raw_type = posit_storage_t<Nbits>;
+
+        EF_TENSORS_TARGET_AVX512 static __m512i set(std::int64_t v) { return _mm512_set1_epi64(v); }
+
+        EF_TENSORS_TARGET_AVX512 static __m512i encode(__m512i u)
+        {
+            const __m512i zero = _mm512_setzero_si512(), one = set(1), ones = set(-1);
+            const __m512i a = _mm512_and_si512(u, set(0x7FFFFFFFFFFFFFFFll));
+            const __m512i E = _mm512_srli_epi64(a, 52);
+            const __m512i f = _mm512_and_si512(a, set(0x000FFFFFFFFFFFFFll));
+            const __m512i E1 = _mm512_add_epi64(E, one);
+            const __m512i k = _mm512_sub_epi64(_mm512_srli_epi64(E1, ES), set(1024 >> ES));
+            const __m512i ex = _mm512_and_si512(E1, set((1 << ES) - 1));
+
+            const __mmask8 kpos = _mm512_cmpgt_epi64_mask(k, ones);
+            const __m512i regime = _mm512_mask_blend_epi64(kpos, _mm512_srlv_epi64(set(std::int64_t(1) << 63), _mm512_sub_epi64(zero, k)),
+                                                           _mm512_xor_si512(_mm512_srlv_epi64(ones, _mm512_add_epi64(k, one)), ones));
+            const __m512i rlen = _mm512_mask_blend_epi64(kpos, _mm512_sub_epi64(one, k), _mm512_add_epi64(k, set(2)));
+            const __m512i s = _mm512_sub_epi64(set(64 - std::int64_t(ES)), rlen);
+            const __m512i d = _mm512_sub_epi64(set(52), s);
+            const __m512i fraction = _mm512_or_si512(_mm512_sllv_epi64(f, _mm512_sub_epi64(zero, d)), _mm512_srlv_epi64(f, d));
+            const __m512i lost = _mm512_and_si512(f, _mm512_srlv_epi64(ones, _mm512_sub_epi64(set(64), d)));
+            const __m512i body = _mm512_or_si512(_mm512_or_si512(regime, _mm512_sllv_epi64(ex, s)), fraction);
+
+            __m512i p = _mm512_srli_epi64(body, 65 - Nbits);
+            const __m512i guard = _mm512_and_si512(_mm512_srli_epi64(body, 64 - Nbits), one);
+            const __m512i rest = _mm512_or_si512(_mm512_and_si512(body, set((std::int64_t(1) << (64 - Nbits)) - 1)), lost);
+            const __m512i sticky = _mm512_maskz_mov_epi64(_mm512_test_epi64_mask(rest, rest), one);
+            p = _mm512_add_epi64(p, _mm512_and_si512(guard, _mm512_or_si512(sticky, _mm512_and_si512(p, one))));
+            p = _mm512_sub_epi64(p, _mm512_srli_epi64(p, Nbits - 1));
+
+            p = _mm512_mask_mov_epi64(p, _mm512_cmpgt_epi64_mask(k, set(codec::max_k - 1)), set(codec::maxpos));
+            p = _mm512_mask_mov_epi64(p, _mm512_cmpgt_epi64_mask(set(-codec::max_k), k), one);
+            p = _mm512_mask_and_epi64(p, _mm512_cmplt_epi64_mask(u, zero), _mm512_sub_epi64(zero, p), set(codec::mask));
+            p = _mm512_mask_mov_epi64(p, _mm512_cmpeq_epi64_mask(E, set(2047)), set(codec::nar));
+            return _mm512_maskz_mov_epi64(_mm512_test_epi64_mask(a, a), p);
+        }
+
+        EF_TENSORS_TARGET_AVX512 static __m512i decode(__m512i p)
+        {
+            const __m512i zero = _mm512_setzero_si512(), one = set(1);
+            p = _mm512_and_si512(p, set(codec::mask));
+            const __m512i sign = _mm512_srli_epi64(p, Nbits - 1);
+            const __mmask8 negative = _mm512_test_epi64_mask(sign, sign);
+            const __m512i magnitude = _mm512_mask_and_epi64(p, negative, _mm512_sub_epi64(zero, p), set(codec::mask));
+            __m512i b = _mm512_slli_epi64(magnitude, 65 - Nbits);
+            const __m512i r0 = _mm512_srli_epi64(b, 63);
+            const __mmask8 ones_run = _mm512_test_epi64_mask(r0, r0);
+            const __m512i m = _mm512_lzcnt_epi64(_mm512_mask_xor_epi64(b, ones_run, b, set(-1)));
+
+            const __m512i k = _mm512_mask_blend_epi64(ones_run, _mm512_sub_epi64(zero, m), _mm512_sub_epi64(m, one));
+            b = _mm512_sllv_epi64(b, _mm512_add_epi64(m, one));
+            const __m512i ex = _mm512_srli_epi64(_mm512_srli_epi64(b, 1), 63 - ES);
+            b = _mm512_slli_epi64(b, ES);
+            const __m512i scale = _mm512_add_epi64(_mm512_slli_epi64(k, ES), ex);
+            __m512i bits = _mm512_or_si512(_mm512_or_si512(_mm512_slli_epi64(_mm512_add_epi64(scale, set(1023)), 52), _mm512_srli_epi64(b, 12)),
+                                           _mm512_slli_epi64(sign, 63));
+            bits = _mm512_mask_mov_epi64(bits, _mm512_cmpeq_epi64_mask(p, set(codec::nar)), set(0x7FF8000000000000ll));
+            return _mm512_maskz_mov_epi64(_mm512_test_epi64_mask(p, p), bits);
+        }
+
+        // eight encodings, zero-extended to 64-bit lanes
+        EF_TENSORS_TARGET_AVX512 static __m512i load(const raw_type* in)
+        {
+            if (sizeof(raw_type) == 1)
+                return _mm512_cvtepu8_epi64(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(in)));
+            if (sizeof(raw_type) == 2)
+                return _mm512_cvtepu16_epi64(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in)));
+            return _mm512_cvtepu32_epi64(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(in)));
+        }
+
+        EF_TENSORS_TARGET_AVX512 static void store(raw_type* out, __m512i p)
+        {
+            if (sizeof(raw_type) == 1)
+                _mm_storel_epi64(reinterpret_cast<__m128i*>(out), _mm512_cvtepi64_epi8(p));
+            else if (sizeof(raw_type) == 2)
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(out), _mm512_cvtepi64_epi16(p));
+            else
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(out), _mm512_cvtepi64_epi32(p));
+        }
+
+        EF_TENSORS_TARGET_AVX512 static std::size_t encode(const double* in, std::size_t n, raw_type* out)
+        {
+            std::size_t i = 0;
+            for (; i + 8 <= n; i += 8)
+                store(out + i, encode(_mm512_castpd_si512(_mm512_loadu_pd(in + i))));
+            return i;
+        }
+
+        EF_TENSORS_TARGET_AVX512 static std::size_t decode(const raw_type* in, std::size_t n, double* out)
+        {
+            std::size_t i = 0;
+            for (; i + 8 <= n; i += 8)
+                _mm512_storeu_pd(out + i, _mm512_castsi512_pd(decode(load(in + i))));
+            return i;
+        }
+    };
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+#endif // EF_TENSORS_SIMD_X86
+
+} // namespace detail
+
+/// Encode n doubles as posit<Nbits, ES> with the requested instruction set or the best one available.
+template <std::size_t Nbits, std::size_t ES>
+void simd_encode(const double* in, std::size_t n, posit_storage_t<Nbits>* out, simd_level level = detect_simd_level())
+{
+    std::size_t i = 0;
+#ifdef EF_TENSORS_SIMD_X86
+    switch (detail::usable_level(level)) {
+        case simd_level::avx512: i = detail::avx512_posit_codec<Nbits, ES>::encode(in, n, out); break;
+        case simd_level::avx2:   i = detail::avx2_posit_codec<Nbits, ES>::encode(in, n, out); break;
+        case simd_level::scalar: break;
+    }
+#endif
+    for (; i < n; ++i)
+        out[i] = posit_codec<Nbits, ES>::encode(in[i]);
+}
+
+/// Decode n posit<Nbits, ES> encodings into doubles, exactly.
+template <std::size_t Nbits, std::size_t ES>
+void simd_decode(const posit_storage_t<Nbits>* in, std::size_t n, double* out, simd_level level = detect_simd_level())
+{
+    std::size_t i = 0;
+#ifdef EF_TENSORS_SIMD_X86
+    switch (detail::usable_level(level)) {
+        case simd_level::avx512: i = detail::avx512_posit_codec<Nbits, ES>::decode(in, n, out); break;
+        case simd_level::avx2:   i = detail::avx2_posit_codec<Nbits, ES>::decode(in, n, out); break;
+        case simd_level::scalar: break;
+    }
+#endif
+    for (; i < n; ++i)
+        out[i] = posit_codec<Nbits, ES>::decode(in[i]);
+}
+
+/// Float variants: every float is a double and the decoded posits round once to float.
+template <std::size_t Nbits, std::size_t ES>
+void simd_encode(const float* in, std::size_t n, posit_storage_t<Nbits>* out, simd_level level = detect_simd_level())
+{
+    constexpr std::size_t block = 256;
+    double buffer[block];
+    for (std::size_t i = 0; i < n; i += block) {
+        const std::size_t m = n - i < block ? n - i : block;
+        for (std::size_t j = 0; j < m; ++j)
+            buffer[j] = in[i + j];
+        simd_encode<Nbits, ES>(buffer, m, out + i, level);
+    }
+}
+
+template <std::size_t Nbits, std::size_t ES>
+void simd_decode(const posit_storage_t<Nbits>* in, std::size_t n, float* out, simd_level level = detect_simd_level())
+{
+    constexpr std::size_t block = 256;
+    double buffer[block];
+    for (std::size_t i = 0; i < n; i += block) {
+        const std::size_t m = n - i < block ? n - i : block;
+        simd_decode<Nbits, ES>(in + i, m, buffer, level);
+        for (std::size_t j = 0; j < m; ++j)
+            out[i + j] = float(buffer[j]);
+    }
+}
+
+/// Exponent size of the standard posit of each width of standard_variant.
+constexpr std::size_t standard_es(std::size_t nbits)
+{
+    return nbits <= 8 ? 0 : (nbits <= 16 ? 1 : (nbits <= 32 ? 2 : 3));
+}
+
+namespace detail {
+
+    // posit<64, 3> does not fit the 64-bit lanes and converts through the scalar library.
+    template <typename Real>
+    struct standard_encoder : boost::static_visitor<void>
+    {
+        standard_encoder(const Real* in, std::size_t n, void* out, simd_level level) : in_(in), n_(n), out_(out), level_(level) {}
+
+        template <std::size_t Nbits>
+        void operator()(const nbits_tag<Nbits>&) const { encode<Nbits>(std::integral_constant<bool, (Nbits <= 32)>{}); }
+
+        template <std::size_t Nbits>
+        void encode(std::true_type) const { simd_encode<Nbits, standard_es(Nbits)>(in_, n_, static_cast<posit_storage_t<Nbits>*>(out_), level_); }
+
+        template <std::size_t Nbits>
+        void encode(std::false_type) const
+        {
+            sw::unum::posit<Nbits, standard_es(Nbits)> p;
+            posit_storage_t<Nbits>* out = static_cast<posit_storage_t<Nbits>*>(out_);
+            for (std::size_t i = 0; i < n_; ++i) {
+                p = double(in_[i]);
+                out[i] = posit_storage_t<Nbits>(p.get().to_ullong());
+            }
+        }
+
+        const Real* in_;
+        std::size_t n_;
+        void* out_;
+        simd_level level_;
+    };
+
+    template <typename Real>
+    struct standard_decoder : boost::static_visitor<void>
+    {
+        standard_decoder(const void* in, std::size_t n, Real* out, simd_level level) : in_(in), n_(n), out_(out), level_(level) {}
+
+        template <std::size_t Nbits>
+        void operator()(const nbits_tag<Nbits>&) const { decode<Nbits>(std::integral_constant<bool, (Nbits <= 32)>{}); }
+
+        template <std::size_t Nbits>
+        void decode(std::true_type) const { simd_decode<Nbits, standard_es(Nbits)>(static_cast<const posit_storage_t<Nbits>*>(in_), n_, out_, level_); }
+
+        template <std::size_t Nbits>
+        void decode(std::false_type) const
+        {
+            sw::unum::posit<Nbits, standard_es(Nbits)> p;
+            const posit_storage_t<Nbits>* in = static_cast<const posit_storage_t<Nbits>*>(in_);
+            for (std::size_t i = 0; i < n_; ++i) {
+                p.set_raw_bits(in[i]);
+                out_[i] = Real(double(p));
+            }
+        }
+
+        const void* in_;
+        std::size_t n_;
+        Real* out_;
+        simd_level level_;
+    };
+
+} // namespace detail
+
+/// Encode n doubles or floats as the standard posit of the selected width: posit<8,0>, <16,1>, <32,2>, or <64,3>.
+//  out holds n * posit_storage_bytes(nbits) bytes.
+template <typename Real>
+void simd_encode(const Real* in, std::size_t n, void* out, const standard_variant& nbitsv, simd_level level = detect_simd_level())
+{
+    boost::apply_visitor(detail::standard_encoder<Real>(in, n, out, level), nbitsv);
+}
+
+/// Decode n standard posits of the selected width into doubles or floats.
+template <typename Real>
+void simd_decode(const void* in, std::size_t n, Real* out, const standard_variant& nbitsv, simd_level level = detect_simd_level())
+{
+    boost::apply_visitor(detail::standard_decoder<Real>(in, n, out, level), nbitsv);
+}
+
+/// Lanes that differ between the vector kernels and the scalar sw::unum::posit conversions.
+struct conversion_check
+{
+    std::size_t lanes = 0;
+    std::size_t encode_mismatches = 0;
+    std::size_t decode_mismatches = 0;
+    std::size_t first_mismatch = std::numeric_limits<std::size_t>::max();
+
+    bool ok() const { return encode_mismatches == 0 && decode_mismatches == 0; }
+};
+
+/// Verification mode: convert in[0, n) with the kernels of the given level and compare every lane,
+//  encodings bit for bit and decoded values bit for bit (any NaN matches NaN), against the library.
+template <std::size_t Nbits, std::size_t ES>
+conversion_check verify_simd_conversion(const double* in, std::size_t n, simd_level level)
+{
+    using raw_type = posit_storage_t<Nbits>;
+    std::vector<raw_type> encoded(n);
+    std::vector<double> decoded(n);
+    simd_encode<Nbits, ES>(in, n, encoded.data(), level);
+    simd_decode<Nbits, ES>(encoded.data(), n, decoded.data(), level);
+
+    conversion_check check;
+    check.lanes = n;
+    sw::unum::posit<Nbits, ES> p;
+    for (std::size_t i = 0; i < n; ++i) {
+        p = in[i];
+        const bool encode_ok = encoded[i] == raw_type(p.get().to_ullong());
+        p.set_raw_bits(encoded[i]);
+        const double expected = double(p);
+        const bool decode_ok = std::memcmp(&expected, &decoded[i], sizeof(double)) == 0 || (std::isnan(expected) && std::isnan(decoded[i]));
+        check.encode_mismatches += !encode_ok;
+        check.decode_mismatches += !decode_ok;
+        if ((!encode_ok || !decode_ok) && check.first_mismatch > i)
+            check.first_mismatch = i;
+    }
+    return check;
+}
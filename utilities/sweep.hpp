@@ -0,0 +1,148 @@
+// sweep.hpp: run a visitor over every valid (nbits, es) configuration concurrently, heaviest first
+//
+// Copyright (C) 2017 Stillwater Supercomputing, Inc.
+//
+// This file is part of the universal numbers project, which is released under an MIT Open Source license.
+
+#pragma once
+
+#include <cstddef>
+#include <algorithm>
+#include <chrono>
+#include <exception>
+#include <functional>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "dispatch_table.hpp"
+#include "work_stealing.hpp"
+
+/// Which configurations a sweep visits and how it schedules them.
+struct sweep_options
+{
+    std::size_t min_nbits = dispatch_min_nbits;
+    std::size_t max_nbits = dispatch_max_nbits;
+    std::size_t min_es = 0;
+    std::size_t max_es = dispatch_max_es;
+    std::function<bool(std::size_t nbits, std::size_t es)> filter;     // empty: all valid configurations
+    std::function<double(std::size_t nbits, std::size_t es)> cost;     // empty: nbits, the scaling of a software posit operation
+    unsigned nrOfThreads = 0;                                           // 0 selects the hardware threads
+};
+
+/// Outcome of the visitor on one configuration.
+template <typename Result>
+struct sweep_row
+{
+    std::size_t nbits, es;
+    Result result;
+    double seconds;
+    unsigned worker;
+    bool ok;                // false if the visitor threw; error holds the message
+    std::string error;
+};
+
+/// Per-configuration results in (nbits, es) order, and how well the schedule used the workers.
+template <typename Result>
+struct sweep_table
+{
+    std::vector<sweep_row<Result> > rows;
+    double wall_seconds = 0.0;
+    double busy_seconds = 0.0;      // sum of the per-configuration times
+    unsigned nrOfThreads = 0;
+
+    /// Fraction of the worker time spent in visitors.
+    double efficiency() const { return wall_seconds > 0 ? busy_seconds / (wall_seconds * nrOfThreads) : 1.0; }
+};
+
+/// The configurations of a sweep in (nbits, es) order.
+inline std::vector<std::pair<std::size_t, std::size_t> > sweep_configurations(const sweep_options& options)
+{
+    std::vector<std::pair<std::size_t, std::size_t> > configurations;
+    for (std::size_t nbits = std::max(options.min_nbits, dispatch_min_nbits); nbits <= std::min(options.max_nbits, dispatch_max_nbits); ++nbits)
+        for (std::size_t es = options.min_es; es <= std::min(options.max_es, dispatch_max_es); ++es)
+            if (valid_posit_configuration(nbits, es) && (!options.filter || options.filter(nbits, es)))
+                configurations.emplace_back(nbits, es);
+    return configurations;
+}
+
+namespace detail {
+
+    template <typename Visitor, typename Result>
+    struct sweep_invoker
+    {
+        template <std::size_t Nbits, std::size_t ES>
+        void operator()() { result_ = vis_.template operator()<Nbits, ES>(); }
+
+        const Visitor& vis_;
+        Result& result_;
+    };
+
+} // namespace detail
+
+/// Run vis.operator()<Nbits, ES>() for every configuration of the options and collect the results.
+//  The visitor returns a default-constructible result per configuration and is called concurrently.
+//  Configurations are handed out to the workers in decreasing order of estimated cost (longest processing
+//  time first), so a heavy configuration never starts last and leaves the other workers idle; work_stealing_for
+//  rebalances what the cost estimates get wrong.
+template <typename Visitor>
+auto sweep(const Visitor& vis, const sweep_options& options = sweep_options())
+    -> sweep_table<decltype(vis.template operator()<dispatch_max_nbits, 0>())>
+{
+    using result_type = decltype(vis.template operator()<dispatch_max_nbits, 0>());
+
+    const auto configurations = sweep_configurations(options);
+    sweep_table<result_type> table;
+    table.rows.resize(configurations.size());
+
+    std::vector<std::size_t> order(configurations.size());
+    std::vector<double> cost(configurations.size());
+    for (std::size_t i = 0; i < configurations.size(); ++i) {
+        order[i] = i;
+        cost[i] = options.cost ? options.cost(configurations[i].first, configurations[i].second) : double(configurations[i].first);
+    }
+    std::stable_sort(order.begin(), order.end(), [&cost](std::size_t a, std::size_t b) { return cost[a] > cost[b]; });
+
+    unsigned nrOfThreads = options.nrOfThreads > 0 ? options.nrOfThreads : std::max(1u, std::thread::hardware_concurrency());
+    nrOfThreads = unsigned(std::max<std::size_t>(1, std::min<std::size_t>(nrOfThreads, configurations.size())));
+    table.nrOfThreads = nrOfThreads;
+
+    // Deal the heaviest-first order round-robin into the equal slices work_stealing_for starts its workers on,
+    // so every worker begins with its share of the heavy configurations and thieves take the light tail.
+    std::vector<std::size_t> schedule(order.size());
+    for (std::size_t k = 0, slot = 0; k < nrOfThreads; ++k)
+        for (std::size_t j = k; j < order.size(); j += nrOfThreads)
+            schedule[slot++] = order[j];
+
+    auto run = [&](unsigned w, std::size_t first, std::size_t last) {
+        for (std::size_t k = first; k < last; ++k) {
+            const std::size_t i = schedule[k];
+            sweep_row<result_type>& row = table.rows[i];
+            row.nbits = configurations[i].first;
+            row.es = configurations[i].second;
+            row.worker = w;
+            row.ok = true;
+            auto start = std::chrono::steady_clock::now();
+            try {
+                table_dispatch(detail::sweep_invoker<Visitor, result_type>{ vis, row.result }, row.nbits, row.es);
+            }
+            catch (const std::exception& err) {
+                row.ok = false;
+                row.error = err.what();
+            }
+            catch (...) {
+                row.ok = false;
+                row.error = "unknown exception";
+            }
+            row.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        }
+    };
+
+    auto start = std::chrono::steady_clock::now();
+    work_stealing_for(schedule.size(), 1, nrOfThreads, run);
+    table.wall_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    for (const auto& row : table.rows)
+        table.busy_seconds += row.seconds;
+    return table;
+}
@@ -0,0 +1,93 @@
+// work_stealing.hpp: parallel loop over an index range with work stealing between workers
+//
+// Copyright (C) 2017 Stillwater Supercomputing, Inc.
+//
+// This file is part of the universal numbers project, which is released under an MIT Open Source license.
+
+#pragma once
+
+#include <cstddef>
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace detail {
+
+    // Remaining [begin, end) of one worker; padded so neighbouring workers rarely share a cache line.
+    struct stealable_range
+    {
+        std::mutex mutex;
+        std::size_t begin = 0, end = 0;
+        char padding[64];
+    };
+
+} // namespace detail
+
+/// Run body(worker, first, last) over all grains of [0, n) on nrOfThreads workers.
+//  Every worker starts with an equal slice and takes grains from its front; a worker that runs
+//  dry steals the back half of the largest remaining slice, so uneven grain costs balance out.
+template <typename Body>
+void work_stealing_for(std::size_t n, std::size_t grain, unsigned nrOfThreads, Body body)
+{
+    if (nrOfThreads == 0)
+        nrOfThreads = 1;
+    if (grain == 0)
+        grain = 1;
+
+    std::unique_ptr<detail::stealable_range[]> ranges(new detail::stealable_range[nrOfThreads]);
+    for (unsigned w = 0; w < nrOfThreads; ++w) {
+        ranges[w].begin = n / nrOfThreads * w + std::min<std::size_t>(w, n % nrOfThreads);
+        ranges[w].end = n / nrOfThreads * (w + 1) + std::min<std::size_t>(w + 1, n % nrOfThreads);
+    }
+
+    auto worker = [&](unsigned self) {
+        detail::stealable_range& own = ranges[self];
+        for (;;) {
+            std::size_t first, last;
+            {
+                std::lock_guard<std::mutex> lock(own.mutex);
+                first = own.begin;
+                last = std::min(own.end, first + grain);
+                own.begin = last;
+            }
+            if (first < last) {
+                body(self, first, last);
+                continue;
+            }
+
+            // own slice is exhausted: find the victim with the most work left
+            unsigned victim = self;
+            std::size_t most = 0;
+            for (unsigned w = 0; w < nrOfThreads; ++w) {
+                std::lock_guard<std::mutex> lock(ranges[w].mutex);
+                std::size_t left = ranges[w].end - ranges[w].begin;
+                if (left > most) {
+                    most = left;
+                    victim = w;
+                }
+            }
+            if (victim == self)
+                return;     // slices only shrink, so all work has been handed out
+
+            // move the back half under both locks, so the work is never invisible to other thieves
+            std::unique_lock<std::mutex> victim_lock(ranges[victim].mutex, std::defer_lock), own_lock(own.mutex, std::defer_lock);
+            std::lock(victim_lock, own_lock);
+            std::size_t left = ranges[victim].end - ranges[victim].begin;
+            if (left == 0)
+                continue;
+            std::size_t mid = ranges[victim].begin + left / 2;
+            own.begin = mid;
+            own.end = ranges[victim].end;
+            ranges[victim].end = mid;
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (unsigned w = 1; w < nrOfThreads; ++w)
+        threads.emplace_back(worker, w);
+    worker(0);
+    for (auto& t : threads)
+        t.join();
+}